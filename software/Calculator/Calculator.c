@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <fcntl.h>
 #include <io.h>
 #include <alt_types.h>
 #include <math.h>
@@ -6,6 +7,10 @@
 #include "ps2_keyboard.h"
 #include "altera_avalon_lcd_16207_regs.h"
 #include "alt_up_character_lcd.h"
+#include "calc_proto.h"
+#include "calc_out.h"
+#include "sys/alt_stack_usage.h"
+#include "sys/alt_work.h"
 
 unsigned float* Operator1;	//First operator
 unsigned float* Operator2;	//Second operator
@@ -13,6 +18,28 @@ unsigned float* Memory;		//Used to store an operator
 byte*    Op;				//Operation to perform
 unsigned float* Result;		//Result of the calculation
 
+static calc_proto proto;	//Binary request/response link to the host
+static calc_out   out;		//Coalescing, non-blocking result output
+
+#ifdef ALT_STACK_PAINT
+#define CALC_STACK_REPORT_SECS 10
+
+static alt_stack_report stack_report;	//Periodic stack high water marks
+
+/* Report the stacks whose peak has grown since the last report */
+static void stack_report_print(alt_stack_report* report)
+{
+	static const char* const names[ALT_STACK_COUNT] = { "main", "exception", "interrupt" };
+	alt_u32 id;
+
+	for (id = 0; id < ALT_STACK_COUNT; id++)
+		if (report->grown & (1 << id))
+			calc_out_printf(&out, "Stack %s: peak %lu of %lu bytes\n", names[id],
+			                (unsigned long) report->usage[id].peak,
+			                (unsigned long) report->usage[id].size);
+}
+#endif
+
 
 int main()
 {
@@ -20,67 +47,80 @@ int main()
 	DECODE_MODE decode_mode;
 	PS2_DEVICE mode = get_mode(); //Check if mouse or keyboard
 	alt_u8 Operater1, Operator2;
+	int jtag = open("/dev/jtag_uart", O_RDWR | O_NONBLOCK);
+
+	calc_proto_init(&proto, jtag);
+	calc_out_init(&out, jtag, CALC_OUT_TX_LIMIT);
+#ifdef ALT_STACK_PAINT
+	alt_stack_report_start(&stack_report, CALC_STACK_REPORT_SECS * alt_ticks_per_second(),
+	                       stack_report_print, NULL);
+#endif
 
 	while( mode == PS2_KEYBOARD)
 	{
+		calc_proto_poll(&proto);	//Serve any framed requests from the host
+		alt_work_run();				//Interrupt work deferred to thread context
+
 		if (*Op == 0) //Addition
 		{
 			*Result = (*Operator1) + (*Operator2);
-			printf("Result: %d\n", *Result);
+			calc_out_printf(&out, "Result: %d\n", *Result);
 		}
 		else if (*Op == 1) //Subtraction
 		{
 			*Result = (*Operator1) - (*Operator2);
-			printf("Result: %d\n", *Result);
+			calc_out_printf(&out, "Result: %d\n", *Result);
 		}
 		else if (*Op == 2) //Multiplication
 		{
 			*Result = (*Operator1) * (*Operator2);
-			printf("Result: %d\n", *Result);
+			calc_out_printf(&out, "Result: %d\n", *Result);
 		}
 		else if (*Op == 3) //Division
 		{
 			*Result = (*Operator1) / (*Operator2);
-			printf("Result: %d\n", *Result);
+			calc_out_printf(&out, "Result: %d\n", *Result);
 		}
 		else if (*Op == 4) //Memory store
 		{
 			*Memory = *Operator1;
-			printf("\nCurrent Memory value: %d\n", *Result);
+			calc_out_printf(&out, "\nCurrent Memory value: %d\n", *Result);
 		}
 		else if (*Op == 5) //Memory clear
 		{
 			*Memory = 0;
-			printf("\nCurrent Memory value: %d\n", *Result);
+			calc_out_printf(&out, "\nCurrent Memory value: %d\n", *Result);
 		}
 		else if (*Op == 6) //Sine
 		{
 			*Result = sin((*Operator1));
-			printf("Result: %d\n", *Result);
+			calc_out_printf(&out, "Result: %d\n", *Result);
 		}
 		else if (*Op == 7) //Cosine
 		{
 			*Result = cos((*Operator1));
-			printf("Result: %d", *Result);
+			calc_out_printf(&out, "Result: %d", *Result);
 		}
 		else if (*Op == 8) //Tangent
 		{
 			*Result = tan((*Operator1));
-			printf("Result: %d", *Result);
+			calc_out_printf(&out, "Result: %d", *Result);
 		}
 		else if (*Op == 9) //Logarithm
 		{
 			*Result = log10((*Operator1));
-			printf("Result: %d", *Result);
+			calc_out_printf(&out, "Result: %d", *Result);
 		}
 		else if (*Op == 10) //Tangent
 		{
 			*Result = pow((*Operator1),(*Operator2));
-			printf("Result: %d", *Result);
+			calc_out_printf(&out, "Result: %d", *Result);
 		}
 		else
 		{
-			printf("Waiting for an operation...\n");
+			calc_out_printf(&out, "Waiting for an operation...\n");
 		}
+
+		calc_scratch_done(*Op);		//Free this calculation's temporaries
 	}
 }
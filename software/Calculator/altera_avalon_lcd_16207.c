@@ -491,6 +491,23 @@ int alt_lcd_16207_write(alt_fd* fd, const char* ptr, int len)
 /* This should be in a top level header file really */
 #define container_of(ptr, type, member) ((type *)((char *)ptr - offsetof(type, member)))
 
+#ifdef ALT_DEFERRED_WORK
+
+/*
+ * Deferred repaint, queued by the timeout routine.  The foreground may have
+ * started writing since, in which case it repaints anyway.
+ */
+
+static void alt_lcd_16207_repaint(void* context)
+{
+  alt_LCD_16207_dev * dev = (alt_LCD_16207_dev *) context;
+
+  if (dev->scrollmax > 0 && !dev->active)
+    lcd_repaint_screen(dev);
+}
+
+#endif /* ALT_DEFERRED_WORK */
+
 /*
  * Timeout routine is called every second
  */
@@ -505,9 +522,18 @@ alt_u32 alt_lcd_16207_timeout(void * context)
   else
     dev->scrollpos = dev->scrollpos + 1;
 
-  /* Repaint the panel unless the foreground will do it again soon */
+  /* Repaint the panel unless the foreground will do it again soon.  With
+   * ALT_DEFERRED_WORK that is left to thread context, since it can take 
+   * milliseconds.
+   */
   if (dev->scrollmax > 0 && !dev->active)
+  {
+#ifdef ALT_DEFERRED_WORK
+    if (alt_work_queue(&dev->repaint) == 0)
+      return dev->period;
+#endif
     lcd_repaint_screen(dev);
+  }
 
   return dev->period;
 }
@@ -568,6 +594,10 @@ void alt_lcd_16207_init(alt_LCD_16207_dev * dev)
   dev->scrollmax = 0;
   dev->active = 0;
 
+#ifdef ALT_DEFERRED_WORK
+  alt_work_init(&dev->repaint, alt_lcd_16207_repaint, dev, ALT_LCD_WORK_PRIORITY);
+#endif
+
   dev->period = alt_ticks_per_second() / 10; /* Call every 100ms */
 
   alt_alarm_start(&dev->alarm, dev->period, &alt_lcd_16207_timeout, dev);
@@ -5,6 +5,7 @@
 
 #include "sys/alt_dev.h"
 #include "sys/alt_alarm.h"
+#include "sys/alt_work.h"
 #include "os/alt_sem.h"
 
 #ifdef __cplusplus
@@ -25,6 +26,12 @@ extern "C"
 #define ALT_LCD_WIDTH         16
 #define ALT_LCD_VIRTUAL_WIDTH 80
 
+/* The priority of repaints from the scrolling alarm when ALT_DEFERRED_WORK
+ * is set: the lowest, since a late repaint only slows the scrolling. */
+#ifndef ALT_LCD_WORK_PRIORITY
+#define ALT_LCD_WORK_PRIORITY (ALT_WORK_PRIORITIES - 1)
+#endif
+
 typedef struct alt_LCD_16207_dev alt_LCD_16207_dev;
 struct alt_LCD_16207_dev
 {
@@ -60,6 +67,11 @@ struct alt_LCD_16207_dev
 
   ALT_SEM       (write_lock)/* Semaphore used to control access to the
                              * write buffer in multi-threaded mode */
+
+#ifdef ALT_DEFERRED_WORK
+  alt_work       repaint;   /* Queued by the timer call to repaint the 
+                             * display in thread context */
+#endif
 };
 
 /*
@@ -0,0 +1,177 @@
+/*
+ * calc_out.c - non-blocking, coalescing output stage for calculator results
+ *
+ * See calc_out.h.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include "calc_out.h"
+
+ALT_POOL_DEFINE_ONCHIP(calc_line_pool, calc_line, CALC_OUT_LINES);
+
+void calc_out_init(calc_out* o, int fd, int tx_limit)
+{
+	memset(o, 0, sizeof(*o));
+	o->fd       = fd;
+	o->tx_limit = tx_limit;
+}
+
+/* Put a line at the back of the queue */
+static void out_queue(calc_out* o, calc_line* line)
+{
+	line->next = NULL;
+	line->sent = 0;
+	if (o->tail)
+		o->tail->next = line;
+	else
+		o->head = line;
+	o->tail = line;
+}
+
+/*
+ * Drop the queued lines that have been overtaken by a newer one. A line
+ * that is partly written already must be finished, so that one stays.
+ */
+static void out_drop_stale(calc_out* o)
+{
+	calc_line** link = &o->head;
+	calc_line* line;
+
+	if (o->head && o->head->sent > 0)
+		link = &o->head->next;
+
+	while ((line = *link) != NULL)
+	{
+		*link = line->next;
+		calc_line_pool_free(line);
+		o->dropped++;
+	}
+	o->tail = o->head;
+}
+
+/*
+ * Number of bytes the driver still has to send, or -1 if it can't say (the
+ * small driver has no transmit ring and so no ioctl() support).
+ */
+static int out_queued(calc_out* o)
+{
+	int queued;
+
+	if (ioctl(o->fd, TIOCOUTQ, &queued) < 0)
+		return -1;
+	return queued;
+}
+
+void calc_out_flush(calc_out* o)
+{
+	calc_line* line;
+	int queued, n;
+
+	queued = out_queued(o);
+
+	while ((line = o->head) != NULL)
+	{
+		if (queued >= 0 && queued + line->len - line->sent > o->tx_limit)
+		{
+			o->deferred++;
+			return;
+		}
+
+		n = write(o->fd, line->text + line->sent, line->len - line->sent);
+		if (n > 0)
+		{
+			line->sent += n;
+			if (queued >= 0)
+				queued += n;
+		}
+		if (line->sent < line->len)
+			return;
+
+		o->head = line->next;
+		if (o->head == NULL)
+			o->tail = NULL;
+		calc_line_pool_free(line);
+	}
+
+	/*
+	 * Once the host has caught up, say what it missed. If the driver can't
+	 * say how much it has queued (queued < 0), it has at least taken all
+	 * the output by now, which is as caught up as can be told.
+	 */
+	if (o->deferred + o->dropped != o->reported && queued <= 0 &&
+	    (line = calc_line_pool_alloc()) != NULL)
+	{
+		n = snprintf(line->text, sizeof(line->text),
+		             "[output: %lu repeats suppressed, %lu stale lines dropped, "
+		             "%lu writes deferred]\n",
+		             o->suppressed, o->dropped, o->deferred);
+		o->reported = o->deferred + o->dropped;
+		if (n > (int) sizeof(line->text) - 1)
+			n = sizeof(line->text) - 1;
+		line->len = n;
+		out_queue(o, line);
+	}
+}
+
+void calc_out_vprintf(calc_out* o, const char* fmt, va_list ap)
+{
+	calc_line* line;
+	calc_line* summary;
+	int len;
+
+	/* With no buffer the line is lost, as if overtaken by the next one */
+	if (o->spare == NULL && (o->spare = calc_line_pool_alloc()) == NULL)
+	{
+		o->dropped++;
+		calc_out_flush(o);
+		return;
+	}
+	line = o->spare;
+
+	len = vsnprintf(line->text, sizeof(line->text), fmt, ap);
+	if (len < 0)
+		return;
+	if (len > (int) sizeof(line->text) - 1)
+		len = sizeof(line->text) - 1;
+
+	/* A repeat keeps the buffer for the next line */
+	if (len == o->last_len && memcmp(line->text, o->last, len) == 0)
+	{
+		o->repeats++;
+		o->suppressed++;
+		calc_out_flush(o);
+		return;
+	}
+
+	out_drop_stale(o);
+
+	if (o->repeats && (summary = calc_line_pool_alloc()) != NULL)
+	{
+		summary->len = snprintf(summary->text, sizeof(summary->text),
+		                        "(last line repeated %lu more times)\n",
+		                        o->repeats);
+		out_queue(o, summary);
+		o->repeats = 0;
+	}
+
+	memcpy(o->last, line->text, len);
+	o->last_len = len;
+
+	line->len = len;
+	out_queue(o, line);
+	o->spare = NULL;
+
+	calc_out_flush(o);
+}
+
+void calc_out_printf(calc_out* o, const char* fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	calc_out_vprintf(o, fmt, ap);
+	va_end(ap);
+}
@@ -0,0 +1,87 @@
+/*
+ * calc_out.h - non-blocking, coalescing output stage for calculator results
+ *
+ * The main loop re-prints the same result on every pass, and printf() on
+ * the JTAG UART stalls the loop whenever nobody is draining the port. Lines
+ * written through calc_out_printf() are instead:
+ *
+ *  - coalesced: a line identical to the previous one only bumps a repeat
+ *    count, which is reported once the line changes;
+ *  - held back while the driver's transmit ring holds more than tx_limit
+ *    bytes (found with the TIOCOUTQ ioctl). Only the newest line is kept;
+ *    an older one that was still waiting is stale and is dropped.
+ *
+ * After a period of backpressure (writes deferred or lines dropped), once
+ * the ring has drained, a summary of the suppressed, dropped and deferred
+ * counts is written. With the small driver, which can't say how much it
+ * still has to send, the ring counts as drained once it has taken all the
+ * output.
+ *
+ * Each line is formatted into a buffer from calc_line_pool, in onchip_mem,
+ * and that buffer is queued as it is until the driver has taken all of it,
+ * which may be many calls later. A line repeating the last one leaves its
+ * buffer to format the next line into. If every buffer is queued the new
+ * line is dropped; the pool's peak and failures show how many were needed.
+ */
+
+#ifndef __CALC_OUT_H__
+#define __CALC_OUT_H__
+
+#include <stdarg.h>
+#include "sys/alt_pool.h"
+
+/* Longest line */
+#ifndef CALC_OUT_LINE_LEN
+#define CALC_OUT_LINE_LEN 128
+#endif
+
+/*
+ * Line buffers: a partly written line, a repeat summary and the line after
+ * it can be queued at once, and the next line is formatted in a fourth.
+ */
+#ifndef CALC_OUT_LINES
+#define CALC_OUT_LINES 4
+#endif
+
+/* Default backlog limit: half of the fast JTAG UART driver's 2 KB ring */
+#ifndef CALC_OUT_TX_LIMIT
+#define CALC_OUT_TX_LIMIT 1024
+#endif
+
+typedef struct calc_line_s
+{
+	struct calc_line_s* next; /* In the queue (and the pool's free list) */
+	int           len;
+	int           sent;       /* Of which already written */
+	char          text[CALC_OUT_LINE_LEN];
+} calc_line;
+
+ALT_POOL_DECLARE(calc_line_pool, calc_line)
+
+typedef struct calc_out_s
+{
+	int           fd;
+	int           tx_limit;   /* Hold output while more than this is queued */
+	int           last_len;
+	calc_line*    head;       /* Lines waiting to be written, oldest first */
+	calc_line*    tail;
+	calc_line*    spare;      /* Buffer for the next line */
+	unsigned long repeats;    /* Copies of last not yet reported */
+	unsigned long suppressed; /* Duplicate lines coalesced */
+	unsigned long dropped;    /* Stale lines replaced before being written */
+	unsigned long deferred;   /* Writes held back by tx_limit */
+	unsigned long reported;   /* deferred + dropped at the last summary */
+	char          last[CALC_OUT_LINE_LEN];
+} calc_out;
+
+extern void calc_out_init(calc_out* o, int fd, int tx_limit);
+
+/* Queue one line of output; never blocks */
+extern void calc_out_printf(calc_out* o, const char* fmt, ...)
+	__attribute__((format(printf, 2, 3)));
+extern void calc_out_vprintf(calc_out* o, const char* fmt, va_list ap);
+
+/* Write whatever is waiting, if the transmit ring has room for it */
+extern void calc_out_flush(calc_out* o);
+
+#endif /* __CALC_OUT_H__ */
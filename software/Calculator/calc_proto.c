@@ -0,0 +1,436 @@
+/*
+ * calc_proto.c - framed binary request/response protocol for the calculator
+ *
+ * See calc_proto.h for the frame layout. The encode/decode half of this
+ * file is also built into the host-side client (with CALC_PROTO_HOST
+ * defined); the device half evaluates requests read from the JTAG UART.
+ */
+
+#include <string.h>
+#include <errno.h>
+#include "calc_proto.h"
+
+#ifndef CALC_PROTO_HOST
+#include <stdio.h>
+#include <unistd.h>
+#include <math.h>
+#include "sys/alt_irq_stats.h"
+#include "sys/alt_overlay.h"
+#include "sys/alt_work.h"
+#endif
+
+static void put_u16(unsigned char* p, unsigned short v)
+{
+	p[0] = v & 0xFF;
+	p[1] = v >> 8;
+}
+
+static unsigned short get_u16(const unsigned char* p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+static void put_f32(unsigned char* p, float f)
+{
+	unsigned int v;
+
+	memcpy(&v, &f, 4);
+	p[0] = v & 0xFF;
+	p[1] = (v >> 8) & 0xFF;
+	p[2] = (v >> 16) & 0xFF;
+	p[3] = (v >> 24) & 0xFF;
+}
+
+static float get_f32(const unsigned char* p)
+{
+	unsigned int v = p[0] | (p[1] << 8) | ((unsigned int) p[2] << 16) |
+	                 ((unsigned int) p[3] << 24);
+	float f;
+
+	memcpy(&f, &v, 4);
+	return f;
+}
+
+/*
+ * Bitwise CRC-16/CCITT. A 512 byte table would be faster but the tiny core
+ * has no data cache, so the table lookups would mostly go to SDRAM anyway.
+ */
+unsigned short calc_proto_crc16(const unsigned char* data, int len)
+{
+	unsigned short crc = 0xFFFF;
+	int i;
+
+	while (len-- > 0)
+	{
+		crc ^= (unsigned short) *data++ << 8;
+		for (i = 0; i < 8; i++)
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+	}
+	return crc;
+}
+
+/* Wrap the len bytes already at frame + 2 into a frame; returns its size */
+static int frame_seal(unsigned char* frame, int len)
+{
+	frame[0] = CALC_PROTO_SOF;
+	frame[1] = len;
+	put_u16(frame + 2 + len, calc_proto_crc16(frame + 1, len + 1));
+	return 2 + len + 2;
+}
+
+int calc_proto_encode_request(unsigned char* frame, const calc_request* req)
+{
+	unsigned char* p = frame + 2;
+	int i;
+
+	put_u16(p, req->id);
+	p[2] = req->opcode;
+	for (i = 0; i < req->nargs; i++)
+		put_f32(p + 3 + 4 * i, req->args[i]);
+
+	return frame_seal(frame, 3 + 4 * req->nargs);
+}
+
+int calc_proto_encode_response(unsigned char* frame, const calc_response* rsp)
+{
+	unsigned char* p = frame + 2;
+
+	put_u16(p, rsp->id);
+	p[2] = rsp->status;
+	put_f32(p + 3, rsp->result);
+
+	return frame_seal(frame, 7);
+}
+
+int calc_proto_deframe(const unsigned char* buf, int len,
+                       const unsigned char** payload, int* plen)
+{
+	int flen;
+
+	*plen = -1;
+
+	if (len == 0)
+		return 0;
+
+	if (buf[0] != CALC_PROTO_SOF)
+		return 1;
+
+	if (len < 2)
+		return 0;
+
+	if (buf[1] > CALC_PROTO_MAX_PAYLOAD)
+		return 1;
+
+	flen = 2 + buf[1] + 2;
+	if (len < flen)
+		return 0;
+
+	if (calc_proto_crc16(buf + 1, buf[1] + 1) != get_u16(buf + 2 + buf[1]))
+	{
+		/* The SOF may have been noise, so only skip past it */
+		*plen = -2;
+		return 1;
+	}
+
+	*payload = buf + 2;
+	*plen    = buf[1];
+	return flen;
+}
+
+int calc_proto_decode_request(const unsigned char* payload, int plen,
+                              calc_request* req)
+{
+	int i;
+
+	if (plen < 3 || ((plen - 3) & 3) != 0)
+		return -EINVAL;
+
+	req->id     = get_u16(payload);
+	req->opcode = payload[2];
+	req->nargs  = (plen - 3) / 4;
+	for (i = 0; i < req->nargs; i++)
+		req->args[i] = get_f32(payload + 3 + 4 * i);
+
+	return 0;
+}
+
+int calc_proto_decode_response(const unsigned char* payload, int plen,
+                               calc_response* rsp)
+{
+	if (plen != 7)
+		return -EINVAL;
+
+	rsp->id     = get_u16(payload);
+	rsp->status = payload[2];
+	rsp->result = get_f32(payload + 3);
+
+	return 0;
+}
+
+#ifndef CALC_PROTO_HOST
+
+static float calc_memory;
+
+static long calc_scratch_mem[CALC_SCRATCH_LEN / sizeof(long)];
+alt_arena   calc_scratch = ALT_ARENA_INIT(calc_scratch_mem);
+
+/* The most scratch memory used by one calculation, by opcode */
+static alt_u32 calc_scratch_peak[CALC_OP_COUNT];
+
+void calc_scratch_done(unsigned int op)
+{
+	alt_u32 used = alt_arena_reset(&calc_scratch);
+
+	if (op < CALC_OP_COUNT && used > calc_scratch_peak[op])
+		calc_scratch_peak[op] = used;
+}
+
+/* Number of operands each opcode consumes */
+static const unsigned char calc_op_nargs[CALC_OP_COUNT] =
+{
+	2, 2, 2, 2,	/* add, sub, mul, div */
+	1, 0,		/* memory store, memory clear */
+	1, 1, 1, 1,	/* sin, cos, tan, log10 */
+	2,		/* pow */
+	0,		/* interrupt statistics */
+	1		/* scratch memory peak */
+};
+
+void calc_eval(const calc_request* req, calc_response* rsp)
+{
+	float a = req->args[0];
+	float b = req->args[1];
+
+	rsp->id     = req->id;
+	rsp->status = CALC_STATUS_OK;
+	rsp->result = 0;
+
+	if (req->opcode >= CALC_OP_COUNT)
+	{
+		rsp->status = CALC_STATUS_BAD_OPCODE;
+		return;
+	}
+	if (req->nargs < calc_op_nargs[req->opcode])
+	{
+		rsp->status = CALC_STATUS_BAD_ARGS;
+		return;
+	}
+
+	switch (req->opcode)
+	{
+	case CALC_OP_ADD:    rsp->result = a + b; break;
+	case CALC_OP_SUB:    rsp->result = a - b; break;
+	case CALC_OP_MUL:    rsp->result = a * b; break;
+	case CALC_OP_DIV:    rsp->result = a / b; break;
+	case CALC_OP_MSTORE: rsp->result = calc_memory = a; break;
+	case CALC_OP_MCLEAR: rsp->result = calc_memory = 0; break;
+	case CALC_OP_SIN:    rsp->result = sin(a); break;
+	case CALC_OP_COS:    rsp->result = cos(a); break;
+	case CALC_OP_TAN:    rsp->result = tan(a); break;
+	case CALC_OP_LOG:    rsp->result = log10(a); break;
+	case CALC_OP_POW:    rsp->result = pow(a, b); break;
+	case CALC_OP_SCRATCH_PEAK:
+		if (a >= 0 && a < CALC_OP_COUNT)
+			rsp->result = calc_scratch_peak[(int) a];
+		else
+			rsp->status = CALC_STATUS_BAD_ARGS;
+		break;
+	}
+}
+
+#ifdef ALT_IRQ_STATS
+
+/* Write all of buf, waiting (and running deferred work) while the ring is full */
+static void calc_write_all(int fd, const char* buf, int len)
+{
+	int n;
+
+	while (len > 0)
+	{
+		n = write(fd, buf, len);
+		if (n > 0)
+		{
+			buf += n;
+			len -= n;
+		}
+		else if (n < 0 && errno != EWOULDBLOCK && errno != EAGAIN)
+			return;
+		else
+			alt_work_run();
+	}
+}
+
+#define CALC_IRQ_LINE_LEN 160
+
+/*
+ * The statistics dump is rarely used, so it runs from an overlay rather
+ * than taking room in onchip_mem for good.
+ */
+ALT_OVERLAY_DEFINE(calc_diag);
+
+/* Format one line of times: their mean, maximum and non-empty buckets */
+ALT_OVERLAY(calc_diag) static int calc_irq_time(char* line, int size, const char* name,
+                         const alt_irq_time* t, alt_u32 count)
+{
+	int len, i;
+
+	len = snprintf(line, size, "  %-8s mean %lu max %lu hist", name,
+	               (unsigned long) (t->total / count), (unsigned long) t->max);
+	for (i = 0; i < ALT_IRQ_STATS_BUCKETS && len < size; i++)
+		if (t->hist[i])
+			len += snprintf(line + len, size - len, " %d:%lu", i,
+			                (unsigned long) t->hist[i]);
+	if (len < size - 1)
+		line[len++] = '\n';
+	return len < size ? len : size - 1;
+}
+
+/*
+ * Write the statistics of every interrupt that has been taken as text,
+ * straight to the link: they are too long for the response batch, and
+ * the host only needs them to arrive before the response does. The caller
+ * must have sent the responses batched so far. The overlays' statistics
+ * follow. Returns the number of interrupts listed.
+ */
+ALT_OVERLAY(calc_diag) static int calc_irq_stats_dump(int fd)
+{
+	alt_irq_stats st;
+	alt_overlay* ovl;
+	char* line = alt_arena_alloc(&calc_scratch, CALC_IRQ_LINE_LEN);
+	unsigned int id;
+	int listed = 0;
+
+	if (line == NULL)
+		return 0;
+
+	calc_write_all(fd, line, snprintf(line, CALC_IRQ_LINE_LEN,
+	               "irq stats: times in 1/%lu s, hist bucket n from 2^(n-1)\n",
+	               (unsigned long) alt_irq_stats_freq()));
+
+	for (id = 0; id < 32; id++)
+	{
+		if (alt_irq_stats_get(id, &st) != 0 || st.count == 0)
+			continue;
+
+		calc_write_all(fd, line, snprintf(line, CALC_IRQ_LINE_LEN,
+		               "irq %u: %lu calls\n", id, (unsigned long) st.count));
+		calc_write_all(fd, line, calc_irq_time(line, CALC_IRQ_LINE_LEN,
+		               "latency", &st.latency, st.count));
+		calc_write_all(fd, line, calc_irq_time(line, CALC_IRQ_LINE_LEN,
+		               "duration", &st.duration, st.count));
+		listed++;
+	}
+
+	for (ovl = alt_overlay_list; ovl != NULL; ovl = ovl->next)
+		calc_write_all(fd, line, snprintf(line, CALC_IRQ_LINE_LEN,
+		               "overlay %s: %lu bytes, %lu calls, %lu loads%s\n",
+		               ovl->name, (unsigned long) alt_overlay_size(ovl),
+		               (unsigned long) ovl->calls, (unsigned long) ovl->loads,
+		               alt_overlay_is_resident(ovl) ? ", resident" : ""));
+
+	return listed;
+}
+
+#endif /* ALT_IRQ_STATS */
+
+void calc_proto_init(calc_proto* p, int fd)
+{
+	memset(p, 0, sizeof(*p));
+	p->fd = fd;
+}
+
+/* Push out as much of the response batch as the driver will take */
+static void calc_proto_flush(calc_proto* p)
+{
+	int n;
+
+	if (p->tx_fill == 0)
+		return;
+
+	n = write(p->fd, p->tx_buf, p->tx_fill);
+	if (n > 0)
+	{
+		p->tx_fill -= n;
+		memmove(p->tx_buf, p->tx_buf + n, p->tx_fill);
+	}
+}
+
+int calc_proto_poll(calc_proto* p)
+{
+	const unsigned char* payload;
+	calc_request req;
+	calc_response rsp;
+	unsigned int pos = 0;
+	int evaluated = 0;
+	int plen;
+	int n;
+
+	calc_proto_flush(p);
+
+	n = read(p->fd, p->rx_buf + p->rx_fill, CALC_PROTO_BUF_LEN - p->rx_fill);
+	if (n > 0)
+		p->rx_fill += n;
+
+	/*
+	 * Evaluate every complete frame, but stop early if the response batch
+	 * is full: the unread requests stay queued and the host sees that as
+	 * backpressure rather than lost responses.
+	 */
+	while (p->tx_fill + CALC_PROTO_RSP_FRAME <= CALC_PROTO_BUF_LEN)
+	{
+		n = calc_proto_deframe(p->rx_buf + pos, p->rx_fill - pos, &payload, &plen);
+		if (n == 0)
+			break;
+		pos += n;
+
+		if (plen == -2)
+			p->crc_errors++;
+		if (plen < 0)
+		{
+			p->resyncs++;
+			continue;
+		}
+
+		p->frames++;
+		if (calc_proto_decode_request(payload, plen, &req) == 0)
+		{
+			calc_eval(&req, &rsp);
+#ifdef ALT_IRQ_STATS
+			if (req.opcode == CALC_OP_IRQ_STATS)
+			{
+				/*
+				 * calc_proto_flush() may have left part of a frame in the
+				 * batch: send all of it first, or the text would land in
+				 * the middle of that frame.
+				 */
+				calc_write_all(p->fd, (const char*) p->tx_buf, p->tx_fill);
+				p->tx_fill = 0;
+				rsp.result = ALT_OVERLAY_CALL(calc_diag, calc_irq_stats_dump)(p->fd);
+			}
+#else
+			if (req.opcode == CALC_OP_IRQ_STATS)
+				rsp.status = CALC_STATUS_BAD_OPCODE;
+#endif
+		}
+		else
+		{
+			rsp.id     = plen >= 2 ? get_u16(payload) : 0;
+			rsp.status = CALC_STATUS_BAD_ARGS;
+			rsp.result = 0;
+			req.opcode = CALC_OP_COUNT;
+		}
+		calc_scratch_done(req.opcode);
+
+		p->tx_fill += calc_proto_encode_response(p->tx_buf + p->tx_fill, &rsp);
+		evaluated++;
+	}
+
+	p->rx_fill -= pos;
+	memmove(p->rx_buf, p->rx_buf + pos, p->rx_fill);
+
+	calc_proto_flush(p);
+
+	return evaluated;
+}
+
+#endif /* CALC_PROTO_HOST */
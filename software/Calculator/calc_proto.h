@@ -0,0 +1,156 @@
+/*
+ * calc_proto.h - framed binary request/response protocol for the calculator
+ *
+ * Requests and responses travel over /dev/jtag_uart as frames:
+ *
+ *   +------+-----+----------------------------+---------+
+ *   | 0xA5 | len | payload (len bytes)        | crc16   |
+ *   +------+-----+----------------------------+---------+
+ *
+ * All multi-byte fields are little endian. The CRC is CRC-16/CCITT
+ * (polynomial 0x1021, initial value 0xFFFF) over the len byte and the
+ * payload.
+ *
+ * Request payload:  id (u16), opcode (u8), operands (0..2 x f32)
+ * Response payload: id (u16), status (u8), result (f32)
+ *
+ * Requests are evaluated in arrival order and each one produces exactly
+ * one response carrying the same id, so a host may keep as many requests
+ * outstanding as it likes and match the responses up by id.
+ *
+ * CALC_OP_IRQ_STATS is a diagnostic: the device writes its interrupt 
+ * statistics (see sys/alt_irq_stats.h) to the link as lines of text, 
+ * which the deframer skips, and then responds with the number of 
+ * interrupts listed. It fails with CALC_STATUS_BAD_OPCODE unless the 
+ * application and BSP were built with ALT_IRQ_STATS.
+ *
+ * CALC_OP_SCRATCH_PEAK is another: its operand is an opcode, and the 
+ * result is the most scratch memory (calc_scratch) that any one request
+ * with that opcode has used, in bytes.
+ *
+ * This file is shared with the host-side client in host/, so it must not
+ * depend on anything from the BSP.
+ */
+
+#ifndef __CALC_PROTO_H__
+#define __CALC_PROTO_H__
+
+#define CALC_PROTO_SOF          0xA5
+
+#define CALC_PROTO_MAX_OPERANDS 2
+#define CALC_PROTO_MAX_PAYLOAD  (3 + 4 * CALC_PROTO_MAX_OPERANDS)
+#define CALC_PROTO_MAX_FRAME    (2 + CALC_PROTO_MAX_PAYLOAD + 2)
+#define CALC_PROTO_RSP_FRAME    (2 + 7 + 2)
+
+/* Opcodes; these match the values of *Op used by the PIO interface */
+#define CALC_OP_ADD     0
+#define CALC_OP_SUB     1
+#define CALC_OP_MUL     2
+#define CALC_OP_DIV     3
+#define CALC_OP_MSTORE  4
+#define CALC_OP_MCLEAR  5
+#define CALC_OP_SIN     6
+#define CALC_OP_COS     7
+#define CALC_OP_TAN     8
+#define CALC_OP_LOG     9
+#define CALC_OP_POW     10
+#define CALC_OP_IRQ_STATS 11	/* Not a PIO operation: dump the IRQ statistics */
+#define CALC_OP_SCRATCH_PEAK 12	/* Nor this: scratch memory used by an opcode */
+#define CALC_OP_COUNT   13
+
+/* Response status codes */
+#define CALC_STATUS_OK          0
+#define CALC_STATUS_BAD_OPCODE  1
+#define CALC_STATUS_BAD_ARGS    2
+
+/* Length of the rx/tx staging buffers used by calc_proto_poll() */
+#ifndef CALC_PROTO_BUF_LEN
+#define CALC_PROTO_BUF_LEN 256
+#endif
+
+typedef struct calc_request_s
+{
+	unsigned short id;
+	unsigned char  opcode;
+	unsigned char  nargs;
+	float          args[CALC_PROTO_MAX_OPERANDS];
+} calc_request;
+
+typedef struct calc_response_s
+{
+	unsigned short id;
+	unsigned char  status;
+	float          result;
+} calc_response;
+
+/* Incremental frame parser / response batcher for one connection */
+typedef struct calc_proto_s
+{
+	int           fd;
+	unsigned int  rx_fill;
+	unsigned int  tx_fill;
+	unsigned long frames;     /* Good frames received */
+	unsigned long crc_errors; /* Frames dropped because of a bad CRC */
+	unsigned long resyncs;    /* Bytes skipped looking for a frame start */
+	unsigned char rx_buf[CALC_PROTO_BUF_LEN];
+	unsigned char tx_buf[CALC_PROTO_BUF_LEN];
+} calc_proto;
+
+extern unsigned short calc_proto_crc16(const unsigned char* data, int len);
+
+extern int calc_proto_encode_request(unsigned char* frame,
+                                     const calc_request* req);
+extern int calc_proto_encode_response(unsigned char* frame,
+                                      const calc_response* rsp);
+
+/*
+ * Look for one complete frame at the start of buf. Returns the number of
+ * bytes consumed (0 if more data is needed) and sets *payload and *plen when a
+ * frame with a good CRC was found. Otherwise a single byte is consumed and
+ * *plen is set to -2 if it started a frame with a bad CRC, -1 if it was
+ * garbage.
+ */
+extern int calc_proto_deframe(const unsigned char* buf, int len,
+                              const unsigned char** payload, int* plen);
+
+extern int calc_proto_decode_request(const unsigned char* payload, int plen,
+                                     calc_request* req);
+extern int calc_proto_decode_response(const unsigned char* payload, int plen,
+                                      calc_response* rsp);
+
+#ifndef CALC_PROTO_HOST
+
+#include "sys/alt_arena.h"
+
+/* Size of the scratch arena for the temporaries of one calculation */
+#ifndef CALC_SCRATCH_LEN
+#define CALC_SCRATCH_LEN 1024
+#endif
+
+/*
+ * Scratch memory for a calculation's temporaries, all of which are freed
+ * by calc_scratch_done() when it ends, so evaluation never calls malloc().
+ */
+extern alt_arena calc_scratch;
+
+/* End a calculation of opcode op, recording the scratch memory it used */
+extern void calc_scratch_done(unsigned int op);
+
+extern void calc_proto_init(calc_proto* p, int fd);
+
+/*
+ * Service the connection without blocking: read whatever is available,
+ * evaluate every complete request and write the batched responses back.
+ * Returns the number of requests evaluated.
+ */
+extern int calc_proto_poll(calc_proto* p);
+
+/*
+ * Evaluate one request into its response. The PIO driven loop in
+ * Calculator.c does not use this: its results come from the hardware.
+ */
+extern void calc_eval(const calc_request* req, calc_response* rsp);
+
+#endif /* CALC_PROTO_HOST */
+
+#endif /* __CALC_PROTO_H__ */
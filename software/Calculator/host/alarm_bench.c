@@ -0,0 +1,234 @@
+/*
+ * alarm_bench.c - measure the cost of alt_tick() and alt_alarm_start() on
+ * the host with many alarms registered.
+ *
+ * alt_tick() is called directly from the main thread, so no clock thread
+ * is involved and the figures are pure CPU time for the HAL alarm code.
+ * Three measurements are made:
+ *
+ *   start  registering the alarms (random delays up to -p ticks)
+ *   idle   ticks on which no alarm expires: every alarm is due well after
+ *          the last measured tick
+ *   busy   periodic alarms with random periods of 1 to -p ticks, each
+ *          returning its own period; every callback checks that it ran on
+ *          the tick it was due
+ *
+ * alarm_bench_tickless is built with ALT_TICKLESS and supplies the clock
+ * driver's side of the tickless interface from a simulated counter, so
+ * alt_tick() is only called when the programmed deadline is reached. Both
+ * builds report how many calls to alt_tick() (i.e. interrupts) there were.
+ * The tickless build then also runs a single alarm 0xffffffff ticks away,
+ * which is filed in the top level of the wheel, through to its expiry by
+ * jumping the clock to each programmed deadline in turn.
+ *
+ * -s sets the initial tick count, e.g. -s 4294900000 to run across the
+ * point where its low word wraps round.
+ *
+ * Usage:
+ *   alarm_bench [-n alarms] [-t ticks] [-p period] [-s first]
+ *
+ * Build with "make alarm_bench alarm_bench_tickless" in this directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "sys/alt_alarm.h"
+
+typedef struct bench_alarm_s
+{
+  alt_alarm alarm;
+  alt_u32   period;
+  alt_u64   due;
+} bench_alarm;
+
+static bench_alarm*  alarms;
+static unsigned long callbacks;
+static unsigned long late;
+static unsigned long interrupts;
+
+/* The simulated system clock */
+static alt_u64 bench_now;
+
+#ifdef ALT_TICKLESS
+
+static alt_u64 bench_deadline;
+
+alt_u64 alt_sysclk_now (void)
+{
+  return bench_now;
+}
+
+void alt_sysclk_program (alt_u64 deadline)
+{
+  bench_deadline = deadline;
+}
+
+#endif /* ALT_TICKLESS */
+
+static unsigned int seed = 1;
+
+/* Deterministic, so that runs can be compared */
+static alt_u32 bench_rand (alt_u32 max)
+{
+  seed = seed * 1103515245 + 12345;
+  return 1 + (seed >> 8) % max;
+}
+
+static alt_u32 bench_callback (void* context)
+{
+  bench_alarm* a = context;
+
+  callbacks++;
+  if (alt_nticks64 () != a->due)
+    late++;
+
+  a->due += a->period;
+  return a->period;
+}
+
+static void bench_stop_all (int n)
+{
+  int i;
+
+  for (i = 0; i < n; i++)
+    alt_alarm_stop (&alarms[i].alarm);
+}
+
+static double bench_ticks (unsigned long ticks)
+{
+  unsigned long long start = hal_sim_now_ns ();
+  unsigned long i;
+
+  interrupts = 0;
+  for (i = 0; i < ticks; i++)
+  {
+    bench_now++;
+#ifdef ALT_TICKLESS
+    if (bench_now < bench_deadline)
+      continue;
+#endif
+    interrupts++;
+    alt_tick ();
+  }
+
+  return (double) (hal_sim_now_ns () - start) / ticks;
+}
+
+static void bench_reset (alt_u64 first)
+{
+  _alt_nticks = first;
+  bench_now   = first;
+#ifdef ALT_TICKLESS
+  bench_deadline = first;
+#endif
+}
+
+int main (int argc, char** argv)
+{
+  int           n      = 4096;
+  unsigned long ticks  = 100000;
+  alt_u32       period = 1000;
+  alt_u64       first  = 0;
+  unsigned long long start;
+  double        ns;
+  int           c, i;
+
+  while ((c = getopt (argc, argv, "n:t:p:s:")) != -1)
+  {
+    switch (c)
+    {
+    case 'n': n      = atoi (optarg); break;
+    case 't': ticks  = atol (optarg); break;
+    case 'p': period = atol (optarg); break;
+    case 's': first  = strtoull (optarg, NULL, 0); break;
+    default:
+      fprintf (stderr, "usage: %s [-n alarms] [-t ticks] [-p period] [-s first]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  if (n < 1 || ticks < 1 || period < 1)
+  {
+    fprintf (stderr, "%s: arguments must be positive\n", argv[0]);
+    return 2;
+  }
+
+  alarms = calloc (n, sizeof (*alarms));
+  if (!alarms)
+  {
+    perror ("calloc");
+    return 1;
+  }
+
+  alt_sysclk_init (1000);
+  bench_reset (first);
+
+  /* start */
+
+  start = hal_sim_now_ns ();
+  for (i = 0; i < n; i++)
+    alt_alarm_start (&alarms[i].alarm, bench_rand (period), bench_callback,
+                     &alarms[i]);
+  ns = (double) (hal_sim_now_ns () - start) / n;
+  printf ("start: %d alarms, %.1f ns per alt_alarm_start()\n", n, ns);
+  bench_stop_all (n);
+
+  /* idle */
+
+  for (i = 0; i < n; i++)
+    alt_alarm_start (&alarms[i].alarm, ticks + bench_rand (period),
+                     bench_callback, &alarms[i]);
+  ns = bench_ticks (ticks);
+  printf ("idle:  %d alarms, %lu ticks, %.1f ns per tick, %lu interrupts\n",
+          n, ticks, ns, interrupts);
+  bench_stop_all (n);
+
+  /* busy */
+
+  bench_reset (first);
+
+  callbacks = 0;
+  for (i = 0; i < n; i++)
+  {
+    alarms[i].period = bench_rand (period);
+    alarms[i].due    = alt_nticks64 () + alarms[i].period + 1;
+    alt_alarm_start (&alarms[i].alarm, alarms[i].period, bench_callback,
+                     &alarms[i]);
+  }
+  ns = bench_ticks (ticks);
+  printf ("busy:  %d alarms, %lu ticks, %.1f ns per tick, %lu interrupts, "
+          "%.2f callbacks per tick, %lu late\n",
+          n, ticks, ns, interrupts, (double) callbacks / ticks, late);
+  bench_stop_all (n);
+
+#ifdef ALT_TICKLESS
+
+  /* far */
+
+  bench_reset (first);
+
+  callbacks = 0;
+  interrupts = 0;
+  alarms[0].period = 0xffffffff;
+  alarms[0].due    = alt_nticks64 () + alarms[0].period + 1;
+  alt_alarm_start (&alarms[0].alarm, alarms[0].period, bench_callback,
+                   &alarms[0]);
+  while (!callbacks && interrupts < 1000)
+  {
+    bench_now = bench_deadline;
+    interrupts++;
+    alt_tick ();
+  }
+  printf ("far:   1 alarm, %lu ticks, %lu interrupts, %lu callbacks, %lu late\n",
+          alarms[0].period + 1UL, interrupts, callbacks, late);
+  if (!callbacks)
+    late++;
+  bench_stop_all (1);
+
+#endif /* ALT_TICKLESS */
+
+  free (alarms);
+  return late != 0;
+}
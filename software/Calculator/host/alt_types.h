@@ -0,0 +1,32 @@
+/*
+ * alt_types.h - the HAL's fixed width types, for BSP sources built on the
+ * host.
+ *
+ * The BSP's own alt_types.h makes alt_32 and alt_u32 long, which on a 64 
+ * bit host is 64 bits wide, so arithmetic that overflows on the target 
+ * would quietly not overflow here. This header is found first on the 
+ * include path (-I. comes ahead of the BSP's directories, and hal_sim.h 
+ * includes it before anything else), and its guard keeps the BSP's out.
+ * Pointers still do not fit in an alt_u32 on such a host, so BSP code 
+ * that keeps an address in one cannot be built here.
+ */
+
+#ifndef __ALT_TYPES_H__
+#define __ALT_TYPES_H__
+
+#ifndef ALT_ASM_SRC
+typedef signed char        alt_8;
+typedef unsigned char      alt_u8;
+typedef signed short       alt_16;
+typedef unsigned short     alt_u16;
+typedef signed int         alt_32;
+typedef unsigned int       alt_u32;
+typedef long long          alt_64;
+typedef unsigned long long alt_u64;
+#endif
+
+#define ALT_INLINE        __inline__
+#define ALT_ALWAYS_INLINE __attribute__ ((always_inline))
+#define ALT_WEAK          __attribute__((weak))
+
+#endif /* __ALT_TYPES_H__ */
@@ -0,0 +1,344 @@
+/*
+ * calc_client.c - host side client and benchmark for the calculator's
+ * binary protocol (see ../calc_proto.h).
+ *
+ * The JTAG UART is reached through whatever command provides a byte pipe
+ * to it, normally nios2-terminal. The command is started with its stdin
+ * and stdout connected to this program; anything it prints that is not a
+ * frame (banners etc.) is skipped by the deframer.
+ *
+ * Build:
+ *   cc -O2 -DCALC_PROTO_HOST -I.. -o calc_client calc_client.c ../calc_proto.c
+ *
+ * Usage:
+ *   calc_client [-e op[,a[,b]]] [-i] [-n count] [-w window] [-t] command [args...]
+ *
+ *   -e op,a,b   evaluate a single request and print the result
+ *   -i          print the device's interrupt statistics, followed by the
+ *               number of interrupts listed. Anything else the device 
+ *               prints meanwhile is passed through too.
+ *   -n count    number of requests (or text lines with -t) to time
+ *   -w window   maximum number of outstanding requests (default 32)
+ *   -t          time the text interface instead: count "Result:" lines
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+#include "calc_proto.h"
+
+static int to_dev   = -1;
+static int from_dev = -1;
+static pid_t child;
+
+static unsigned char rx_buf[4096];
+static int rx_fill;
+static int echo;	/* Copy bytes that are not part of a frame to stdout */
+
+static double now(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static void spawn(char** argv)
+{
+	int in[2], out[2];
+
+	if (pipe(in) < 0 || pipe(out) < 0)
+	{
+		perror("pipe");
+		exit(1);
+	}
+
+	child = fork();
+	if (child < 0)
+	{
+		perror("fork");
+		exit(1);
+	}
+	if (child == 0)
+	{
+		dup2(in[0], 0);
+		dup2(out[1], 1);
+		close(in[0]); close(in[1]);
+		close(out[0]); close(out[1]);
+		execvp(argv[0], argv);
+		perror(argv[0]);
+		_exit(127);
+	}
+
+	close(in[0]);
+	close(out[1]);
+	to_dev   = in[1];
+	from_dev = out[0];
+}
+
+static void write_all(const unsigned char* p, int len)
+{
+	while (len > 0)
+	{
+		int n = write(to_dev, p, len);
+		if (n < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			perror("write");
+			exit(1);
+		}
+		p   += n;
+		len -= n;
+	}
+}
+
+/* Read more data from the device; returns 0 on EOF */
+static int fill(void)
+{
+	int n;
+
+	if (rx_fill == sizeof(rx_buf))
+	{
+		fprintf(stderr, "receive buffer overflow\n");
+		exit(1);
+	}
+
+	n = read(from_dev, rx_buf + rx_fill, sizeof(rx_buf) - rx_fill);
+	if (n < 0 && errno != EINTR)
+	{
+		perror("read");
+		exit(1);
+	}
+	if (n > 0)
+		rx_fill += n;
+	return n != 0;
+}
+
+/*
+ * Pull every complete response out of rx_buf; returns how many were found.
+ * The first max - 1 are stored in rsps, followed by the last.
+ */
+static int drain(calc_response* rsps, int max, unsigned long* crc_errors)
+{
+	const unsigned char* payload;
+	int plen, n, pos = 0, found = 0;
+
+	while ((n = calc_proto_deframe(rx_buf + pos, rx_fill - pos, &payload, &plen)) > 0)
+	{
+		if (echo && plen == -1)
+			putchar(rx_buf[pos]);
+		pos += n;
+		if (plen == -2)
+			(*crc_errors)++;
+		if (plen >= 0 &&
+		    calc_proto_decode_response(payload, plen,
+		                               &rsps[found < max ? found : max - 1]) == 0)
+			found++;
+	}
+
+	rx_fill -= pos;
+	memmove(rx_buf, rx_buf + pos, rx_fill);
+	return found;
+}
+
+static int eval_one(int op, int nargs, float a, float b)
+{
+	unsigned char frame[CALC_PROTO_MAX_FRAME];
+	calc_request req;
+	calc_response rsp;
+	unsigned long crc_errors = 0;
+
+	req.id      = 1;
+	req.opcode  = op;
+	req.nargs   = nargs;
+	req.args[0] = a;
+	req.args[1] = b;
+	write_all(frame, calc_proto_encode_request(frame, &req));
+
+	while (drain(&rsp, 1, &crc_errors) == 0)
+		if (!fill())
+		{
+			fprintf(stderr, "connection closed\n");
+			return 1;
+		}
+
+	if (rsp.status != CALC_STATUS_OK)
+	{
+		fprintf(stderr, "request failed with status %d\n", rsp.status);
+		return 1;
+	}
+	printf("%g\n", rsp.result);
+	return 0;
+}
+
+/*
+ * Request n is n + 1, with id n. The device answers in order, so each
+ * response is checked against the request it should answer.
+ */
+static int bench_binary(long count, int window)
+{
+	unsigned char frame[CALC_PROTO_MAX_FRAME];
+	calc_request req;
+	calc_response* rsps;
+	unsigned long crc_errors = 0;
+	unsigned long bad = 0;
+	long sent = 0, done = 0;
+	double start, secs;
+	int got, i;
+
+	rsps = malloc(window * sizeof(*rsps));
+	if (!rsps)
+	{
+		perror("malloc");
+		return 1;
+	}
+
+	req.opcode = CALC_OP_ADD;
+	req.nargs  = 2;
+
+	start = now();
+	while (done < count)
+	{
+		/* Keep the pipeline full */
+		while (sent < count && sent - done < window)
+		{
+			req.id      = sent;
+			req.args[0] = sent;
+			req.args[1] = 1;
+			write_all(frame, calc_proto_encode_request(frame, &req));
+			sent++;
+		}
+
+		if (!fill())
+		{
+			fprintf(stderr, "connection closed after %ld responses\n", done);
+			free(rsps);
+			return 1;
+		}
+		got = drain(rsps, window, &crc_errors);
+
+		/* No more can be outstanding; any beyond are not checked */
+		for (i = 0; i < got && i < window; i++)
+		{
+			if (rsps[i].id != (unsigned short) (done + i) ||
+			    rsps[i].status != CALC_STATUS_OK ||
+			    rsps[i].result != (float) (done + i) + 1)
+				bad++;
+		}
+		if (got > window)
+			bad += got - window;
+		done += got;
+	}
+	secs = now() - start;
+	free(rsps);
+
+	printf("binary: %ld requests, window %d, %.3f s, %.0f requests/s, %lu crc errors, "
+	       "%lu bad responses\n", count, window, secs, count / secs, crc_errors, bad);
+	return crc_errors != 0 || bad != 0;
+}
+
+static int bench_text(long count)
+{
+	static const char tag[] = "Result:";
+	long lines = 0;
+	double start = 0, secs;
+	int i, match = 0;
+
+	/* Time from the first complete result line to the last */
+	while (lines < count)
+	{
+		if (!fill())
+		{
+			fprintf(stderr, "connection closed after %ld lines\n", lines);
+			return 1;
+		}
+
+		/* match is how much of the tag the current line has matched so far */
+		for (i = 0; i < rx_fill; i++)
+		{
+			if (rx_buf[i] == '\n')
+				match = 0;
+			else if (match >= 0 && rx_buf[i] == tag[match])
+			{
+				if (++match == sizeof(tag) - 1)
+				{
+					if (lines++ == 0)
+						start = now();
+					match = -1;
+				}
+			}
+			else
+				match = -1;
+		}
+		rx_fill = 0;
+	}
+	secs = now() - start;
+
+	printf("text: %ld result lines, %.3f s, %.0f results/s\n",
+	       count, secs, (count - 1) / secs);
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	long count = 10000;
+	int window = 32;
+	int text = 0;
+	int eval = 0, op = 0, nargs = 0;
+	float a = 0, b = 0;
+	int c, rc;
+
+	while ((c = getopt(argc, argv, "+e:in:w:t")) != -1)
+	{
+		switch (c)
+		{
+		case 'e':
+			eval  = 1;
+			nargs = sscanf(optarg, "%d,%f,%f", &op, &a, &b) - 1;
+			if (nargs < 0)
+				nargs = 0;
+			break;
+		case 'i':
+			eval  = 1;
+			echo  = 1;
+			op    = CALC_OP_IRQ_STATS;
+			nargs = 0;
+			break;
+		case 'n': count  = atol(optarg); break;
+		case 'w': window = atoi(optarg); break;
+		case 't': text   = 1; break;
+		default:
+			fprintf(stderr, "usage: %s [-e op[,a[,b]]] [-i] [-n count] [-w window] [-t] "
+			        "command [args...]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	if (optind >= argc || count <= 1 || window < 1)
+	{
+		fprintf(stderr, "%s: a transport command is required\n", argv[0]);
+		return 2;
+	}
+
+	signal(SIGPIPE, SIG_IGN);
+	spawn(argv + optind);
+
+	if (eval)
+		rc = eval_one(op, nargs, a, b);
+	else if (text)
+		rc = bench_text(count);
+	else
+		rc = bench_binary(count, window);
+
+	close(to_dev);
+	kill(child, SIGTERM);
+	waitpid(child, NULL, 0);
+	return rc;
+}
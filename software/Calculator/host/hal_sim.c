@@ -0,0 +1,268 @@
+/*
+ * hal_sim.c - host-side stand-in for the Nios II core and its interrupt
+ * controller. See hal_sim.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "sys/alt_irq.h"
+#include "sys/alt_alarm.h"
+
+#define HAL_SIM_MAX_DEVS 8
+
+extern void alt_irq_handler (void);
+
+static hal_sim_dev* hal_sim_devs[HAL_SIM_MAX_DEVS];
+static int          hal_sim_ndevs;
+
+/*
+ * Held by the main thread while its PIE bit is clear, and by the clock
+ * thread while it is running interrupt handlers.
+ */
+static pthread_mutex_t hal_sim_cpu_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static __thread int hal_sim_status;
+
+static volatile unsigned int       hal_sim_ienable;
+static volatile unsigned int       hal_sim_lines;
+static volatile unsigned long long hal_sim_ncycles;
+static volatile int                hal_sim_running;
+
+unsigned long long hal_sim_loop_cycles;
+unsigned long long hal_sim_irq_off_max;
+
+static unsigned long long hal_sim_irq_off_since;
+
+static unsigned int hal_sim_cycles_per_tick;
+static unsigned int hal_sim_lockstep_cycles;
+static pthread_t    hal_sim_thread;
+
+static hal_sim_dev* hal_sim_find (void* addr)
+{
+  unsigned long a = (unsigned long) addr;
+  int i;
+
+  for (i = 0; i < hal_sim_ndevs; i++)
+  {
+    if (a >= hal_sim_devs[i]->base &&
+        a <  hal_sim_devs[i]->base + hal_sim_devs[i]->span)
+    {
+      return hal_sim_devs[i];
+    }
+  }
+
+  fprintf (stderr, "hal_sim: access to unmapped address 0x%lx\n", a);
+  abort ();
+}
+
+/* Advance every device by one simulated cycle; returns the cycle number */
+static unsigned long long hal_sim_step (void)
+{
+  unsigned long long cycle = ++hal_sim_ncycles;
+  int i;
+
+  for (i = 0; i < hal_sim_ndevs; i++)
+    if (hal_sim_devs[i]->step)
+      hal_sim_devs[i]->step (hal_sim_devs[i]);
+
+  return cycle;
+}
+
+/* In lockstep, time each stretch with interrupts disabled */
+static void hal_sim_pie (int old, int value)
+{
+  if ((old & NIOS2_STATUS_PIE_MSK) && !(value & NIOS2_STATUS_PIE_MSK))
+    hal_sim_irq_off_since = hal_sim_ncycles;
+  else if (!(old & NIOS2_STATUS_PIE_MSK) && (value & NIOS2_STATUS_PIE_MSK) &&
+           hal_sim_ncycles - hal_sim_irq_off_since > hal_sim_irq_off_max)
+    hal_sim_irq_off_max = hal_sim_ncycles - hal_sim_irq_off_since;
+}
+
+/* In lockstep, take any pending interrupt if the caller has enabled them */
+static void hal_sim_take_irq (void)
+{
+  while ((hal_sim_status & NIOS2_STATUS_PIE_MSK) && (hal_sim_lines & hal_sim_ienable))
+  {
+    hal_sim_pie (hal_sim_status, 0);
+    hal_sim_status = 0;
+    alt_irq_handler ();
+    hal_sim_pie (0, NIOS2_STATUS_PIE_MSK);
+    hal_sim_status = NIOS2_STATUS_PIE_MSK;
+  }
+}
+
+static void hal_sim_access (void)
+{
+  unsigned int i;
+
+  if (hal_sim_lockstep_cycles)
+  {
+    for (i = 0; i < hal_sim_lockstep_cycles; i++)
+      hal_sim_step ();
+    hal_sim_take_irq ();
+  }
+}
+
+void hal_sim_busy_loop (unsigned long long cycles)
+{
+  if (hal_sim_lockstep_cycles)
+  {
+    while (cycles-- > 0)
+    {
+      hal_sim_step ();
+      hal_sim_take_irq ();
+    }
+  }
+  else
+    hal_sim_loop_cycles += cycles;
+}
+
+unsigned int hal_sim_read (void* addr, int width)
+{
+  hal_sim_dev* dev = hal_sim_find (addr);
+
+  hal_sim_access ();
+
+  return dev->read (dev, ((unsigned long) addr - dev->base) / 4);
+}
+
+void hal_sim_write (void* addr, unsigned int data, int width)
+{
+  hal_sim_dev* dev = hal_sim_find (addr);
+
+  hal_sim_access ();
+  dev->write (dev, ((unsigned long) addr - dev->base) / 4, data);
+}
+
+unsigned int hal_sim_rdctl (int reg)
+{
+  switch (reg)
+  {
+  case 0:  return hal_sim_status;
+  case 3:  return hal_sim_ienable;
+  case 4:  return hal_sim_lines & hal_sim_ienable;
+  default: return 0;
+  }
+}
+
+void hal_sim_wrctl (int reg, int value)
+{
+  int old;
+
+  switch (reg)
+  {
+  case 0:
+    old = hal_sim_status;
+    hal_sim_status = value;
+
+    /*
+     * In lockstep there is no clock thread to keep out, and interrupt
+     * handlers that re-enable interrupts to allow nesting come this way
+     * too.
+     */
+    if (hal_sim_lockstep_cycles)
+    {
+      hal_sim_pie (old, value);
+      if (!(old & NIOS2_STATUS_PIE_MSK) && (value & NIOS2_STATUS_PIE_MSK))
+        hal_sim_take_irq ();
+    }
+    else if ((old & NIOS2_STATUS_PIE_MSK) && !(value & NIOS2_STATUS_PIE_MSK))
+      pthread_mutex_lock (&hal_sim_cpu_lock);
+    else if (!(old & NIOS2_STATUS_PIE_MSK) && (value & NIOS2_STATUS_PIE_MSK))
+      pthread_mutex_unlock (&hal_sim_cpu_lock);
+    break;
+  case 3:
+    hal_sim_ienable = value;
+    break;
+  }
+}
+
+void hal_sim_map (hal_sim_dev* dev)
+{
+  if (hal_sim_ndevs == HAL_SIM_MAX_DEVS)
+  {
+    fprintf (stderr, "hal_sim: too many devices\n");
+    abort ();
+  }
+  hal_sim_devs[hal_sim_ndevs++] = dev;
+}
+
+void hal_sim_irq (int irq, int level)
+{
+  if (level)
+    __sync_fetch_and_or (&hal_sim_lines, 1u << irq);
+  else
+    __sync_fetch_and_and (&hal_sim_lines, ~(1u << irq));
+}
+
+static void* hal_sim_clock (void* arg)
+{
+  unsigned long long cycle;
+  int tick;
+
+  /* This thread only ever runs at interrupt level */
+  hal_sim_status = 0;
+
+  while (hal_sim_running)
+  {
+    cycle = hal_sim_step ();
+
+    tick = hal_sim_cycles_per_tick && (cycle % hal_sim_cycles_per_tick) == 0;
+
+    if (tick || (hal_sim_lines & hal_sim_ienable))
+    {
+      pthread_mutex_lock (&hal_sim_cpu_lock);
+      if (hal_sim_lines & hal_sim_ienable)
+        alt_irq_handler ();
+      if (tick)
+        alt_tick ();
+      pthread_mutex_unlock (&hal_sim_cpu_lock);
+    }
+  }
+
+  return NULL;
+}
+
+void hal_sim_start (unsigned int cycles_per_tick, unsigned int ticks_per_second)
+{
+  hal_sim_cycles_per_tick = cycles_per_tick;
+  if (cycles_per_tick)
+    alt_sysclk_init (ticks_per_second);
+
+  hal_sim_status  = NIOS2_STATUS_PIE_MSK;
+  hal_sim_running = 1;
+
+  if (pthread_create (&hal_sim_thread, NULL, hal_sim_clock, NULL) != 0)
+  {
+    perror ("hal_sim: pthread_create");
+    exit (1);
+  }
+}
+
+void hal_sim_lockstep (unsigned int cycles_per_access)
+{
+  hal_sim_lockstep_cycles = cycles_per_access;
+  hal_sim_status          = NIOS2_STATUS_PIE_MSK;
+}
+
+void hal_sim_stop (void)
+{
+  hal_sim_running = 0;
+  pthread_join (hal_sim_thread, NULL);
+}
+
+unsigned long long hal_sim_cycles (void)
+{
+  return hal_sim_ncycles;
+}
+
+unsigned long long hal_sim_now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
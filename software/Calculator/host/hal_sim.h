@@ -0,0 +1,127 @@
+/*
+ * hal_sim.h - run unmodified HAL and driver sources on a development host
+ *
+ * This header is force-included (gcc -include hal_sim.h) ahead of every
+ * BSP source built for the host. It replaces the Nios II I/O and control
+ * register builtins with calls into hal_sim.c, which provides:
+ *
+ *  - a table of simulated peripherals, each a register read/write handler
+ *    mapped at its system.h base address;
+ *  - the status/ienable/ipending control registers. The main thread plays
+ *    the CPU; clearing PIE takes a lock that the interrupt thread needs
+ *    before it may call alt_irq_handler(), so alt_irq_disable_all() keeps
+ *    its meaning;
+ *  - a clock thread which advances every peripheral, delivers pending
+ *    interrupts and calls alt_tick() at the simulated system clock rate.
+ *
+ * Nothing here is used by the target build.
+ */
+
+#ifndef __HAL_SIM_H__
+#define __HAL_SIM_H__
+
+#ifndef __ASSEMBLER__
+
+/* The host's alt_types.h, with 32 bit alt_32 and alt_u32 */
+#include "alt_types.h"
+
+#define __builtin_ldwio(a)      hal_sim_read((a), 4)
+#define __builtin_ldhio(a)      ((short) hal_sim_read((a), 2))
+#define __builtin_ldhuio(a)     ((unsigned short) hal_sim_read((a), 2))
+#define __builtin_ldbio(a)      ((signed char) hal_sim_read((a), 1))
+#define __builtin_ldbuio(a)     ((unsigned char) hal_sim_read((a), 1))
+#define __builtin_stwio(a, d)   hal_sim_write((a), (d), 4)
+#define __builtin_sthio(a, d)   hal_sim_write((a), (d), 2)
+#define __builtin_stbio(a, d)   hal_sim_write((a), (d), 1)
+
+#define __builtin_rdctl(n)      hal_sim_rdctl(n)
+#define __builtin_wrctl(n, v)   hal_sim_wrctl((n), (v))
+
+/*
+ * alt_busy_sleep()'s delay loop is not run. In lockstep the simulated clock
+ * is advanced by the CPU cycles it would have taken; otherwise they are 
+ * added to hal_sim_loop_cycles.
+ */
+#define ALT_BUSY_SLEEP_LOOP(loops) \
+  hal_sim_busy_loop (((loops) > 0 ? (loops) : 1) * \
+                     (unsigned long long) ALT_BUSY_SLEEP_CYCLES_PER_LOOP)
+
+/* Interrupt statistics (ALT_IRQ_STATS) are kept in simulated cycles */
+#define ALT_IRQ_STATS_NOW()  hal_sim_cycles ()
+#define ALT_IRQ_STATS_FREQ() ALT_CPU_FREQ
+
+/*
+ * The host's errno is thread-local, which the "extern int errno" in 
+ * sys/alt_errno.h cannot link against, so ALT_ERRNO is the host's errno.
+ */
+#include <errno.h>
+#define __ALT_ERRNO_H__
+#define ALT_ERRNO errno
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/* A simulated peripheral. reg is the word offset from its base. */
+typedef struct hal_sim_dev_s
+{
+  unsigned long base;
+  unsigned long span;
+  unsigned int  (*read)  (struct hal_sim_dev_s* dev, int reg);
+  void          (*write) (struct hal_sim_dev_s* dev, int reg, unsigned int data);
+  void          (*step)  (struct hal_sim_dev_s* dev); /* once per cycle */
+  void*         context;
+} hal_sim_dev;
+
+extern unsigned int hal_sim_read (void* addr, int width);
+extern void         hal_sim_write (void* addr, unsigned int data, int width);
+extern unsigned int hal_sim_rdctl (int reg);
+extern void         hal_sim_wrctl (int reg, int value);
+
+extern void hal_sim_map (hal_sim_dev* dev);
+
+extern unsigned long long hal_sim_loop_cycles;
+
+extern void hal_sim_busy_loop (unsigned long long cycles);
+
+/* Drive interrupt line irq high (level != 0) or low */
+extern void hal_sim_irq (int irq, int level);
+
+/*
+ * Start the clock thread. Every simulated cycle each device is stepped and
+ * pending interrupts are delivered; every cycles_per_tick cycles alt_tick()
+ * is called (0 disables the system clock). Interrupts are enabled for the
+ * calling thread, as alt_main() would do.
+ */
+extern void hal_sim_start (unsigned int cycles_per_tick, unsigned int ticks_per_second);
+extern void hal_sim_stop (void);
+
+/*
+ * Or, instead of starting the clock thread, let the calling thread drive
+ * the simulated clock: each of its device accesses takes cycles_per_access
+ * cycles, and it takes pending interrupts whenever it has them enabled.
+ * The system clock must then come from a simulated timer.
+ */
+extern void hal_sim_lockstep (unsigned int cycles_per_access);
+
+/*
+ * In lockstep, the longest time in cycles for which the calling thread has
+ * had interrupts disabled, including while running interrupt handlers. It
+ * may be reset to 0 at any time.
+ */
+extern unsigned long long hal_sim_irq_off_max;
+
+/* Simulated cycles elapsed so far */
+extern unsigned long long hal_sim_cycles (void);
+
+/* Monotonic host time in nanoseconds, for measurements */
+extern unsigned long long hal_sim_now_ns (void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __ASSEMBLER__ */
+
+#endif /* __HAL_SIM_H__ */
@@ -0,0 +1,315 @@
+/*
+ * heap_bench.c - exercise the TLSF heap (sys/alt_tlsf.h) with a random mix
+ * of allocations, and report its fragmentation and cost.
+ *
+ * The heap is given a static 64 Kbyte region, standing in for the unused
+ * part of onchip_mem, and grows through sbrk(), which is simulated here 
+ * over a -m Kbyte arena. Every eighth growth, part of the arena is taken
+ * first, as another sbrk() user would, so that the heap must add a new 
+ * region rather than extend the last.
+ *
+ * -n operations are made on 1024 slots: each either allocates a slot (with
+ * malloc, or one time in eight memalign), frees it, or reallocates it. 
+ * Sizes are mostly small, with an occasional one of up to -s bytes. Each
+ * block is filled with a pattern that is checked before it is freed or 
+ * after it is moved, and alt_tlsf_check() is called every 1000 operations.
+ *
+ * One operation in 64 raises an interrupt whose handler frees a block and
+ * tries to allocate another. It is taken inside the next call into the 
+ * heap, when that marks the heap busy, so the free must be deferred and 
+ * the allocation must fail with EBUSY.
+ *
+ * Usage:
+ *   heap_bench [-n operations] [-s size] [-m kbytes]
+ *
+ * Build with "make heap_bench" in this directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include "system.h"
+#include "sys/alt_irq.h"
+#include "sys/alt_tlsf.h"
+
+#define SLOTS    1024
+#define HEAP_IRQ 5
+
+typedef struct slot_s
+{
+  unsigned char* p;
+  size_t         size;
+  unsigned char  fill;
+} slot;
+
+static slot          slots[SLOTS];
+static unsigned long errors;
+
+static char*  arena;
+static size_t arena_size;
+static size_t arena_used;
+static int    grows;
+
+static char   region[64 * 1024];
+
+static unsigned int seed = 1;
+
+/* Deterministic, so that runs can be compared */
+static unsigned int bench_rand (unsigned int max)
+{
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 8) % max;
+}
+
+/* Replaces the C library's, for the heap's calls to ALT_SBRK */
+void* sbrk (intptr_t incr)
+{
+  char*  p;
+  size_t gap = (++grows % 8) == 0 ? 256 : 0;
+
+  if (incr < 0 || arena_used + gap + incr > arena_size)
+  {
+    errno = ENOMEM;
+    return (void*) -1;
+  }
+
+  p           = arena + arena_used + gap;
+  arena_used += gap + incr;
+  return p;
+}
+
+static void fill (slot* s)
+{
+  size_t i;
+
+  for (i = 0; i < s->size; i++)
+    s->p[i] = (unsigned char) (s->fill + i);
+}
+
+static void verify (slot* s, size_t size, const char* what)
+{
+  size_t i;
+
+  for (i = 0; i < size; i++)
+  {
+    if (s->p[i] != (unsigned char) (s->fill + i))
+    {
+      printf ("%s: block %p of %lu bytes corrupt at %lu\n", what, 
+              (void*) s->p, (unsigned long) s->size, (unsigned long) i);
+      errors++;
+      return;
+    }
+  }
+}
+
+static size_t bench_size (size_t max)
+{
+  switch (bench_rand (16))
+  {
+  case 0:  return bench_rand (max) + 1;
+  case 1:
+  case 2:  return bench_rand (1024) + 1;
+  default: return bench_rand (64) + 1;
+  }
+}
+
+/* The interrupt handler's block, and how often it found the heap busy */
+
+static slot          isr_slot;
+static unsigned long isr_busy;
+static unsigned long isr_calls;
+
+static void heap_isr (void* context)
+{
+  void* p;
+
+  hal_sim_irq (HEAP_IRQ, 0);
+  isr_calls++;
+
+  if (isr_slot.p)
+  {
+    verify (&isr_slot, isr_slot.size, "isr free");
+    alt_tlsf_free (isr_slot.p);
+    isr_slot.p = NULL;
+  }
+
+  p = alt_tlsf_malloc (16);
+  if (p)
+  {
+    printf ("isr malloc succeeded while the heap was busy\n");
+    errors++;
+    alt_tlsf_free (p);
+  }
+  else if (errno == EBUSY)
+    isr_busy++;
+}
+
+int main (int argc, char** argv)
+{
+  unsigned long      n    = 200000;
+  size_t             max  = 16384;
+  unsigned long      ops  = 0;
+  unsigned long      fails = 0;
+  unsigned long long t0, t1;
+  alt_tlsf_stats_t   st;
+  slot*              s;
+  unsigned char*     p;
+  size_t             size;
+  size_t             align;
+  int                c, i;
+
+  arena_size = 4096 * 1024;
+
+  while ((c = getopt (argc, argv, "n:s:m:")) != -1)
+  {
+    switch (c)
+    {
+    case 'n': n          = strtoul (optarg, NULL, 0); break;
+    case 's': max        = strtoul (optarg, NULL, 0); break;
+    case 'm': arena_size = strtoul (optarg, NULL, 0) * 1024; break;
+    default:
+      fprintf (stderr, "usage: %s [-n operations] [-s size] [-m kbytes]\n", 
+               argv[0]);
+      return 2;
+    }
+  }
+
+  if (max < 1 || (arena = malloc (arena_size)) == NULL)
+  {
+    fprintf (stderr, "%s: bad arguments\n", argv[0]);
+    return 2;
+  }
+
+  if (alt_tlsf_add_region (region + 1, sizeof (region) - 1) != 0)
+  {
+    fprintf (stderr, "%s: alt_tlsf_add_region() failed\n", argv[0]);
+    return 1;
+  }
+
+  alt_ic_isr_register (0, HEAP_IRQ, heap_isr, NULL, NULL);
+  hal_sim_lockstep (1);
+
+  t0 = hal_sim_now_ns ();
+
+  for (ops = 0; ops < n; ops++)
+  {
+    s = &slots[bench_rand (SLOTS)];
+
+    if (bench_rand (64) == 0 && !isr_slot.p)
+    {
+      isr_slot.size = bench_size (max);
+      isr_slot.fill = (unsigned char) ops;
+      isr_slot.p    = alt_tlsf_malloc (isr_slot.size);
+      if (isr_slot.p)
+        fill (&isr_slot);
+      hal_sim_irq (HEAP_IRQ, 1);
+    }
+
+    if (!s->p)
+    {
+      size  = bench_size (max);
+      align = bench_rand (8) == 0 ? (size_t) 16 << bench_rand (6) : 0;
+      p     = align ? alt_tlsf_memalign (align, size) : alt_tlsf_malloc (size);
+
+      if (!p)
+      {
+        fails++;
+        continue;
+      }
+      if (((uintptr_t) p & (align ? align - 1 : sizeof (void*) - 1)) != 0 ||
+          alt_tlsf_usable_size (p) < size)
+      {
+        printf ("block %p of %lu bytes aligned to %lu is bad\n", (void*) p, 
+                (unsigned long) size, (unsigned long) align);
+        errors++;
+      }
+
+      s->p    = p;
+      s->size = size;
+      s->fill = (unsigned char) ops;
+      fill (s);
+    }
+    else if (bench_rand (4) == 0)
+    {
+      size = bench_size (max);
+      p    = alt_tlsf_realloc (s->p, size);
+      if (!p)
+      {
+        fails++;
+        continue;
+      }
+      s->p = p;
+      verify (s, size < s->size ? size : s->size, "realloc");
+      s->size = size;
+      fill (s);
+    }
+    else
+    {
+      verify (s, s->size, "free");
+      alt_tlsf_free (s->p);
+      s->p = NULL;
+    }
+
+    if (ops % 1000 == 999 && alt_tlsf_check () != 0)
+    {
+      printf ("alt_tlsf_check() failed after %lu operations\n", ops + 1);
+      errors++;
+      break;
+    }
+  }
+
+  t1 = hal_sim_now_ns ();
+
+  alt_tlsf_stats (&st);
+
+  printf ("%lu operations in %.1f ns each, %lu failed\n", ops, 
+          (double) (t1 - t0) / (ops ? ops : 1), fails);
+  printf ("heap %lu bytes in %lu regions (%lu of %lu Kbytes taken from sbrk)\n",
+          (unsigned long) st.size, (unsigned long) st.regions, 
+          (unsigned long) arena_used / 1024, (unsigned long) arena_size / 1024);
+  printf ("live %lu peak %lu free %lu largest %lu bytes, fragmentation %.1f%%\n",
+          (unsigned long) st.live, (unsigned long) st.peak, 
+          (unsigned long) st.free, (unsigned long) st.largest, 
+          st.free ? 100.0 * (1.0 - (double) st.largest / st.free) : 0.0);
+  printf ("%lu allocations, %lu failed; %lu interrupts, %lu found the heap busy, "
+          "%lu frees deferred\n", (unsigned long) st.allocs, 
+          (unsigned long) st.failures, isr_calls, isr_busy, 
+          (unsigned long) st.deferred);
+  printf ("free blocks by size ");
+  for (i = 0; i < ALT_TLSF_FL_COUNT; i++)
+    printf (" %lu", (unsigned long) st.hist[i]);
+  printf ("\n");
+
+  if (isr_busy != isr_calls)
+  {
+    printf ("%lu interrupts did not find the heap busy\n", isr_calls - isr_busy);
+    errors++;
+  }
+
+  /* Everything freed, the heap must be back to one free block per region */
+
+  for (i = 0; i < SLOTS; i++)
+  {
+    if (slots[i].p)
+    {
+      verify (&slots[i], slots[i].size, "final free");
+      alt_tlsf_free (slots[i].p);
+    }
+  }
+  alt_tlsf_free (isr_slot.p);
+  alt_tlsf_stats (&st);
+
+  if (alt_tlsf_check () != 0 || st.live != 0)
+  {
+    printf ("heap not empty or inconsistent after freeing everything\n");
+    errors++;
+  }
+
+  printf ("%lu errors\n", errors);
+
+  return errors != 0;
+}
@@ -0,0 +1,322 @@
+/*
+ * irq_latency.c - worst-case system clock tick latency while the JTAG UART
+ * interrupt is busy, with and without nested interrupts (ALT_IRQ_NESTED).
+ *
+ * The main thread drives the simulated clock (hal_sim_lockstep()), so that
+ * handlers take simulated time in proportion to their register accesses:
+ * -c cycles each. Two devices are simulated:
+ *
+ *  - a tick timer on IRQ 1, which times out every -p cycles. Its handler
+ *    acknowledges the timeout first thing, and the latency is the number
+ *    of cycles from the timeout to the acknowledgement;
+ *  - a receiver on IRQ 0 (the JTAG UART's), which receives a burst of 64
+ *    bytes at random intervals of up to -b cycles. Like the JTAG UART
+ *    driver, its handler reads the data register until it is empty, and
+ *    echoes each byte to the transmit register, plus -w further accesses
+ *    per byte.
+ *
+ * The tick is given priority level 0 and the receiver level 1 with
+ * alt_irq_set_priority(). In both builds that services the tick first when
+ * both are pending; only with ALT_IRQ_NESTED can the tick interrupt the
+ * receiver's handler.
+ *
+ * Built with ALT_IRQ_STATS, the statistics kept by alt_irq_handler() are
+ * printed as well, and checked against those measured here.
+ *
+ * Usage:
+ *   irq_latency [-n ticks] [-p period] [-b interval] [-c cycles] [-w accesses]
+ *
+ * Build with "make irq_latency irq_latency_nested irq_latency_stats" in this
+ * directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "system.h"
+#include "sys/alt_irq.h"
+#include "sys/alt_irq_stats.h"
+#include "io.h"
+
+#define TICK_BASE 0x1013000
+#define TICK_IRQ  1
+#define RX_BASE   0x1013020
+#define RX_IRQ    JTAG_UART_IRQ
+#define RX_BURST  64
+
+#define RX_DATA_RVALID_MSK 0x8000
+
+typedef struct tick_model_s
+{
+  hal_sim_dev        dev;
+  unsigned int       period;
+  unsigned int       counter;
+  int                to;
+  unsigned long long raised;     /* the cycle of the last timeout */
+  unsigned long      timeouts;
+  unsigned long      missed;     /* timeouts while the last was pending */
+} tick_model;
+
+typedef struct rx_model_s
+{
+  hal_sim_dev        dev;
+  unsigned int       interval;
+  unsigned int       counter;
+  unsigned int       fill;
+  unsigned char      next;       /* the next byte to arrive */
+  unsigned char      expect;     /* the next byte to be echoed */
+  unsigned long      bytes;
+  unsigned long      errors;
+} rx_model;
+
+static unsigned int seed = 1;
+
+/* Deterministic, so that runs can be compared */
+static unsigned int sim_rand (unsigned int max)
+{
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 8) % max;
+}
+
+static unsigned int tick_read (hal_sim_dev* dev, int reg)
+{
+  tick_model* m = dev->context;
+
+  return reg == 0 ? m->to : m->counter;
+}
+
+static void tick_write (hal_sim_dev* dev, int reg, unsigned int data)
+{
+  tick_model* m = dev->context;
+
+  m->to = 0;
+  hal_sim_irq (TICK_IRQ, 0);
+}
+
+static void tick_step (hal_sim_dev* dev)
+{
+  tick_model* m = dev->context;
+
+  if (++m->counter == m->period)
+  {
+    m->counter = 0;
+    m->timeouts++;
+    if (m->to)
+      m->missed++;
+    m->to     = 1;
+    m->raised = hal_sim_cycles ();
+    hal_sim_irq (TICK_IRQ, 1);
+  }
+}
+
+static unsigned int rx_read (hal_sim_dev* dev, int reg)
+{
+  rx_model* m = dev->context;
+
+  if (reg != 0 || m->fill == 0)
+    return 0;
+
+  if (--m->fill == 0)
+    hal_sim_irq (RX_IRQ, 0);
+
+  return RX_DATA_RVALID_MSK | (unsigned char) (m->next - m->fill - 1);
+}
+
+static void rx_write (hal_sim_dev* dev, int reg, unsigned int data)
+{
+  rx_model* m = dev->context;
+
+  if (reg != 1)
+    return;
+
+  if ((data & 0xff) != m->expect++)
+    m->errors++;
+  m->bytes++;
+}
+
+static void rx_step (hal_sim_dev* dev)
+{
+  rx_model* m = dev->context;
+
+  if (m->counter-- == 0)
+  {
+    m->counter = sim_rand (m->interval);
+    if (m->fill == 0)
+    {
+      m->fill  = RX_BURST;
+      m->next += RX_BURST;
+      hal_sim_irq (RX_IRQ, 1);
+    }
+  }
+}
+
+static tick_model tick;
+static rx_model   rx;
+
+static unsigned int        work;
+static unsigned long       ticks;
+static unsigned long long  worst;
+static unsigned long long  total;
+static unsigned long       hist[8];  /* latencies by power of four */
+
+#ifdef ALT_IRQ_STATS
+
+/* Print alt_irq_handler()'s statistics for one interrupt */
+static void print_stats (const char* name, alt_u32 id, alt_irq_stats* st)
+{
+  int i;
+
+  alt_irq_stats_get (id, st);
+
+  printf ("        %s irq %u: %lu calls, latency mean %.1f max %lu, "
+          "duration mean %.1f max %lu cycles\n", name, (unsigned) id,
+          (unsigned long) st->count,
+          st->count ? (double) st->latency.total / st->count : 0.0,
+          (unsigned long) st->latency.max,
+          st->count ? (double) st->duration.total / st->count : 0.0,
+          (unsigned long) st->duration.max);
+
+  printf ("          latency  ");
+  for (i = 0; i < ALT_IRQ_STATS_BUCKETS; i++)
+    printf (" %lu", (unsigned long) st->latency.hist[i]);
+  printf ("\n          duration ");
+  for (i = 0; i < ALT_IRQ_STATS_BUCKETS; i++)
+    printf (" %lu", (unsigned long) st->duration.hist[i]);
+  printf ("\n");
+}
+
+#endif /* ALT_IRQ_STATS */
+
+static void tick_handler (void* context)
+{
+  unsigned long long latency;
+  int                i;
+
+  IOWR (TICK_BASE, 0, 0);
+  latency = hal_sim_cycles () - tick.raised;
+
+  ticks++;
+  total += latency;
+  if (latency > worst)
+    worst = latency;
+  for (i = 0; i < 7 && latency >= (4ull << (2 * i)); i++)
+    ;
+  hist[i]++;
+}
+
+static void rx_handler (void* context)
+{
+  unsigned int data;
+  unsigned int i;
+
+  while ((data = IORD (RX_BASE, 0)) & RX_DATA_RVALID_MSK)
+  {
+    IOWR (RX_BASE, 1, data & 0xff);
+    for (i = 0; i < work; i++)
+      IORD (RX_BASE, 2);
+  }
+}
+
+int main (int argc, char** argv)
+{
+  unsigned long      n        = 10000;
+  unsigned int       period   = 50000;
+  unsigned int       interval = 4000;
+  unsigned int       cycles   = 8;
+  int                c, i;
+#ifdef ALT_IRQ_STATS
+  alt_irq_stats      st;
+  int                bad;
+#endif
+
+  while ((c = getopt (argc, argv, "n:p:b:c:w:")) != -1)
+  {
+    switch (c)
+    {
+    case 'n': n        = strtoul (optarg, NULL, 0); break;
+    case 'p': period   = strtoul (optarg, NULL, 0); break;
+    case 'b': interval = strtoul (optarg, NULL, 0); break;
+    case 'c': cycles   = strtoul (optarg, NULL, 0); break;
+    case 'w': work     = strtoul (optarg, NULL, 0); break;
+    default:
+      fprintf (stderr, "usage: %s [-n ticks] [-p period] [-b interval] [-c cycles] "
+               "[-w accesses]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  if (n < 1 || period < 2 || interval < 1 || cycles < 1)
+  {
+    fprintf (stderr, "%s: bad arguments\n", argv[0]);
+    return 2;
+  }
+
+  tick.period      = period;
+  tick.dev.base    = TICK_BASE;
+  tick.dev.span    = 32;
+  tick.dev.read    = tick_read;
+  tick.dev.write   = tick_write;
+  tick.dev.step    = tick_step;
+  tick.dev.context = &tick;
+  hal_sim_map (&tick.dev);
+
+  rx.interval      = interval;
+  rx.dev.base      = RX_BASE;
+  rx.dev.span      = 32;
+  rx.dev.read      = rx_read;
+  rx.dev.write     = rx_write;
+  rx.dev.step      = rx_step;
+  rx.dev.context   = &rx;
+  hal_sim_map (&rx.dev);
+
+  if (alt_irq_set_priority (TICK_IRQ, 0) != 0 ||
+      alt_irq_set_priority (RX_IRQ, 1) != 0)
+  {
+    fprintf (stderr, "%s: alt_irq_set_priority() failed\n", argv[0]);
+    return 1;
+  }
+
+  alt_ic_isr_register (0, TICK_IRQ, tick_handler, NULL, NULL);
+  alt_ic_isr_register (0, RX_IRQ, rx_handler, NULL, NULL);
+
+  hal_sim_lockstep (cycles);
+
+  /* The idle loop: one register access at a time */
+  while (ticks < n)
+    IORD (TICK_BASE, 1);
+
+#ifdef ALT_IRQ_NESTED
+  printf ("nested: ");
+#else
+  printf ("flat:   ");
+#endif
+  printf ("%lu ticks, %lu bytes received, tick latency mean %.1f worst %llu "
+          "cycles (%.2f us at %u MHz)\n", ticks, rx.bytes,
+          (double) total / ticks, worst,
+          (double) worst / (ALT_CPU_FREQ / 1000000), ALT_CPU_FREQ / 1000000);
+
+  printf ("        latency  ");
+  for (i = 0; i < 7; i++)
+    printf (" <%-6llu", 4ull << (2 * i));
+  printf (" more\n        ticks    ");
+  for (i = 0; i < 8; i++)
+    printf (" %-7lu", hist[i]);
+  printf ("\n        %lu missed ticks, %lu receive errors\n", tick.missed, rx.errors);
+
+#ifdef ALT_IRQ_STATS
+  /*
+   * alt_irq_handler() cannot see the time before it is entered, so its
+   * latencies may only be shorter than those measured from the timeout.
+   */
+  print_stats ("rx  ", RX_IRQ, &st);
+  print_stats ("tick", TICK_IRQ, &st);
+  bad = st.count != ticks || st.latency.max > worst;
+  if (bad)
+    printf ("        statistics do not match the ticks measured\n");
+
+  return tick.missed != 0 || rx.errors != 0 || bad;
+#else
+  return tick.missed != 0 || rx.errors != 0;
+#endif
+}
@@ -0,0 +1,735 @@
+/*
+ * jtag_uart_sim.c - run the JTAG UART driver on the host against a model
+ * of the altera_avalon_jtag_uart register file.
+ *
+ * The model has the JTAG_UART_READ_DEPTH/WRITE_DEPTH FIFOs from system.h,
+ * raises RI when the read FIFO has READ_THRESHOLD or fewer free slots (or
+ * holds data and the host has nothing more to send), raises WI when the
+ * write FIFO holds WRITE_THRESHOLD or fewer characters, sets AC whenever
+ * the host drains the write FIFO, and drives JTAG_UART_IRQ through
+ * hal_sim so the fast driver's ISR runs exactly as it would on the target.
+ * The "host" end moves up to -r characters per simulated cycle in each
+ * direction.
+ *
+ * Two modes:
+ *
+ *   jtag_uart_sim [-d dir] [-f]
+ *     Stream mode. Characters are fed in through the ModelSim stream files
+ *     in dir (default ../../../nios_system_sim): whenever
+ *     jtag_uart_input_mutex.dat holds a non-zero hex count, that many
+ *     characters are taken from jtag_uart_input_stream.dat (one binary
+ *     value per line, readmemb format) and the mutex is reset to 0. The
+ *     program reads them through the driver and writes them straight back,
+ *     and every character leaving the write FIFO is appended to
+ *     jtag_uart_output_stream.dat, one binary value per line, as the VHDL
+ *     model does. With -f the mutex is polled forever.
+ *
+ *   jtag_uart_sim -n bytes [-c chunk] [-r rate] [-l] [-d dir]
+ *     Benchmark. Transfers bytes characters to and then from the host in
+ *     chunk sized driver calls, checks what is read, and reports 
+ *     throughput and per-chunk latency (from the driver call to the last
+ *     character of the chunk reaching the host, and from the last 
+ *     character of a chunk entering the read FIFO to the driver returning
+ *     it). The model runs in its own free-running thread, so simulated 
+ *     cycles would only count how the host scheduled the two threads: 
+ *     both figures are in host time instead, and compare the drivers on 
+ *     this host, not on the target. Run this on a host with at least two
+ *     cores. -l also logs the output stream file.
+ *
+ *   jtag_uart_sim -t ms
+ *     Interrupts disabled. The main thread drives the simulated clock at
+ *     four cycles per register access (hal_sim_lockstep()) and echoes a
+ *     continuous stream from the host without blocking, as the calculator
+ *     does, while the LCD driver scrolls a long line on the panel from its
+ *     100 ms alarm, for ms milliseconds at ALT_CPU_FREQ. It reports the
+ *     longest time for which interrupts were disabled.
+ *
+ * Build with "make" in this directory; jtag_uart_sim_small is the same
+ * program linked against the ALTERA_AVALON_JTAG_UART_SMALL driver, and
+ * jtag_uart_sim_deferred is built with ALT_DEFERRED_WORK, so that the
+ * JTAG UART and LCD drivers do their interrupt time work in thread context.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "system.h"
+#include "io.h"
+#include "sys/alt_irq.h"
+#include "sys/alt_alarm.h"
+#include "sys/alt_work.h"
+#include "altera_avalon_jtag_uart.h"
+#include "altera_avalon_jtag_uart_regs.h"
+#include "altera_avalon_lcd_16207.h"
+#include "altera_avalon_lcd_16207_regs.h"
+
+extern int altera_avalon_jtag_uart_read (altera_avalon_jtag_uart_state* sp,
+  char* buffer, int space, int flags);
+extern int altera_avalon_jtag_uart_write (altera_avalon_jtag_uart_state* sp,
+  const char* ptr, int count, int flags);
+extern int altera_avalon_lcd_16207_write (altera_avalon_lcd_16207_state* sp,
+  const char* ptr, int len, int flags);
+
+/* ----------------------------------------------------------------------- */
+/* -------------------------------- MODEL -------------------------------- */
+
+#define RD_DEPTH JTAG_UART_READ_DEPTH
+#define WR_DEPTH JTAG_UART_WRITE_DEPTH
+
+typedef struct jtag_uart_model_s
+{
+  hal_sim_dev     dev;
+  pthread_mutex_t lock;
+
+  unsigned char   rfifo[RD_DEPTH];
+  unsigned int    rhead, rcount;
+  unsigned char   wfifo[WR_DEPTH];
+  unsigned int    whead, wcount;
+  unsigned int    control;     /* RE, WE and AC */
+  unsigned long   overflows;   /* DATA writes while the write FIFO was full */
+
+  /* Host end */
+  unsigned int    rate;
+  unsigned char*  in_buf;      /* waiting to be sent to the target */
+  size_t          in_len, in_pos, in_size;
+  void          (*sink) (struct jtag_uart_model_s* m, unsigned char c);
+  void          (*fed)  (struct jtag_uart_model_s* m);
+  unsigned long   in_total;    /* characters moved into the read FIFO */
+  unsigned long   out_total;   /* characters taken from the write FIFO */
+} jtag_uart_model;
+
+static unsigned int model_control (jtag_uart_model* m)
+{
+  unsigned int control = m->control;
+
+  if ((control & ALTERA_AVALON_JTAG_UART_CONTROL_RE_MSK) && m->rcount > 0 &&
+      (RD_DEPTH - m->rcount <= JTAG_UART_READ_THRESHOLD || m->in_pos == m->in_len))
+    control |= ALTERA_AVALON_JTAG_UART_CONTROL_RI_MSK;
+  if ((control & ALTERA_AVALON_JTAG_UART_CONTROL_WE_MSK) &&
+      m->wcount <= JTAG_UART_WRITE_THRESHOLD)
+    control |= ALTERA_AVALON_JTAG_UART_CONTROL_WI_MSK;
+
+  return control | ((WR_DEPTH - m->wcount) << ALTERA_AVALON_JTAG_UART_CONTROL_WSPACE_OFST);
+}
+
+static void model_update_irq (jtag_uart_model* m)
+{
+  hal_sim_irq (JTAG_UART_IRQ, (model_control (m) &
+                               (ALTERA_AVALON_JTAG_UART_CONTROL_RI_MSK |
+                                ALTERA_AVALON_JTAG_UART_CONTROL_WI_MSK)) != 0);
+}
+
+static unsigned int model_read (hal_sim_dev* dev, int reg)
+{
+  jtag_uart_model* m = dev->context;
+  unsigned int data = 0;
+
+  pthread_mutex_lock (&m->lock);
+
+  if (reg == ALTERA_AVALON_JTAG_UART_DATA_REG)
+  {
+    if (m->rcount > 0)
+    {
+      data = m->rfifo[m->rhead];
+      m->rhead = (m->rhead + 1) % RD_DEPTH;
+      m->rcount--;
+      data |= ALTERA_AVALON_JTAG_UART_DATA_RVALID_MSK |
+              (m->rcount << ALTERA_AVALON_JTAG_UART_DATA_RAVAIL_OFST);
+      model_update_irq (m);
+    }
+  }
+  else
+  {
+    data = model_control (m);
+  }
+
+  pthread_mutex_unlock (&m->lock);
+  return data;
+}
+
+static void model_write (hal_sim_dev* dev, int reg, unsigned int data)
+{
+  jtag_uart_model* m = dev->context;
+
+  pthread_mutex_lock (&m->lock);
+
+  if (reg == ALTERA_AVALON_JTAG_UART_DATA_REG)
+  {
+    if (m->wcount < WR_DEPTH)
+    {
+      m->wfifo[(m->whead + m->wcount) % WR_DEPTH] = data & ALTERA_AVALON_JTAG_UART_DATA_DATA_MSK;
+      m->wcount++;
+    }
+    else
+    {
+      m->overflows++;
+    }
+  }
+  else
+  {
+    m->control = (m->control & ALTERA_AVALON_JTAG_UART_CONTROL_AC_MSK) |
+                 (data & (ALTERA_AVALON_JTAG_UART_CONTROL_RE_MSK |
+                          ALTERA_AVALON_JTAG_UART_CONTROL_WE_MSK));
+    if (data & ALTERA_AVALON_JTAG_UART_CONTROL_AC_MSK)
+      m->control &= ~ALTERA_AVALON_JTAG_UART_CONTROL_AC_MSK;
+  }
+
+  model_update_irq (m);
+  pthread_mutex_unlock (&m->lock);
+}
+
+/* The host end of the cable: runs once per simulated cycle */
+static void model_step (hal_sim_dev* dev)
+{
+  jtag_uart_model* m = dev->context;
+  unsigned int n;
+
+  pthread_mutex_lock (&m->lock);
+
+  for (n = 0; n < m->rate && m->wcount > 0; n++)
+  {
+    unsigned char c = m->wfifo[m->whead];
+
+    m->whead = (m->whead + 1) % WR_DEPTH;
+    m->wcount--;
+    m->out_total++;
+    m->control |= ALTERA_AVALON_JTAG_UART_CONTROL_AC_MSK;
+    if (m->sink)
+      m->sink (m, c);
+  }
+
+  for (n = 0; n < m->rate && m->rcount < RD_DEPTH && m->in_pos < m->in_len; n++)
+  {
+    m->rfifo[(m->rhead + m->rcount) % RD_DEPTH] = m->in_buf[m->in_pos++];
+    m->rcount++;
+    m->in_total++;
+    m->control |= ALTERA_AVALON_JTAG_UART_CONTROL_AC_MSK;
+    if (m->fed)
+      m->fed (m);
+  }
+
+  model_update_irq (m);
+  pthread_mutex_unlock (&m->lock);
+}
+
+/* Queue characters for the host to send to the target */
+static void model_send (jtag_uart_model* m, const unsigned char* p, size_t len)
+{
+  pthread_mutex_lock (&m->lock);
+
+  if (m->in_len + len > m->in_size)
+  {
+    memmove (m->in_buf, m->in_buf + m->in_pos, m->in_len - m->in_pos);
+    m->in_len -= m->in_pos;
+    m->in_pos = 0;
+    if (m->in_len + len > m->in_size)
+    {
+      m->in_size = m->in_len + len;
+      m->in_buf  = realloc (m->in_buf, m->in_size);
+      if (!m->in_buf)
+      {
+        perror ("realloc");
+        exit (1);
+      }
+    }
+  }
+  memcpy (m->in_buf + m->in_len, p, len);
+  m->in_len += len;
+
+  pthread_mutex_unlock (&m->lock);
+}
+
+static jtag_uart_model model =
+{
+  { JTAG_UART_BASE, JTAG_UART_SPAN, model_read, model_write, model_step, &model },
+  PTHREAD_MUTEX_INITIALIZER,
+};
+
+/* ----------------------------------------------------------------------- */
+/* --------------------------- STREAM FILES ------------------------------ */
+
+static char  path_mutex[1024], path_input[1024], path_output[1024];
+static FILE* output_stream;
+
+static void log_output (jtag_uart_model* m, unsigned char c)
+{
+  int i;
+
+  for (i = 7; i >= 0; i--)
+    fputc ((c >> i) & 1 ? '1' : '0', output_stream);
+  fputc ('\n', output_stream);
+  fflush (output_stream);
+}
+
+/* Returns the count held in the mutex file, 0 if none */
+static unsigned long read_mutex (void)
+{
+  FILE* f = fopen (path_mutex, "r");
+  unsigned long count = 0;
+  char line[64];
+
+  if (!f)
+    return 0;
+  while (fgets (line, sizeof (line), f))
+    if (line[0] != '@')
+      count = strtoul (line, NULL, 16);
+  fclose (f);
+  return count;
+}
+
+/* Load count characters from the readmemb formatted stream file */
+static unsigned long read_stream (unsigned char* buf, unsigned long count)
+{
+  FILE* f = fopen (path_input, "r");
+  unsigned long addr = 0, n = 0;
+  char line[256];
+
+  if (!f)
+  {
+    perror (path_input);
+    return 0;
+  }
+
+  while (fgets (line, sizeof (line), f))
+  {
+    char* p = line + strspn (line, " \t");
+
+    if (*p == '@')
+      addr = strtoul (p + 1, NULL, 16);
+    else if (*p == '0' || *p == '1')
+    {
+      if (addr < count)
+      {
+        buf[addr] = strtoul (p, NULL, 2);
+        if (addr + 1 > n)
+          n = addr + 1;
+      }
+      addr++;
+    }
+  }
+  fclose (f);
+  return n;
+}
+
+static int stream_mode (altera_avalon_jtag_uart_state* sp, int follow)
+{
+  unsigned char* buf;
+  unsigned long count;
+  char echo[JTAG_UART_READ_DEPTH];
+  int idle = 0;
+  int n;
+
+  do
+  {
+    count = read_mutex ();
+    if (count)
+    {
+      buf = calloc (count, 1);
+      if (buf)
+      {
+        model_send (&model, buf, read_stream (buf, count));
+        free (buf);
+      }
+
+      FILE* f = fopen (path_mutex, "w");
+      if (f)
+      {
+        fputs ("0\n", f);
+        fclose (f);
+      }
+      idle = 0;
+    }
+
+    /* Echo everything the driver receives */
+    while ((n = altera_avalon_jtag_uart_read (sp, echo, sizeof (echo), O_NONBLOCK)) > 0)
+    {
+      fwrite (echo, 1, n, stdout);
+      altera_avalon_jtag_uart_write (sp, echo, n, 0);
+      idle = 0;
+    }
+
+    usleep (10000);
+  }
+  while (follow || idle++ < 100 || model.in_pos != model.in_len);
+
+  fflush (stdout);
+  return 0;
+}
+
+/* ----------------------------------------------------------------------- */
+/* ----------------------------- BENCHMARK ------------------------------- */
+
+static unsigned long       bench_chunk;
+static unsigned long long* bench_start;
+static unsigned long long* bench_done;
+
+static void bench_sink (jtag_uart_model* m, unsigned char c)
+{
+  if (m->out_total % bench_chunk == 0)
+    bench_done[m->out_total / bench_chunk - 1] = hal_sim_now_ns ();
+  if (output_stream)
+    log_output (m, c);
+}
+
+static void bench_fed (jtag_uart_model* m)
+{
+  if (m->in_total % bench_chunk == 0)
+    bench_start[m->in_total / bench_chunk - 1] = hal_sim_now_ns ();
+}
+
+/* Host times in ns */
+static void report (const char* what, unsigned long bytes, unsigned long long ns,
+                    unsigned long chunks)
+{
+  unsigned long long sum = 0, max = 0, lat;
+  unsigned long i;
+
+  for (i = 0; i < chunks; i++)
+  {
+    lat = bench_done[i] - bench_start[i];
+    sum += lat;
+    if (lat > max)
+      max = lat;
+  }
+
+  printf ("%s: %lu bytes in %.3f ms of host time (%.0f bytes/s); "
+          "chunk latency avg %.1f us, max %.1f us\n",
+          what, bytes, ns / 1e6, bytes / (ns / 1e9),
+          chunks ? sum / 1e3 / chunks : 0.0, max / 1e3);
+}
+
+static int bench_mode (altera_avalon_jtag_uart_state* sp, unsigned long bytes)
+{
+  unsigned long chunks = bytes / bench_chunk;
+  unsigned long long t0;
+  unsigned long done, i, errors = 0;
+  char* buf;
+  int n;
+
+  bytes = chunks * bench_chunk;
+  buf         = malloc (bytes);
+  bench_start = calloc (chunks, sizeof (*bench_start));
+  bench_done  = calloc (chunks, sizeof (*bench_done));
+  if (!buf || !bench_start || !bench_done || chunks == 0)
+  {
+    fprintf (stderr, "bad transfer size\n");
+    return 1;
+  }
+  for (i = 0; i < bytes; i++)
+    buf[i] = 'A' + i % 26;
+
+  /* Target to host */
+  model.sink = bench_sink;
+  t0 = hal_sim_now_ns ();
+  for (i = 0; i < chunks; i++)
+  {
+    bench_start[i] = hal_sim_now_ns ();
+    for (done = 0; done < bench_chunk; done += n)
+    {
+      n = altera_avalon_jtag_uart_write (sp, buf + i * bench_chunk + done,
+                                         bench_chunk - done, 0);
+      if (n < 0)
+      {
+        fprintf (stderr, "write failed: %d\n", n);
+        return 1;
+      }
+    }
+  }
+  while (model.out_total < bytes)
+  {
+    ALT_WORK_IDLE ();
+    sched_yield ();
+  }
+  report ("write", bytes, hal_sim_now_ns () - t0, chunks);
+
+  /* Host to target */
+  model.fed = bench_fed;
+  t0 = hal_sim_now_ns ();
+  model_send (&model, (unsigned char*) buf, bytes);
+  for (done = 0; done < bytes; done += n)
+  {
+    n = altera_avalon_jtag_uart_read (sp, buf, bytes - done < bench_chunk ?
+                                      bytes - done : bench_chunk, 0);
+    if (n < 0)
+    {
+      fprintf (stderr, "read failed: %d\n", n);
+      return 1;
+    }
+    for (i = 0; i < n; i++)
+      if (buf[i] != 'A' + (done + i) % 26)
+        errors++;
+    for (i = done / bench_chunk; i < (done + n) / bench_chunk; i++)
+      bench_done[i] = hal_sim_now_ns ();
+  }
+  report ("read", bytes, hal_sim_now_ns () - t0, chunks);
+
+  printf ("%lu write FIFO overflows, %lu read errors\n", model.overflows, errors);
+  return model.overflows != 0 || errors != 0;
+}
+
+/* ----------------------------------------------------------------------- */
+/* ------------------------- INTERRUPTS DISABLED ------------------------- */
+
+/*
+ * The LCD panel: BUSY for LCD_BUSY_CYCLES after each command or character
+ * (40 us at 50 MHz), and for LCD_CLEAR_CYCLES after a clear.
+ */
+
+#define LCD_BUSY_CYCLES  2000
+#define LCD_CLEAR_CYCLES 82000
+
+/* The system clock: IRQ 1 at 100 Hz, acknowledged by any write */
+
+#define TICK_BASE  0x1013000
+#define TICK_IRQ   1
+#define TICK_RATE  100
+
+typedef struct lcd_model_s
+{
+  hal_sim_dev     dev;
+  unsigned int    busy;
+  unsigned long   chars;
+} lcd_model;
+
+typedef struct tick_model_s
+{
+  hal_sim_dev     dev;
+  unsigned int    counter;
+} tick_model;
+
+static unsigned int lcd_read (hal_sim_dev* dev, int reg)
+{
+  lcd_model* m = dev->context;
+
+  return reg == 1 && m->busy ? ALTERA_AVALON_LCD_16207_STATUS_BUSY_MSK : 0;
+}
+
+static void lcd_write (hal_sim_dev* dev, int reg, unsigned int data)
+{
+  lcd_model* m = dev->context;
+
+  if (reg == 2)
+    m->chars++;
+  m->busy = (reg == 0 && data == 0x01) ? LCD_CLEAR_CYCLES : LCD_BUSY_CYCLES;
+}
+
+static void lcd_step (hal_sim_dev* dev)
+{
+  lcd_model* m = dev->context;
+
+  if (m->busy)
+    m->busy--;
+}
+
+static unsigned int tick_read (hal_sim_dev* dev, int reg)
+{
+  return 0;
+}
+
+static void tick_write (hal_sim_dev* dev, int reg, unsigned int data)
+{
+  hal_sim_irq (TICK_IRQ, 0);
+}
+
+static void tick_step (hal_sim_dev* dev)
+{
+  tick_model* m = dev->context;
+
+  if (++m->counter == ALT_CPU_FREQ / TICK_RATE)
+  {
+    m->counter = 0;
+    hal_sim_irq (TICK_IRQ, 1);
+  }
+}
+
+static lcd_model lcd_dev =
+{
+  { LCD_BASE, LCD_SPAN, lcd_read, lcd_write, lcd_step, &lcd_dev },
+};
+
+static tick_model tick_dev =
+{
+  { TICK_BASE, 32, tick_read, tick_write, tick_step, &tick_dev },
+};
+
+static void tick_handler (void* context)
+{
+  IOWR (TICK_BASE, 0, 0);
+  alt_tick ();
+}
+
+static unsigned long irqoff_errors;
+
+/* The host checks that what comes back is what it sent */
+static void irqoff_sink (jtag_uart_model* m, unsigned char c)
+{
+  if (c != (unsigned char) ((m->out_total - 1) % 251))
+    irqoff_errors++;
+}
+
+ALTERA_AVALON_LCD_16207_STATE_INSTANCE (LCD, lcd);
+
+static int irqoff_mode (altera_avalon_jtag_uart_state* sp, unsigned long ms)
+{
+  static const char banner[] = "\x1b[2JNios II calculator: results are echoed here\n";
+  unsigned long long end = (unsigned long long) ms * (ALT_CPU_FREQ / 1000);
+  unsigned long long init_max;
+  unsigned char* in;
+  char buf[256];
+  int fill = 0, n;
+  size_t i, len = 1 << 20;
+
+#ifdef ALTERA_AVALON_JTAG_UART_SMALL
+  fprintf (stderr, "the small driver has no interrupt handler to measure\n");
+  return 2;
+#endif
+
+  in = malloc (len);
+  if (!in)
+  {
+    perror ("malloc");
+    return 1;
+  }
+  for (i = 0; i < len; i++)
+    in[i] = i % 251;
+
+  hal_sim_map (&lcd_dev.dev);
+  hal_sim_map (&tick_dev.dev);
+  alt_sysclk_init (TICK_RATE);
+  alt_ic_isr_register (0, TICK_IRQ, tick_handler, NULL, NULL);
+
+  /* Four CPU cycles per register access, and interrupts enabled */
+  hal_sim_lockstep (4);
+
+#ifndef ALTERA_AVALON_JTAG_UART_SMALL
+  altera_avalon_jtag_uart_init (sp, JTAG_UART_IRQ_INTERRUPT_CONTROLLER_ID,
+                                JTAG_UART_IRQ);
+#endif
+  altera_avalon_lcd_16207_init (&lcd);
+
+  /* A line longer than the panel, so that the alarm scrolls it */
+  altera_avalon_lcd_16207_write (&lcd, banner, sizeof (banner) - 1, 0);
+
+  init_max = hal_sim_irq_off_max;
+  hal_sim_irq_off_max = 0;
+  end += hal_sim_cycles ();
+
+  model.sink = irqoff_sink;
+  model_send (&model, in, len);
+
+  /* The calculator's main loop: echo whatever arrives, without blocking */
+  while (hal_sim_cycles () < end)
+  {
+    if (fill == 0)
+    {
+      n = altera_avalon_jtag_uart_read (sp, buf, sizeof (buf), O_NONBLOCK);
+      if (n > 0)
+        fill = n;
+    }
+    if (fill > 0)
+    {
+      n = altera_avalon_jtag_uart_write (sp, buf, fill, O_NONBLOCK);
+      if (n > 0)
+      {
+        memmove (buf, buf + n, fill - n);
+        fill -= n;
+      }
+    }
+    alt_work_run ();
+
+    /* The rest of the loop, which makes no register accesses */
+    hal_sim_busy_loop (20);
+  }
+
+#ifdef ALT_DEFERRED_WORK
+  printf ("deferred: ");
+#else
+  printf ("in ISR:   ");
+#endif
+  printf ("%lu ms, %lu bytes echoed, %lu LCD characters, interrupts disabled "
+          "for at most %llu cycles (%.1f us at %u MHz)\n", ms, model.out_total,
+          lcd_dev.chars, hal_sim_irq_off_max,
+          (double) hal_sim_irq_off_max / (ALT_CPU_FREQ / 1000000), 
+          ALT_CPU_FREQ / 1000000);
+  printf ("          %llu cycles during initialisation, %lu echo errors\n",
+          init_max, irqoff_errors);
+
+  free (in);
+  return irqoff_errors != 0;
+}
+
+/* ----------------------------------------------------------------------- */
+
+ALTERA_AVALON_JTAG_UART_STATE_INSTANCE (JTAG_UART, jtag_uart);
+
+int main (int argc, char** argv)
+{
+  const char* dir = "../../../nios_system_sim";
+  unsigned long bytes = 0;
+  unsigned long ms = 0;
+  int follow = 0, log = 0;
+  int c, rc;
+
+  model.rate  = 1;
+  bench_chunk = 64;
+
+  while ((c = getopt (argc, argv, "d:fn:c:r:lt:")) != -1)
+  {
+    switch (c)
+    {
+    case 'd': dir = optarg; break;
+    case 'f': follow = 1; break;
+    case 'n': bytes = strtoul (optarg, NULL, 0); break;
+    case 'c': bench_chunk = strtoul (optarg, NULL, 0); break;
+    case 'r': model.rate = strtoul (optarg, NULL, 0); break;
+    case 'l': log = 1; break;
+    case 't': ms = strtoul (optarg, NULL, 0); break;
+    default:
+      fprintf (stderr, "usage: %s [-d dir] [-f] | -n bytes [-c chunk] [-r rate] [-l] "
+               "| -t ms\n", argv[0]);
+      return 2;
+    }
+  }
+
+  snprintf (path_mutex,  sizeof (path_mutex),  "%s/jtag_uart_input_mutex.dat", dir);
+  snprintf (path_input,  sizeof (path_input),  "%s/jtag_uart_input_stream.dat", dir);
+  snprintf (path_output, sizeof (path_output), "%s/jtag_uart_output_stream.dat", dir);
+
+  if (ms)
+  {
+    hal_sim_map (&model.dev);
+    return irqoff_mode (&jtag_uart, ms);
+  }
+
+  if (!bytes || log)
+  {
+    output_stream = fopen (path_output, "w");
+    if (!output_stream)
+    {
+      perror (path_output);
+      return 1;
+    }
+    model.sink = log_output;
+  }
+
+  hal_sim_map (&model.dev);
+  hal_sim_start (1000, 1000);
+
+#ifndef ALTERA_AVALON_JTAG_UART_SMALL
+  altera_avalon_jtag_uart_init (&jtag_uart, JTAG_UART_IRQ_INTERRUPT_CONTROLLER_ID,
+                                JTAG_UART_IRQ);
+#endif
+
+  rc = bytes ? bench_mode (&jtag_uart, bytes) : stream_mode (&jtag_uart, follow);
+
+  hal_sim_stop ();
+  if (output_stream)
+    fclose (output_stream);
+  return rc;
+}
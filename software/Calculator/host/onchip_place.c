@@ -0,0 +1,630 @@
+/*
+ * onchip_place.c - choose the code and tables to run from onchip_mem, from
+ * a profile of the calculator, and write a linker script that puts them
+ * there.
+ *
+ * The application and BSP are compiled with -ffunction-sections and
+ * -fdata-sections, so that every function and table has an input section
+ * of its own, and the linker map (Calculator.map) lists each one with its
+ * address, size and object file. Their weights are taken from:
+ *
+ *  - the PC sample histogram in gmon.out, written by nios2-download when
+ *    the BSP is built with ALT_PROVIDE_GMON. Samples are shared out between
+ *    the sections that each histogram bucket overlaps. The sampler runs in
+ *    the system clock interrupt, so it never sees code that runs with
+ *    interrupts disabled: the interrupt path and the tables it uses must be
+ *    weighed with counts instead;
+ *  - and/or a counts file (-c), one "name weight" pair per line, where name
+ *    is an input section or a symbol in the map. Weights are in samples,
+ *    or in cycles when followed by "c" (as from trace counts, or the
+ *    interrupt durations printed by "calc_client -i"), and are added to
+ *    any from the histogram. '#' starts a comment.
+ *
+ * Sections are then taken greedily by weight per byte until the budget is
+ * spent: by default, what onchip_mem has left beside .exceptions, the
+ * .onchip_mem partition and the overlay window. Anything copied or called
+ * by alt_load() before .exceptions is copied is never taken, nor are the
+ * small data sections, which must stay within reach of the global pointer.
+ *
+ * The linker script written (-o) is the BSP's linker.x, with the chosen
+ * sections listed at the end of the .exceptions output section. That is
+ * already in onchip_mem, is matched before .text, .rodata and .rwdata, and
+ * is copied there by alt_load(), so nothing else needs to change. The
+ * report gives the projected speedup, 1 / ((1 - f) + f / r), where f is the
+ * fraction of the weight placed and r is the speed of onchip_mem relative
+ * to SDRAM (-r). With -t, the measured speedup is given as well, from the
+ * times taken by the same workload before and after, together with the
+ * value of r that would have predicted it.
+ *
+ * Usage:
+ *   onchip_place [-b bytes] [-c counts] [-f hz] [-r ratio] [-t before,after]
+ *                [-x pattern] [-o script] linker.x map [gmon.out]
+ *
+ * "make onchip_place" in the application directory runs it; see the
+ * application Makefile. Build with "make onchip_place" in this directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fnmatch.h>
+
+#define MAX_SECTIONS 4096
+#define MAX_SYMBOLS  8192
+#define MAX_EXCLUDE  32
+#define LINE_LEN     1024
+
+/* An input section from the linker map */
+typedef struct section_s
+{
+  char*         name;
+  char*         file;    /* object, or archive(member) */
+  char*         out;     /* the output section it was placed in */
+  unsigned long addr;
+  unsigned long size;
+  double        weight;
+  int           placed;
+} section;
+
+/* A symbol from the linker map, and the input section it is defined in */
+typedef struct symbol_s
+{
+  char* name;
+  int   sec;
+} symbol;
+
+static section sections[MAX_SECTIONS];
+static int     nsections;
+static symbol  symbols[MAX_SYMBOLS];
+static int     nsymbols;
+
+static unsigned long onchip_base, onchip_len;
+static unsigned long exceptions_size, partition_size, window_size;
+
+/*
+ * Object files that must not be moved: crt0 runs before anything is
+ * copied, and alt_load() and the cache flushes it calls do the copying.
+ */
+static const char* exclude[MAX_EXCLUDE] =
+{
+  "*crt0.o",
+  "*(alt_load.o)",
+  "*(alt_dcache_flush_all.o)",
+  "*(alt_icache_flush_all.o)",
+};
+static int nexclude = 4;
+
+static void* xmalloc (size_t n)
+{
+  void* p = malloc (n);
+
+  if (p == NULL)
+  {
+    fprintf (stderr, "onchip_place: out of memory\n");
+    exit (1);
+  }
+  return p;
+}
+
+static char* xstrdup (const char* s)
+{
+  return strcpy (xmalloc (strlen (s) + 1), s);
+}
+
+static int is_hex (const char* s)
+{
+  return s[0] == '0' && s[1] == 'x';
+}
+
+/*
+ * Read the memory configuration and the input sections from a GNU ld map.
+ * An input section line is indented by one space; when its name is long,
+ * the address, size and file are wrapped onto the next line. Symbol lines
+ * are indented further and have just an address and a name.
+ */
+static int read_map (const char* path)
+{
+  FILE* f = fopen (path, "r");
+  char  line[LINE_LEN], name[LINE_LEN], out[LINE_LEN] = "";
+  char  a[LINE_LEN], b[LINE_LEN], c[LINE_LEN], d[LINE_LEN];
+  int   n, in_map = 0, pending = 0;
+  section* s;
+
+  if (f == NULL)
+  {
+    perror (path);
+    return -1;
+  }
+
+  while (fgets (line, sizeof (line), f) != NULL)
+  {
+    line[strcspn (line, "\r\n")] = '\0';
+
+    if (!in_map)
+    {
+      if (sscanf (line, "%s %s %s", a, b, c) == 3 && !strcmp (a, "onchip_mem") &&
+          is_hex (b) && is_hex (c))
+      {
+        onchip_base = strtoul (b, NULL, 16);
+        onchip_len  = strtoul (c, NULL, 16);
+      }
+      else if (!strcmp (line, "Linker script and memory map"))
+        in_map = 1;
+      continue;
+    }
+
+    n = sscanf (line, "%s %s %s %s", a, b, c, d);
+
+    /* The address, size and file of a wrapped input section */
+    if (pending)
+    {
+      pending = 0;
+      if (n >= 3 && is_hex (a) && is_hex (b))
+        sscanf (line, " %s %s %[^\n]", a, b, c);
+      else
+        continue;
+      goto input;
+    }
+
+    if (n < 1)
+      continue;
+
+    /* An output section */
+    if (line[0] == '.')
+    {
+      strcpy (out, a);
+      if (n >= 3 && is_hex (b) && is_hex (c))
+      {
+        if (!strcmp (a, ".exceptions"))
+          exceptions_size = strtoul (c, NULL, 16);
+        else if (!strcmp (a, ".onchip_mem"))
+          partition_size = strtoul (c, NULL, 16);
+        else if (!strncmp (a, ".overlay.", 9) && strtoul (c, NULL, 16) > window_size)
+          window_size = strtoul (c, NULL, 16);
+      }
+      continue;
+    }
+
+    /* A symbol, defined in the last input section read */
+    if (n == 2 && line[0] == ' ' && line[1] == ' ' && is_hex (a) &&
+        b[0] != '.' && b[0] != '[' && strchr (b, '(') == NULL &&
+        nsections > 0 && nsymbols < MAX_SYMBOLS)
+    {
+      symbols[nsymbols].name = xstrdup (b);
+      symbols[nsymbols].sec  = nsections - 1;
+      nsymbols++;
+      continue;
+    }
+
+    /* An input section, other than fill and the script's own patterns */
+    if (line[0] != ' ' || line[1] == ' ' || a[0] != '.')
+      continue;
+
+    strcpy (name, a);
+    if (n == 1)
+    {
+      pending = 1;
+      continue;
+    }
+    if (n < 4 || !is_hex (b) || !is_hex (c))
+      continue;
+    sscanf (line, " %*s %s %s %[^\n]", a, b, c);
+
+  input:
+    if (strtoul (b, NULL, 16) == 0 || nsections == MAX_SECTIONS)
+      continue;
+    s = &sections[nsections++];
+    s->name = xstrdup (name);
+    s->file = xstrdup (c);
+    s->out  = xstrdup (out);
+    s->addr = strtoul (a, NULL, 16);
+    s->size = strtoul (b, NULL, 16);
+  }
+
+  fclose (f);
+
+  if (onchip_len == 0)
+  {
+    fprintf (stderr, "%s: no onchip_mem region in the memory configuration\n", path);
+    return -1;
+  }
+  return 0;
+}
+
+/* Whether a section may be moved into .exceptions */
+static int movable (const section* s)
+{
+  static const char* kinds[] = { ".text", ".rodata", ".data" };
+  size_t len;
+  int i;
+
+  for (i = 0; i < 3; i++)
+  {
+    len = strlen (kinds[i]);
+    if (!strncmp (s->name, kinds[i], len) &&
+        (s->name[len] == '\0' || s->name[len] == '.'))
+      break;
+  }
+  if (i == 3)
+    return 0;
+
+  /* Merged strings and constants are shared between objects */
+  if (!strncmp (s->name, ".rodata.str", 11) || !strncmp (s->name, ".rodata.cst", 11))
+    return 0;
+
+  for (i = 0; i < nexclude; i++)
+    if (fnmatch (exclude[i], s->file, 0) == 0)
+      return 0;
+
+  return strcmp (s->out, ".text") == 0 || strcmp (s->out, ".rodata") == 0 ||
+         strcmp (s->out, ".rwdata") == 0;
+}
+
+static unsigned int get32 (const unsigned char* p)
+{
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int) p[3] << 24);
+}
+
+/*
+ * Share out the samples of each histogram record in gmon.out among the
+ * sections that its buckets overlap. Returns the number of samples, or -1.
+ */
+static double read_gmon (const char* path, unsigned int* rate)
+{
+  FILE*          f = fopen (path, "rb");
+  unsigned char  hdr[20], rec[32], bin[2];
+  unsigned long  low, high, bins, i;
+  double         width, from, to, lo, hi, total = 0;
+  unsigned int   count;
+  int            tag, j;
+
+  if (f == NULL)
+  {
+    perror (path);
+    return -1;
+  }
+
+  if (fread (hdr, sizeof (hdr), 1, f) != 1 || memcmp (hdr, "gmon", 4) != 0)
+  {
+    fprintf (stderr, "%s: not a gmon.out file\n", path);
+    fclose (f);
+    return -1;
+  }
+
+  while ((tag = getc (f)) != EOF)
+  {
+    if (tag == 1)
+    {
+      /* A call graph arc: from, self, count */
+      if (fseek (f, 12, SEEK_CUR) != 0)
+        break;
+      continue;
+    }
+    if (tag != 0 || fread (rec, sizeof (rec), 1, f) != 1)
+    {
+      fprintf (stderr, "%s: unexpected record %d\n", path, tag);
+      fclose (f);
+      return -1;
+    }
+
+    low   = get32 (rec);
+    high  = get32 (rec + 4);
+    bins  = get32 (rec + 8);
+    *rate = get32 (rec + 12);
+    width = bins ? (double) (high - low) / bins : 0;
+
+    for (i = 0; i < bins; i++)
+    {
+      if (fread (bin, sizeof (bin), 1, f) != 1)
+      {
+        fprintf (stderr, "%s: truncated\n", path);
+        fclose (f);
+        return -1;
+      }
+      if ((count = bin[0] | (bin[1] << 8)) == 0)
+        continue;
+
+      total += count;
+      from = low + i * width;
+      to   = from + width;
+      for (j = 0; j < nsections; j++)
+      {
+        lo = sections[j].addr > from ? sections[j].addr : from;
+        hi = sections[j].addr + sections[j].size < to ?
+             sections[j].addr + sections[j].size : to;
+        if (hi > lo)
+          sections[j].weight += count * (hi - lo) / width;
+      }
+    }
+  }
+
+  fclose (f);
+  return total;
+}
+
+/* Add the weights in a counts file. Returns their total, or -1. */
+static double read_counts (const char* path, double per_cycle)
+{
+  FILE*  f = fopen (path, "r");
+  char   line[LINE_LEN], name[LINE_LEN], unit;
+  double w, total = 0;
+  int    i, n, found, lineno = 0;
+
+  if (f == NULL)
+  {
+    perror (path);
+    return -1;
+  }
+
+  while (fgets (line, sizeof (line), f) != NULL)
+  {
+    lineno++;
+    line[strcspn (line, "#\r\n")] = '\0';
+    unit = 0;
+    if ((n = sscanf (line, "%s %lf%c", name, &w, &unit)) < 1)
+      continue;
+    if (n < 2 || (n == 3 && unit != 'c' && unit != ' ' && unit != '\t'))
+    {
+      fprintf (stderr, "%s:%d: expected \"name weight[c]\"\n", path, lineno);
+      fclose (f);
+      return -1;
+    }
+    if (unit == 'c')
+      w *= per_cycle;
+
+    found = -1;
+    for (i = 0; i < nsections && found < 0; i++)
+      if (!strcmp (sections[i].name, name))
+        found = i;
+    for (i = 0; i < nsymbols && found < 0; i++)
+      if (!strcmp (symbols[i].name, name))
+        found = symbols[i].sec;
+
+    if (found < 0)
+      fprintf (stderr, "%s:%d: warning: %s is not in the map\n", path, lineno, name);
+    else
+      sections[found].weight += w;
+    total += w;
+  }
+
+  fclose (f);
+  return total;
+}
+
+static int by_density (const void* a, const void* b)
+{
+  const section* x = *(const section**) a;
+  const section* y = *(const section**) b;
+  double dx = x->weight / x->size;
+  double dy = y->weight / y->size;
+
+  return dx < dy ? 1 : dx > dy ? -1 : strcmp (x->name, y->name);
+}
+
+/*
+ * The input section pattern for a section: the object file name, or
+ * archive:member, so that library sections that are not split up by
+ * -ffunction-sections can be placed too.
+ */
+static void pattern (FILE* f, const section* s)
+{
+  const char* file = s->file;
+  const char* base = strrchr (file, '/');
+  const char* paren = strchr (file, '(');
+
+  if (paren != NULL)
+  {
+    for (base = paren; base > file && base[-1] != '/'; base--)
+      ;
+    fprintf (f, "*%.*s:%.*s(%s)", (int) (paren - base), base,
+             (int) strcspn (paren + 1, ")"), paren + 1, s->name);
+  }
+  else
+    fprintf (f, "*%s(%s)", base ? base + 1 : file, s->name);
+}
+
+/*
+ * Write linker.x with the placed sections added to .exceptions, after
+ * the last of its own input sections.
+ */
+static int write_script (const char* in, const char* out, section** order, int n,
+                         unsigned long bytes)
+{
+  FILE* f = fopen (in, "r");
+  FILE* g;
+  char  line[LINE_LEN];
+  const char* eol;
+  int   i, done = 0;
+
+  if (f == NULL)
+  {
+    perror (in);
+    return -1;
+  }
+  if ((g = fopen (out, "w")) == NULL)
+  {
+    perror (out);
+    fclose (f);
+    return -1;
+  }
+
+  fprintf (g, "/*\n * Generated by onchip_place from %s - do not edit.\n"
+           " * Remove this file to link with %s again.\n */\n\n", in, in);
+
+  while (fgets (line, sizeof (line), f) != NULL)
+  {
+    fputs (line, g);
+    if (done || strstr (line, "KEEP (*(.exceptions));") == NULL)
+      continue;
+
+    eol = strstr (line, "\r\n") ? "\r\n" : "\n";
+    fprintf (g, "        /* onchip_place: %d sections, %lu bytes */%s", n, bytes, eol);
+    for (i = 0; i < n; i++)
+    {
+      fputs ("        ", g);
+      pattern (g, order[i]);
+      fputs (eol, g);
+    }
+    done = 1;
+  }
+
+  fclose (f);
+  if (fclose (g) != 0 || !done)
+  {
+    fprintf (stderr, "%s: %s\n", out, done ? "write failed" : "no .exceptions section to add to");
+    remove (out);
+    return -1;
+  }
+  return 0;
+}
+
+int main (int argc, char** argv)
+{
+  long          budget   = -1;
+  double        ratio    = 2.0;
+  double        freq     = 50000000.0;
+  double        before   = 0, after = 0;
+  const char*   counts   = NULL;
+  const char*   script   = NULL;
+  unsigned int  rate     = 0;
+  double        samples  = 0, weight, placed = 0, f, s, r;
+  unsigned long bytes    = 0, size;
+  section**     order;
+  int           c, i, n, chosen = 0, stale = 0;
+
+  while ((c = getopt (argc, argv, "b:c:f:r:t:x:o:")) != -1)
+  {
+    switch (c)
+    {
+    case 'b': budget = strtol (optarg, NULL, 0); break;
+    case 'c': counts = optarg; break;
+    case 'f': freq   = strtod (optarg, NULL); break;
+    case 'r': ratio  = strtod (optarg, NULL); break;
+    case 't':
+      if (sscanf (optarg, "%lf,%lf", &before, &after) != 2 || before <= 0 || after <= 0)
+      {
+        fprintf (stderr, "%s: -t needs two times, before,after\n", argv[0]);
+        return 2;
+      }
+      break;
+    case 'x':
+      if (nexclude == MAX_EXCLUDE)
+      {
+        fprintf (stderr, "%s: too many -x patterns\n", argv[0]);
+        return 2;
+      }
+      exclude[nexclude++] = optarg;
+      break;
+    case 'o': script = optarg; break;
+    default:
+      fprintf (stderr, "usage: %s [-b bytes] [-c counts] [-f hz] [-r ratio] "
+               "[-t before,after] [-x pattern] [-o script] linker.x map [gmon.out]\n",
+               argv[0]);
+      return 2;
+    }
+  }
+
+  if (argc - optind < 2 || argc - optind > 3 || ratio <= 0 || freq <= 0 ||
+      (argc - optind == 2 && counts == NULL))
+  {
+    fprintf (stderr, "%s: a linker script, a map and a profile (gmon.out or -c) "
+             "are required\n", argv[0]);
+    return 2;
+  }
+
+  if (read_map (argv[optind + 1]) != 0)
+    return 1;
+
+  if (argc - optind == 3)
+  {
+    if ((samples = read_gmon (argv[optind + 2], &rate)) < 0)
+      return 1;
+    printf ("%s: %.0f samples at %u Hz\n", argv[optind + 2], samples, rate);
+  }
+
+  /* Without a histogram, cycles are taken as they are */
+  weight = samples;
+  if (counts != NULL)
+  {
+    if ((f = read_counts (counts, rate ? rate / freq : 1.0)) < 0)
+      return 1;
+    weight += f;
+  }
+
+  if (weight <= 0)
+  {
+    fprintf (stderr, "%s: the profile is empty\n", argv[0]);
+    return 1;
+  }
+
+  if (budget < 0)
+  {
+    budget = onchip_len - exceptions_size - partition_size - window_size;
+    printf ("budget %ld bytes: onchip_mem %lu, less .exceptions %lu, .onchip_mem %lu "
+            "and overlays %lu\n", budget, onchip_len, exceptions_size, partition_size,
+            window_size);
+  }
+  else
+    printf ("budget %ld bytes\n", budget);
+
+  order = xmalloc (nsections * sizeof (*order) + 1);
+  for (i = n = 0; i < nsections; i++)
+  {
+    /* Sections placed by an earlier run have no samples of their own */
+    if (!strcmp (sections[i].out, ".exceptions") && sections[i].addr >= onchip_base &&
+        strncmp (sections[i].name, ".exceptions", 11) != 0 &&
+        strcmp (sections[i].name, ".irq") != 0)
+      stale++;
+    if (sections[i].weight > 0 && movable (&sections[i]))
+      order[n++] = &sections[i];
+  }
+  if (stale)
+    fprintf (stderr, "warning: %d sections are already in .exceptions; profile a build "
+             "linked without the generated script\n", stale);
+
+  qsort (order, n, sizeof (*order), by_density);
+
+  printf ("\n  weight      %%   cum%%  bytes  section\n");
+  for (i = 0; i < n; i++)
+  {
+    size = (order[i]->size + 3) & ~3ul;
+    if (bytes + size > (unsigned long) budget)
+      continue;
+    bytes  += size;
+    placed += order[i]->weight;
+    order[i]->placed = 1;
+    order[chosen++] = order[i];
+    printf ("%8.1f %6.2f %6.2f %6lu  ", order[i]->weight,
+            100 * order[i]->weight / weight, 100 * placed / weight, order[i]->size);
+    pattern (stdout, order[i]);
+    printf ("\n");
+  }
+
+  f = placed / weight;
+  s = 1 / ((1 - f) + f / ratio);
+  printf ("\nplaced %d of %d sections, %lu of %ld bytes, %.1f%% of the weight\n",
+          chosen, n, bytes, budget, 100 * f);
+  printf ("projected speedup %.2fx, with onchip_mem %.2f times as fast as SDRAM\n",
+          s, ratio);
+
+  if (before > 0)
+  {
+    s = before / after;
+    r = 1 / s - (1 - f);
+    printf ("measured speedup %.2fx (%g before, %g after)", s, before, after);
+    if (r > 0 && f > 0)
+      printf (", as if onchip_mem were %.2f times as fast\n", f / r);
+    else
+      printf (", more than the placement alone accounts for\n");
+  }
+
+  if (script != NULL)
+  {
+    if (write_script (argv[optind], script, order, chosen, bytes) != 0)
+      return 1;
+    printf ("wrote %s\n", script);
+  }
+
+  return 0;
+}
@@ -0,0 +1,278 @@
+/*
+ * open_bench.c - cost of open() and close() through the HAL's device and
+ * filesystem lookup, as more devices are registered.
+ *
+ * Devices named /dev/dev0, /dev/dev1, ... are registered with alt_dev_reg()
+ * in steps of four times as many, up to -d devices, after -f filesystems 
+ * registered with alt_fs_reg() at /mnt/fs0, /mnt/fs1, ... (every other one
+ * with a trailing '/'). At each step, the newest and oldest devices and a
+ * file on each filesystem are opened and closed until -n opens have been
+ * made, and each open is checked to have found the right device. Names
+ * that match nothing must fail with ENODEV.
+ *
+ * Then the time for an open and close is taken again with every other 
+ * descriptor held open, and the file descriptor pool is checked: the 
+ * lowest free descriptor must be given out, open() must fail with EMFILE
+ * once ALT_MAX_FD are in use, and a device locked for exclusive access 
+ * with alt_fd_lock() must refuse other opens until it is unlocked or the
+ * descriptor holding it is closed.
+ *
+ * Last, nested mount points are registered: "/mnt" and then "/mnt/sd", and
+ * "/nest/sd/" and then "/nest". Where a file is under both, the one 
+ * registered last must own it.
+ *
+ * The HAL's open() and close() are built as hal_open() and hal_close(), so
+ * as not to replace the host's.
+ *
+ * Usage:
+ *   open_bench [-n opens] [-d devices] [-f filesystems]
+ *
+ * Build with "make open_bench" in this directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "sys/alt_dev.h"
+#include "priv/alt_file.h"
+
+#define MAX_DEVS 1024
+#define MAX_FS   64
+#define NAME_LEN 24
+
+extern alt_dev alt_dev_null;
+
+static alt_dev devs[MAX_DEVS];
+static alt_dev fss[MAX_FS];
+static char    dev_names[MAX_DEVS][NAME_LEN];
+static char    fs_names[MAX_FS][NAME_LEN];
+
+static unsigned long errors;
+
+static unsigned long long now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/* Open "name", check that it finds "dev" (or nothing), and close it again */
+static void try_open (const char* name, alt_dev* dev)
+{
+  int fd = open (name, O_RDWR, 0);
+
+  if (dev == NULL)
+  {
+    if (fd >= 0 || errno != ENODEV)
+    {
+      printf ("  %s: opened, but there is no such device\n", name);
+      errors++;
+    }
+    if (fd >= 0)
+      close (fd);
+    return;
+  }
+
+  if (fd < 0)
+  {
+    printf ("  %s: open failed: %s\n", name, strerror (errno));
+    errors++;
+    return;
+  }
+
+  if (alt_fd_list[fd].dev != dev)
+  {
+    printf ("  %s: found %s\n", name, alt_fd_list[fd].dev->name);
+    errors++;
+  }
+
+  if (close (fd) != 0)
+  {
+    printf ("  %s: close failed: %s\n", name, strerror (errno));
+    errors++;
+  }
+}
+
+static void check (int ok, const char* what)
+{
+  if (!ok)
+  {
+    printf ("  %s: failed\n", what);
+    errors++;
+  }
+}
+
+/* Time opens and closes of devs[0] with "held" descriptors open on devs[1] */
+static void held_bench (int held, unsigned long n)
+{
+  int                fds[ALT_MAX_FD];
+  unsigned long      opens;
+  unsigned long long start;
+  int                i;
+
+  for (i = 0; i < held; i++)
+    fds[i] = open (dev_names[1], O_RDWR, 0);
+
+  start = now_ns ();
+  for (opens = 0; opens < n; opens++)
+    try_open (dev_names[0], &devs[0]);
+
+  printf ("%4d descriptors held open:    %6.1f ns an open and close\n", 
+          held, (double) (now_ns () - start) / n);
+
+  for (i = 0; i < held; i++)
+    check (close (fds[i]) == 0, "close held descriptor");
+}
+
+/* The file descriptor pool and exclusive access */
+static void fd_check (void)
+{
+  int fds[ALT_MAX_FD];
+  int a, b, i;
+
+  for (i = 0; (fds[i] = open (dev_names[1], O_RDWR, 0)) >= 0; i++)
+    check (fds[i] == i + 3, "lowest free descriptor");
+  check (i == ALT_MAX_FD - 3 && errno == EMFILE, "EMFILE when all in use");
+
+  check (close (fds[7]) == 0 && close (fds[2]) == 0, "close");
+  check (open (dev_names[1], O_RDWR, 0) == 5, "reuse lowest free");
+  check (open (dev_names[1], O_RDWR, 0) == 10, "reuse next free");
+  for (i = 0; i < ALT_MAX_FD - 3; i++)
+    close (fds[i]);
+
+  a = open (dev_names[0], O_RDWR, 0);
+  b = open (dev_names[0], O_RDWR, 0);
+  check (alt_fd_lock (&alt_fd_list[a]) == -EACCES, "lock refused while shared");
+  close (b);
+  check (alt_fd_lock (&alt_fd_list[a]) == 0, "lock");
+  check (open (dev_names[0], O_RDWR, 0) < 0 && errno == EACCES, 
+         "open of a locked device");
+  try_open (dev_names[1], &devs[1]);
+  alt_fd_unlock (&alt_fd_list[a]);
+  try_open (dev_names[0], &devs[0]);
+  check (alt_fd_lock (&alt_fd_list[a]) == 0, "lock again");
+  close (a);
+  try_open (dev_names[0], &devs[0]);
+}
+
+/* Nested mount points: the filesystem registered last takes precedence */
+static void nest_check (void)
+{
+  static alt_dev nest[4] = {
+    { .name = "/mnt" }, { .name = "/mnt/sd" },
+    { .name = "/nest/sd/" }, { .name = "/nest" } };
+  int i;
+
+  for (i = 0; i < 4; i++)
+    check (alt_fs_reg (&nest[i]) == 0, "alt_fs_reg() of a nested mount");
+
+  try_open ("/mnt/sd/data.txt", &nest[1]);
+  try_open ("/mnt/sd", &nest[1]);
+  try_open ("/mnt/data.txt", &nest[0]);
+  try_open ("/mnt/fs0/data.txt", &nest[0]);
+  try_open ("/mnt/sdx/data.txt", &nest[0]);
+  try_open ("/nest/sd/data.txt", &nest[3]);
+  try_open ("/nest/data.txt", &nest[3]);
+}
+
+int main (int argc, char** argv)
+{
+  unsigned long      n     = 200000;
+  int                ndevs = 256;
+  int                nfs   = 4;
+  int                have  = 0;
+  int                step, c, i;
+  unsigned long      opens;
+  unsigned long long start;
+  char               file[NAME_LEN + 16];
+  char               miss[NAME_LEN + 16];
+
+  while ((c = getopt (argc, argv, "n:d:f:")) != -1)
+  {
+    switch (c)
+    {
+    case 'n': n     = strtoul (optarg, NULL, 0); break;
+    case 'd': ndevs = atoi (optarg); break;
+    case 'f': nfs   = atoi (optarg); break;
+    default:
+      fprintf (stderr, "usage: %s [-n opens] [-d devices] [-f filesystems]\n",
+               argv[0]);
+      return 2;
+    }
+  }
+
+  if (n < 1 || ndevs < 2 || ndevs > MAX_DEVS || nfs < 1 || nfs > MAX_FS)
+  {
+    fprintf (stderr, "%s: bad arguments\n", argv[0]);
+    return 2;
+  }
+
+  for (i = 0; i < nfs; i++)
+  {
+    snprintf (fs_names[i], NAME_LEN, i & 1 ? "/mnt/fs%d/" : "/mnt/fs%d", i);
+    fss[i].name = fs_names[i];
+    if (alt_fs_reg (&fss[i]) != 0)
+    {
+      fprintf (stderr, "%s: alt_fs_reg() failed\n", argv[0]);
+      return 1;
+    }
+  }
+
+  for (step = 1; ; step = step * 4 < ndevs ? step * 4 : ndevs)
+  {
+    for (; have < step; have++)
+    {
+      snprintf (dev_names[have], NAME_LEN, "/dev/dev%d", have);
+      devs[have].name = dev_names[have];
+      if (alt_dev_reg (&devs[have]) != 0)
+      {
+        fprintf (stderr, "%s: alt_dev_reg() failed\n", argv[0]);
+        return 1;
+      }
+    }
+
+    try_open ("/dev/null", &alt_dev_null);
+    try_open ("/dev/dev", NULL);
+    try_open ("/dev/dev0x", NULL);
+    try_open ("/mnt/fs", NULL);
+
+    start = now_ns ();
+    for (opens = 0; opens < n; )
+    {
+      try_open (dev_names[0], &devs[0]);
+      try_open (dev_names[have - 1], &devs[have - 1]);
+      opens += 2;
+
+      for (i = 0; i < nfs && opens < n; i++, opens += 2)
+      {
+        snprintf (file, sizeof (file), "/mnt/fs%d/data.txt", i);
+        try_open (file, &fss[i]);
+        try_open (fs_names[i], &fss[i]);
+      }
+    }
+
+    snprintf (miss, sizeof (miss), "/mnt/fs%dx/data.txt", nfs - 1);
+    try_open (miss, NULL);
+
+    printf ("%4d devices, %2d filesystems: %6.1f ns an open and close\n", 
+            have, nfs, (double) (now_ns () - start) / opens);
+
+    if (have == ndevs)
+      break;
+  }
+
+  held_bench (0, n);
+  held_bench (ALT_MAX_FD - 4, n);
+  fd_check ();
+  nest_check ();
+
+  printf ("%lu errors\n", errors);
+
+  return errors != 0;
+}
@@ -0,0 +1,239 @@
+/*
+ * out_bench.c - check the calculator's output stage (calc_out.c) and the
+ * object pool (sys/alt_pool.h) whose buffers it queues.
+ *
+ * calc_out's write() and ioctl() go to a simulated JTAG UART driver, whose
+ * ring the host side drains by hand. out_bench models the fast driver,
+ * with a 2 Kbyte ring and TIOCOUTQ; out_bench -s the small one, which
+ * only has the 64 byte hardware FIFO and no ioctl() support. For each of
+ * -n rounds:
+ *
+ *   steady  results printed twice each while the host keeps up
+ *   stalled the host stops draining while more results are printed, so
+ *           they must be deferred, and stale ones dropped
+ *   drained the host catches up, and the summary of what it missed must
+ *           follow
+ *
+ * Every line the host receives must be whole, and results must arrive in
+ * the order printed. Buffers must all be back in the pool at the end of a
+ * round but the one kept for the next line, and the pool must never have
+ * run out. Finally the pool itself is checked: its limit, counts and
+ * free list order.
+ *
+ * calc_out's write() and ioctl() are built as out_write() and out_ioctl().
+ *
+ * Usage:
+ *   out_bench [-s] [-n rounds]
+ *
+ * Build with "make out_bench" in this directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "sys/ioctl.h"
+#include "calc_out.h"
+
+#define RING_LEN 2048
+#define FIFO_LEN 64
+#define RECV_LEN 256
+
+static int           small;
+static int           ring_len = RING_LEN;
+static char          ring[RING_LEN];
+static int           ring_fill;
+
+/* The host's side: a partial line, and what it has made of the lines */
+static char          recv[RECV_LEN];
+static int           recv_len;
+static int           last_result = -1;
+static unsigned long results;
+static unsigned long summaries;
+static unsigned long repeats;
+static unsigned long errors;
+
+ssize_t out_write (int fd, const void* buf, size_t len)
+{
+  if (len > (size_t) (ring_len - ring_fill))
+    len = ring_len - ring_fill;
+  if (len == 0)
+  {
+    errno = EWOULDBLOCK;
+    return -1;
+  }
+  memcpy (ring + ring_fill, buf, len);
+  ring_fill += len;
+  return len;
+}
+
+int out_ioctl (int fd, int req, void* arg)
+{
+  if (small || req != TIOCOUTQ)
+  {
+    errno = ENOTTY;
+    return -1;
+  }
+  *(int*) arg = ring_fill;
+  return 0;
+}
+
+static void host_line (const char* line)
+{
+  int value;
+
+  if (sscanf (line, "Result: %d\n", &value) == 1)
+  {
+    if (value <= last_result)
+    {
+      printf ("result %d after %d\n", value, last_result);
+      errors++;
+    }
+    last_result = value;
+    results++;
+  }
+  else if (strncmp (line, "(last line repeated ", 20) == 0)
+    repeats++;
+  else if (strncmp (line, "[output: ", 9) == 0)
+    summaries++;
+  else
+  {
+    printf ("bad line: %s", line);
+    errors++;
+  }
+}
+
+/* The host takes up to n bytes from the ring */
+static void host_drain (int n)
+{
+  int i;
+
+  if (n > ring_fill)
+    n = ring_fill;
+
+  for (i = 0; i < n; i++)
+  {
+    if (recv_len < RECV_LEN - 1)
+      recv[recv_len++] = ring[i];
+    if (ring[i] == '\n')
+    {
+      recv[recv_len] = '\0';
+      host_line (recv);
+      recv_len = 0;
+    }
+  }
+
+  ring_fill -= n;
+  memmove (ring, ring + n, ring_fill);
+}
+
+static void check (int ok, const char* what)
+{
+  if (!ok)
+  {
+    printf ("failed: %s\n", what);
+    errors++;
+  }
+}
+
+static void pool_check (void)
+{
+  calc_line* lines[CALC_OUT_LINES + 1];
+  calc_line* first;
+  alt_u32    used = calc_line_pool.used;
+  alt_u32    failures = calc_line_pool.failures;
+  int        i;
+
+  for (i = 0; i < CALC_OUT_LINES + 1; i++)
+    lines[i] = calc_line_pool_alloc ();
+
+  for (i = 0; i < CALC_OUT_LINES - (int) used; i++)
+    check (lines[i] != NULL, "pool allocation");
+  check (lines[i] == NULL, "pool allocation past the limit fails");
+  check (calc_line_pool.failures > failures, "pool failures counted");
+  check (calc_line_pool.used == CALC_OUT_LINES, "pool in use counted");
+  check (calc_line_pool.peak == CALC_OUT_LINES, "pool peak counted");
+
+  first = lines[0];
+  calc_line_pool_free (lines[1]);
+  calc_line_pool_free (lines[0]);
+  check (calc_line_pool_alloc () == first, "pool reuses the last object freed");
+  calc_line_pool_free (first);
+
+  alt_pool_reset_peak (&calc_line_pool);
+  check (calc_line_pool.peak == calc_line_pool.used, "pool peak reset");
+
+  for (i = 2; i < CALC_OUT_LINES + 1; i++)
+    calc_line_pool_free (lines[i]);
+  check (calc_line_pool.used == used, "pool objects all returned");
+}
+
+int main (int argc, char** argv)
+{
+  calc_out           out;
+  int                rounds = 100;
+  int                value = 0;
+  int                c, i, r;
+  unsigned long long start;
+  double             ns;
+
+  while ((c = getopt (argc, argv, "sn:")) != -1)
+  {
+    switch (c)
+    {
+    case 's': small  = 1; break;
+    case 'n': rounds = atoi (optarg); break;
+    default:
+      fprintf (stderr, "usage: %s [-s] [-n rounds]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  if (small)
+    ring_len = FIFO_LEN;
+
+  calc_out_init (&out, 1, CALC_OUT_TX_LIMIT);
+
+  start = hal_sim_now_ns ();
+  for (r = 0; r < rounds; r++)
+  {
+    for (i = 0; i < 64; i++, value++)
+    {
+      calc_out_printf (&out, "Result: %d\n", value);
+      calc_out_printf (&out, "Result: %d\n", value);
+      host_drain (32);
+    }
+
+    for (i = 0; i < 512; i++, value++)
+      calc_out_printf (&out, "Result: %d\n", value);
+
+    for (i = 0; i < 16 && (out.head || ring_fill); i++)
+    {
+      host_drain (ring_len);
+      calc_out_flush (&out);
+    }
+    check (out.head == NULL && ring_fill == 0, "output drained");
+    check (calc_line_pool.used == (out.spare != NULL), "line buffers returned");
+  }
+  ns = (double) (hal_sim_now_ns () - start) / (rounds * 640);
+
+  printf ("%s driver: %lu results, %lu repeat notes, %lu summaries received; "
+          "%lu suppressed, %lu dropped, %lu deferred; %.1f ns per line\n",
+          small ? "small" : "fast", results, repeats, summaries,
+          out.suppressed, out.dropped, out.deferred, ns);
+  printf ("calc_line_pool: peak %lu of %d, %lu failures\n",
+          (unsigned long) calc_line_pool.peak, CALC_OUT_LINES,
+          (unsigned long) calc_line_pool.failures);
+
+  check (summaries == (unsigned long) rounds, "a summary after each stall");
+  check (out.dropped > 0, "stale lines dropped");
+  check (small || out.deferred > 0, "writes deferred");
+  check (calc_line_pool.failures == 0, "line pool big enough");
+
+  pool_check ();
+
+  printf ("%lu errors\n", errors);
+  return errors != 0;
+}
@@ -0,0 +1,204 @@
+/*
+ * spcache_bench.c - hit rates of scratchpad caches (sys/alt_spcache.h) of
+ * different shapes over the same table, and the cycles each would save.
+ *
+ * The table is a 2 Kbyte font of 256 eight byte glyphs, as an LCD or VGA
+ * text driver would keep in SDRAM. Four caches of 512 bytes each are
+ * defined over it: direct-mapped and 2-way, with 32 and 8 byte blocks. 
+ * Every lookup goes to all four, reads the whole glyph through each and
+ * checks it against the table.
+ *
+ * Two streams of -n characters are looked up: "text", in which most are
+ * drawn from a few digits and symbols and most of the rest from the 
+ * letters, as a calculator's output would be; and "random", uniform over
+ * all 256, for which no cache smaller than the table does well. Halfway
+ * through each, one glyph is changed and the caches invalidated.
+ *
+ * The cycles saved are alt_spcache_saved()'s estimates, with its default
+ * costs, for two uses of each glyph looked up: copying it, two word reads,
+ * and drawing it pixel by pixel into an 8 bit frame buffer, which reads 
+ * its row byte again for each of the 64 pixels since a store through an 
+ * unsigned char pointer may have changed it. Copying never pays for the 
+ * lookup; drawing does. The number of reads a lookup would have to be 
+ * followed by to break even is given too.
+ *
+ * Usage:
+ *   spcache_bench [-n lookups]
+ *
+ * Build with "make spcache_bench" in this directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "sys/alt_spcache.h"
+
+typedef struct glyph_s
+{
+  unsigned char row[8];
+} glyph;
+
+static glyph font[256];
+
+ALT_SPCACHE_DEFINE (direct32, font, 32, 16, 1);
+ALT_SPCACHE_DEFINE (assoc32, font, 32, 8, 2);
+ALT_SPCACHE_DEFINE (direct8, font, 8, 64, 1);
+ALT_SPCACHE_DEFINE (assoc8, font, 8, 32, 2);
+
+/* Each cache can only be read through its own lookup */
+
+static glyph read_direct32 (unsigned int c)
+{
+  return ALT_SPCACHE_READ (direct32, glyph, &font[c]);
+}
+
+static glyph read_assoc32 (unsigned int c)
+{
+  return ALT_SPCACHE_READ (assoc32, glyph, &font[c]);
+}
+
+static glyph read_direct8 (unsigned int c)
+{
+  return ALT_SPCACHE_READ (direct8, glyph, &font[c]);
+}
+
+static glyph read_assoc8 (unsigned int c)
+{
+  return ALT_SPCACHE_READ (assoc8, glyph, &font[c]);
+}
+
+static struct
+{
+  const char*  name;
+  alt_spcache* cache;
+  glyph        (*read) (unsigned int c);
+} caches[] =
+{
+  { "direct-mapped, 16 x 32 bytes ", &direct32, read_direct32 },
+  { "2-way,  8 sets x 2 x 32 bytes", &assoc32,  read_assoc32 },
+  { "direct-mapped, 64 x 8 bytes  ", &direct8,  read_direct8 },
+  { "2-way, 32 sets x 2 x 8 bytes ", &assoc8,   read_assoc8 },
+};
+
+/* Reads per lookup: copying a glyph, and drawing it pixel by pixel */
+
+#define COPY_READS 2
+#define DRAW_READS 64
+
+#define NCACHES (sizeof (caches) / sizeof (caches[0]))
+
+static const char hot[] = "0123456789.-+e ";
+
+static unsigned int seed = 1;
+
+/* Deterministic, so that runs can be compared */
+static unsigned int bench_rand (unsigned int max)
+{
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 8) % max;
+}
+
+static unsigned int next_text (void)
+{
+  unsigned int r = bench_rand (100);
+
+  if (r < 70)
+    return hot[bench_rand (sizeof (hot) - 1)];
+  if (r < 95)
+    return 'A' + bench_rand (58);
+  return bench_rand (256);
+}
+
+static unsigned int next_random (void)
+{
+  return bench_rand (256);
+}
+
+static unsigned long run (const char* stream, unsigned int (*next) (void),
+                          unsigned long n)
+{
+  unsigned long errors = 0;
+  unsigned long i;
+  unsigned int  c, k;
+  glyph         g;
+
+  for (k = 0; k < NCACHES; k++)
+  {
+    alt_spcache_invalidate (caches[k].cache);
+    caches[k].cache->hits   = 0;
+    caches[k].cache->misses = 0;
+  }
+
+  for (i = 0; i < n; i++)
+  {
+    /* A read-mostly table: changed once, and the caches told */
+    if (i == n / 2)
+    {
+      font['0'].row[3] ^= 0xff;
+      for (k = 0; k < NCACHES; k++)
+        alt_spcache_invalidate (caches[k].cache);
+    }
+
+    c = next ();
+    for (k = 0; k < NCACHES; k++)
+    {
+      g = caches[k].read (c);
+      if (memcmp (&g, &font[c], sizeof (g)) != 0)
+        errors++;
+    }
+  }
+
+  printf ("%s: %lu lookups\n", stream, n);
+  for (k = 0; k < NCACHES; k++)
+  {
+    alt_spcache* cache = caches[k].cache;
+    double       base  = alt_spcache_saved (cache, 0);
+    double       word  = alt_spcache_saved (cache, 1) - base;
+
+    printf ("  %s: hits %5.1f%%, cycles saved a lookup: %.1f copying, "
+            "%.1f drawing; break-even at %.1f reads\n", caches[k].name, 
+            100.0 * cache->hits / n,
+            (double) alt_spcache_saved (cache, COPY_READS) / n,
+            (double) alt_spcache_saved (cache, DRAW_READS) / n,
+            -base / word);
+  }
+
+  return errors;
+}
+
+int main (int argc, char** argv)
+{
+  unsigned long n = 100000;
+  unsigned long errors;
+  int           c, i;
+
+  while ((c = getopt (argc, argv, "n:")) != -1)
+  {
+    switch (c)
+    {
+    case 'n': n = strtoul (optarg, NULL, 0); break;
+    default:
+      fprintf (stderr, "usage: %s [-n lookups]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  if (n < 2)
+  {
+    fprintf (stderr, "%s: bad arguments\n", argv[0]);
+    return 2;
+  }
+
+  for (c = 0; c < 256; c++)
+    for (i = 0; i < 8; i++)
+      font[c].row[i] = c * 8 + i;
+
+  errors  = run ("text", next_text, n);
+  errors += run ("random", next_random, n);
+
+  printf ("%lu errors\n", errors);
+
+  return errors != 0;
+}
@@ -0,0 +1,431 @@
+/*
+ * timer_sim.c - run the interval timer driver on the host against a model
+ * of the altera_avalon_timer register block.
+ *
+ * The model counts down once per simulated cycle from the period registers
+ * to zero, then reloads, sets TO and (with ITO set) drives its interrupt
+ * line through hal_sim; it stops and reloads when the period is written,
+ * and latches the counter into the snapshot registers when either of them
+ * is written, as the hardware does.
+ *
+ * The system has no timer yet, so two are added here: SYS_CLK_TIMER as the
+ * system clock and TIMESTAMP_TIMER as the timestamp clock. By default the
+ * system clock timer also provides the timestamps; -s uses the separate
+ * one instead.
+ *
+ * -n periodic alarms with random periods of 1 to -p ticks run for -t ticks.
+ * Each callback checks that it runs on the tick it was due, and compares
+ * alt_timestamp() and the monotonic clock (alt_clock_ns() and 
+ * alt_clock_gettime()) with the number of simulated cycles. Meanwhile the main
+ * thread reads alt_timestamp() in a loop, checking that it never goes
+ * backwards, and keeps a one-shot alarm of its own running so that alarms
+ * are also started outside the interrupt handler. One more alarm is 
+ * started 0xffffffff ticks away, the longest alt_alarm_start() allows; if
+ * it runs at all it is late.
+ *
+ * timer_sim_tickless is built with ALT_TICKLESS, where the driver
+ * reprograms the system clock timer for each deadline. Both builds report
+ * how many interrupts the system clock timer raised. As with jtag_uart_sim,
+ * run this on a host with at least two cores; on one, the main thread only
+ * gets to run between long stretches of simulated time.
+ *
+ * -u measures alt_busy_sleep() (usleep) instead. Each delay is made first
+ * with the calibrated loop, whose length is counted in CPU cycles at
+ * ALT_CPU_FREQ, and then timed by the timestamp timer. For the latter the
+ * main thread drives the simulated clock itself (hal_sim_lockstep()), one
+ * timer cycle per register access, so that the result does not depend on
+ * how the host schedules threads. A delay shorter than requested is an
+ * error.
+ *
+ * Usage:
+ *   timer_sim [-n alarms] [-t ticks] [-p period] [-s] [-u]
+ *
+ * Build with "make timer_sim timer_sim_tickless" in this directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "system.h"
+#include "sys/alt_irq.h"
+#include "sys/alt_alarm.h"
+#include "sys/alt_timestamp.h"
+#include "sys/alt_clock.h"
+#include "priv/alt_busy_sleep.h"
+#include "altera_avalon_timer.h"
+#include "altera_avalon_timer_regs.h"
+
+/* What system.h would hold if the timers were part of the system */
+
+#define SYS_CLK_TIMER_BASE                        0x1012000
+#define SYS_CLK_TIMER_IRQ                         1
+#define SYS_CLK_TIMER_IRQ_INTERRUPT_CONTROLLER_ID 0
+#define SYS_CLK_TIMER_FREQ                        1000000u
+#define SYS_CLK_TIMER_TICKS_PER_SEC               1000u
+
+#define TIMESTAMP_TIMER_BASE                        0x1012020
+#define TIMESTAMP_TIMER_IRQ                         2
+#define TIMESTAMP_TIMER_IRQ_INTERRUPT_CONTROLLER_ID 0
+#define TIMESTAMP_TIMER_FREQ                        1000000u
+#define TIMESTAMP_TIMER_TICKS_PER_SEC               1000u
+
+#undef  ALT_SYS_CLK
+#define ALT_SYS_CLK SYS_CLK_TIMER
+#undef  ALT_TIMESTAMP_CLK
+#define ALT_TIMESTAMP_CLK TIMESTAMP_TIMER
+
+#define CYCLES_PER_TICK (SYS_CLK_TIMER_FREQ / SYS_CLK_TIMER_TICKS_PER_SEC)
+
+/* ----------------------------------------------------------------------- */
+/* -------------------------------- MODEL -------------------------------- */
+
+typedef struct timer_model_s
+{
+  hal_sim_dev     dev;
+  pthread_mutex_t lock;
+  int             irq;
+
+  unsigned int    period;
+  unsigned int    counter;
+  unsigned int    snap;
+  unsigned int    control;     /* ITO and CONT */
+  int             running;
+  int             to;
+  unsigned long   timeouts;
+} timer_model;
+
+static void model_update_irq (timer_model* m)
+{
+  hal_sim_irq (m->irq, m->to && (m->control & ALTERA_AVALON_TIMER_CONTROL_ITO_MSK));
+}
+
+static unsigned int model_read (hal_sim_dev* dev, int reg)
+{
+  timer_model* m = dev->context;
+  unsigned int data = 0;
+
+  pthread_mutex_lock (&m->lock);
+
+  switch (reg)
+  {
+  case ALTERA_AVALON_TIMER_STATUS_REG:
+    data = (m->to      ? ALTERA_AVALON_TIMER_STATUS_TO_MSK  : 0) |
+           (m->running ? ALTERA_AVALON_TIMER_STATUS_RUN_MSK : 0);
+    break;
+  case ALTERA_AVALON_TIMER_CONTROL_REG: data = m->control; break;
+  case ALTERA_AVALON_TIMER_PERIODL_REG: data = m->period & 0xffff; break;
+  case ALTERA_AVALON_TIMER_PERIODH_REG: data = m->period >> 16; break;
+  case ALTERA_AVALON_TIMER_SNAPL_REG:   data = m->snap & 0xffff; break;
+  case ALTERA_AVALON_TIMER_SNAPH_REG:   data = m->snap >> 16; break;
+  }
+
+  pthread_mutex_unlock (&m->lock);
+  return data;
+}
+
+static void model_write (hal_sim_dev* dev, int reg, unsigned int data)
+{
+  timer_model* m = dev->context;
+
+  pthread_mutex_lock (&m->lock);
+
+  switch (reg)
+  {
+  case ALTERA_AVALON_TIMER_STATUS_REG:
+    m->to = 0;
+    break;
+  case ALTERA_AVALON_TIMER_CONTROL_REG:
+    m->control = data & (ALTERA_AVALON_TIMER_CONTROL_ITO_MSK |
+                         ALTERA_AVALON_TIMER_CONTROL_CONT_MSK);
+    if (data & ALTERA_AVALON_TIMER_CONTROL_START_MSK)
+      m->running = 1;
+    if (data & ALTERA_AVALON_TIMER_CONTROL_STOP_MSK)
+      m->running = 0;
+    break;
+  case ALTERA_AVALON_TIMER_PERIODL_REG:
+  case ALTERA_AVALON_TIMER_PERIODH_REG:
+    if (reg == ALTERA_AVALON_TIMER_PERIODL_REG)
+      m->period = (m->period & 0xffff0000) | (data & 0xffff);
+    else
+      m->period = (m->period & 0xffff) | ((data & 0xffff) << 16);
+    m->counter = m->period;
+    m->running = 0;
+    break;
+  case ALTERA_AVALON_TIMER_SNAPL_REG:
+  case ALTERA_AVALON_TIMER_SNAPH_REG:
+    m->snap = m->counter;
+    break;
+  }
+
+  model_update_irq (m);
+  pthread_mutex_unlock (&m->lock);
+}
+
+static void model_step (hal_sim_dev* dev)
+{
+  timer_model* m = dev->context;
+
+  pthread_mutex_lock (&m->lock);
+
+  if (m->running)
+  {
+    if (m->counter == 0)
+    {
+      m->counter = m->period;
+      m->to      = 1;
+      m->timeouts++;
+      if (!(m->control & ALTERA_AVALON_TIMER_CONTROL_CONT_MSK))
+        m->running = 0;
+      model_update_irq (m);
+    }
+    else
+      m->counter--;
+  }
+
+  pthread_mutex_unlock (&m->lock);
+}
+
+static void model_map (timer_model* m, unsigned long base, int irq)
+{
+  pthread_mutex_init (&m->lock, NULL);
+  m->irq         = irq;
+  m->dev.base    = base;
+  m->dev.span    = 32;
+  m->dev.read    = model_read;
+  m->dev.write   = model_write;
+  m->dev.step    = model_step;
+  m->dev.context = m;
+  hal_sim_map (&m->dev);
+}
+
+static timer_model sys_clk_model;
+static timer_model timestamp_model;
+
+/* ----------------------------------------------------------------------- */
+/* --------------------------------- TEST -------------------------------- */
+
+typedef struct sim_alarm_s
+{
+  alt_alarm alarm;
+  alt_u32   period;
+  alt_u64   due;
+} sim_alarm;
+
+static sim_alarm*    alarms;
+static unsigned long callbacks;
+static unsigned long late;
+static long long     drift;   /* largest difference from the simulated cycle count */
+static unsigned long clock_errors;
+
+static unsigned int seed = 1;
+
+/* Deterministic, so that runs can be compared */
+static alt_u32 sim_rand (alt_u32 max)
+{
+  seed = seed * 1103515245 + 12345;
+  return 1 + (seed >> 8) % max;
+}
+
+/* Called in the clock thread, which is not stepping the model meanwhile */
+static void check_timestamp (void)
+{
+  alt_timespec ts;
+  long long diff = (long long) (hal_sim_cycles () - alt_timestamp ());
+
+  if (diff < 0)
+    diff = -diff;
+  if (diff > drift)
+    drift = diff;
+
+  /* One timer cycle is exactly 1000 ns */
+
+  if (alt_clock_gettime (&ts) != 0 ||
+      (alt_u64) ts.tv_sec * 1000000000 + ts.tv_nsec != hal_sim_cycles () * 1000 ||
+      alt_clock_ns () != hal_sim_cycles () * 1000)
+  {
+    clock_errors++;
+  }
+}
+
+static alt_u32 sim_callback (void* context)
+{
+  sim_alarm* a = context;
+
+  callbacks++;
+  if (alt_nticks64 () != a->due)
+    late++;
+  check_timestamp ();
+
+  a->due += a->period;
+  return a->period;
+}
+
+static const unsigned int sleeps[] = { 1, 10, 100, 1000, 4100, 15000, 100000 };
+
+#define NSLEEPS (sizeof (sleeps) / sizeof (sleeps[0]))
+
+/* Print the requested and actual delay, and return 1 if it was short */
+static int report_sleep (const char* how, unsigned int us, double actual)
+{
+  printf ("%s: %6u us requested, %10.2f us (%+.2f%%)\n", how, us, actual,
+          100.0 * (actual - us) / us);
+  return actual < us;
+}
+
+static sim_alarm      oneshot;
+static volatile int   oneshot_done;
+static sim_alarm      far;
+
+static alt_u32 oneshot_callback (void* context)
+{
+  sim_callback (context);
+  oneshot_done = 1;
+  return 0;
+}
+
+int main (int argc, char** argv)
+{
+  int           n        = 64;
+  unsigned long ticks    = 10000;
+  alt_u32       period   = 100;
+  int           separate = 0;
+  int           sleep    = 0;
+  int           short_sleeps = 0;
+  unsigned long long start;
+  unsigned long reads    = 0;
+  unsigned long backwards = 0;
+  unsigned long oneshots = 0;
+  alt_u64       now, last = 0;
+  alt_u32       delay;
+  alt_irq_context context;
+  int           c, i;
+
+  while ((c = getopt (argc, argv, "n:t:p:su")) != -1)
+  {
+    switch (c)
+    {
+    case 'n': n        = atoi (optarg); break;
+    case 't': ticks    = atol (optarg); break;
+    case 'p': period   = atol (optarg); break;
+    case 's': separate = 1; break;
+    case 'u': sleep    = 1; break;
+    default:
+      fprintf (stderr, "usage: %s [-n alarms] [-t ticks] [-p period] [-s] [-u]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  if (n < 0 || ticks < 1 || period < 1)
+  {
+    fprintf (stderr, "%s: bad arguments\n", argv[0]);
+    return 2;
+  }
+
+  alarms = calloc (n ? n : 1, sizeof (*alarms));
+  if (!alarms)
+  {
+    perror ("calloc");
+    return 1;
+  }
+
+  /* Before alt_sys_init() there is no timestamp, so the loop is used */
+
+  if (sleep)
+  {
+    for (i = 0; i < NSLEEPS; i++)
+    {
+      hal_sim_loop_cycles = 0;
+      alt_busy_sleep (sleeps[i]);
+      short_sleeps += report_sleep ("loop ", sleeps[i],
+                                    hal_sim_loop_cycles / (ALT_CPU_FREQ / 1e6));
+    }
+  }
+
+  /* alt_sys_init(), before the clock starts so that cycle 0 is tick 0 */
+
+  model_map (&sys_clk_model, SYS_CLK_TIMER_BASE, SYS_CLK_TIMER_IRQ);
+  ALTERA_AVALON_TIMER_INIT (SYS_CLK_TIMER, sys_clk_timer);
+
+  if (separate)
+  {
+    model_map (&timestamp_model, TIMESTAMP_TIMER_BASE, TIMESTAMP_TIMER_IRQ);
+    ALTERA_AVALON_TIMER_INIT (TIMESTAMP_TIMER, timestamp_timer);
+  }
+  else
+    alt_avalon_timer_ts_init ((void*) SYS_CLK_TIMER_BASE,
+                              SYS_CLK_TIMER_IRQ_INTERRUPT_CONTROLLER_ID,
+                              SYS_CLK_TIMER_IRQ, SYS_CLK_TIMER_FREQ);
+
+  if (alt_ticks_per_second () != SYS_CLK_TIMER_TICKS_PER_SEC ||
+      alt_timestamp_freq () != SYS_CLK_TIMER_FREQ ||
+      alt_timestamp_start () < 0)
+  {
+    fprintf (stderr, "%s: timer driver did not start\n", argv[0]);
+    return 1;
+  }
+
+  if (sleep)
+  {
+    hal_sim_lockstep (1);
+
+    for (i = 0; i < NSLEEPS; i++)
+    {
+      start = hal_sim_cycles ();
+      alt_busy_sleep (sleeps[i]);
+      short_sleeps += report_sleep ("timer", sleeps[i], (hal_sim_cycles () - start) /
+                                    (SYS_CLK_TIMER_FREQ / 1e6));
+    }
+
+    free (alarms);
+    return short_sleeps != 0;
+  }
+
+  for (i = 0; i < n; i++)
+  {
+    alarms[i].period = sim_rand (period);
+    alarms[i].due    = alarms[i].period + 1;
+    alt_alarm_start (&alarms[i].alarm, alarms[i].period, sim_callback, &alarms[i]);
+  }
+  far.period = 0xffffffff;
+  far.due    = (alt_u64) far.period + 1;
+  alt_alarm_start (&far.alarm, far.period, sim_callback, &far);
+  oneshot_done = 1;
+
+  hal_sim_start (0, 0);
+
+  while ((now = alt_timestamp ()) < (alt_u64) ticks * CYCLES_PER_TICK)
+  {
+    reads++;
+    if (now < last)
+      backwards++;
+    last = now;
+
+    if (oneshot_done)
+    {
+      delay = sim_rand (period);
+
+      context = alt_irq_disable_all ();
+      oneshot.period = 0;
+      oneshot.due    = alt_nticks64 () + delay + 1;
+      oneshot_done   = 0;
+      alt_alarm_start (&oneshot.alarm, delay, oneshot_callback, &oneshot);
+      alt_irq_enable_all (context);
+
+      oneshots++;
+    }
+  }
+
+  hal_sim_stop ();
+
+  printf ("%s: %lu ticks, %llu cycles, %lu interrupts, %lu callbacks (%lu one-shot), "
+          "%lu late\n", separate ? "separate" : "shared", ticks, hal_sim_cycles (),
+          sys_clk_model.timeouts, callbacks, oneshots, late);
+  printf ("%s: %lu timestamp reads, %lu backwards, timestamps up to %lld cycles "
+          "from the simulated count, %lu clock errors\n", 
+          separate ? "separate" : "shared", reads, backwards, drift, clock_errors);
+
+  free (alarms);
+  return late != 0 || backwards != 0 || clock_errors != 0;
+}
@@ -0,0 +1,28 @@
+/*
+ * overlays.x - the calculator's code overlays (see sys/alt_overlay.h)
+ *
+ * Read after the main linker script. Every overlay is linked to run at the
+ * start of the overlay window, which follows the .onchip_mem partition in
+ * onchip_mem and is as big as the biggest overlay. The overlays' images
+ * follow the .onchip_mem partition's image at the end of SDRAM's contents,
+ * and the heap is moved up past them so they are kept.
+ *
+ * To add an overlay "name", give it a section here, and add it to the sums
+ * of sizes for __alt_overlay_end and __alt_heap_start.
+ */
+
+SECTIONS
+{
+    OVERLAY : AT ( end + SIZEOF (.onchip_mem) )
+    {
+        .overlay.calc_diag
+        {
+            __alt_overlay_start = ABSOLUTE(.);
+            *(.overlay.calc_diag)
+        }
+    } > onchip_mem
+
+    __alt_overlay_end = __alt_overlay_start + SIZEOF (.overlay.calc_diag);
+
+    __alt_heap_start = ALIGN (end + SIZEOF (.onchip_mem) + SIZEOF (.overlay.calc_diag), 4);
+}
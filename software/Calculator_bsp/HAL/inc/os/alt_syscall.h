@@ -66,6 +66,7 @@
 #define ALT_USLEEP       usleep
 #define ALT_WAIT         wait
 #define ALT_WRITE        write
+#define ALT_WRITEV       writev
 #define ALT_TIMES        times
 
 /*
@@ -40,6 +40,7 @@
 ******************************************************************************/
 
 #include "alt_types.h"
+#include "sys/alt_llist.h"
 
 /*
  * This header provides the internal defenitions required by the public 
@@ -60,14 +61,12 @@ extern "C"
 struct alt_alarm_s
 {
   alt_llist llist;       /* linked list */
-  alt_u32 time;          /* time in system ticks of the callback */
+  alt_u64 time;          /* time in system ticks of the callback */
   alt_u32 (*callback) (void* context); /* callback function. The return 
                           * value is the period for the next callback; where 
                           * zero indicates that the alarm should be removed 
                           * from the list. 
                           */
-  alt_u8 rollover;       /* set when desired alarm time + current time causes
-                            overflow, to prevent premature alarm */
   void* context;         /* Argument for the callback */
 };
 
@@ -84,15 +83,81 @@ extern alt_u32 _alt_tick_rate;
 
 /*
  * "_alt_nticks" is a global variable which records the elapsed number of 
- * system clock ticks since the last call to settimeofday() or since reset if
- * settimeofday() has not been called.
+ * system clock ticks since reset. It is 64 bits wide so that it never wraps
+ * round; since it is updated at interrupt level, read it through 
+ * alt_nticks64() rather than directly.
  */
 
-extern volatile alt_u32 _alt_nticks;
+extern volatile alt_u64 _alt_nticks;
 
-/* The list of registered alarms. */
+/*
+ * The registered alarms are held in a hierarchical timer wheel. Level 0 has
+ * a slot for each of the next ALT_ALARM_WHEEL_SLOTS ticks; each slot of
+ * level n covers ALT_ALARM_WHEEL_SLOTS times as many ticks as a slot of 
+ * level n - 1. An alarm is filed by how far away it is, in the slot given by
+ * the corresponding bits of its expiry time. Whenever the lower levels wrap,
+ * alt_tick() moves the alarms in the next slot of the level above down to
+ * where they now belong, so it only ever has to run the alarms in one
+ * level 0 slot.
+ *
+ * An alarm is never more than 2^32 ticks away, so the wheel covers 32 bits
+ * of the tick count.
+ */
+
+#ifndef ALT_ALARM_WHEEL_BITS
+#define ALT_ALARM_WHEEL_BITS 5
+#endif
+
+#if ALT_ALARM_WHEEL_BITS > 5
+#error ALT_ALARM_WHEEL_BITS must be no more than 5, so that a level fits in a word of alt_alarm_wheel_map
+#endif
+
+#define ALT_ALARM_WHEEL_SLOTS  (1 << ALT_ALARM_WHEEL_BITS)
+#define ALT_ALARM_WHEEL_MASK   (ALT_ALARM_WHEEL_SLOTS - 1)
+#define ALT_ALARM_WHEEL_LEVELS ((32 + ALT_ALARM_WHEEL_BITS - 1) / \
+                                ALT_ALARM_WHEEL_BITS)
+
+extern alt_llist alt_alarm_wheel[ALT_ALARM_WHEEL_LEVELS][ALT_ALARM_WHEEL_SLOTS];
+
+/*
+ * One bit per slot, set when an alarm is filed in it. Bits are cleared when
+ * the wheel empties a slot, but not when an alarm is stopped, so a set bit 
+ * only means that the slot may be occupied.
+ */
+
+extern alt_u32 alt_alarm_wheel_map[ALT_ALARM_WHEEL_LEVELS];
+
+/*
+ * alt_alarm_wheel_init() empties the wheel. It is called by alt_sysclk_init().
+ */
+
+extern void alt_alarm_wheel_init (void);
+
+/*
+ * alt_alarm_enqueue() files an alarm in the wheel according to its "time".
+ * It must be called with interrupts disabled.
+ */
+
+extern void alt_alarm_enqueue (struct alt_alarm_s* alarm);
+
+#ifdef ALT_TICKLESS
+
+/*
+ * The deadline programmed when no alarms are registered. It is far enough
+ * ahead that the clock driver will have to limit it to its own maximum.
+ */
+
+#define ALT_TICKLESS_IDLE 0x80000000
+
+/*
+ * alt_alarm_next() returns the number of ticks from _alt_nticks until the
+ * alarm wheel next needs attention. It must be called with interrupts
+ * disabled.
+ */
+
+extern alt_u32 alt_alarm_next (void);
 
-extern alt_llist alt_alarm_list;
+#endif /* ALT_TICKLESS */
 
 #ifdef __cplusplus
 }
@@ -27,7 +27,8 @@
 /*
  * The function alt_busy_sleep provides a busy loop implementation of usleep.
  * This is used to provide usleep for the standalone HAL, or when the timer is
- * unavailable in uC/OS-II.
+ * unavailable in uC/OS-II. The delay is timed by the timestamp timer if 
+ * there is one, and by a calibrated loop otherwise.
  */ 
 
 extern unsigned int alt_busy_sleep (unsigned int us);
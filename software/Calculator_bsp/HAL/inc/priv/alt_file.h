@@ -116,6 +116,16 @@ extern int alt_fd_unlock (alt_fd* fd);
 
 extern alt_fd alt_fd_list[];
 
+/*
+ * "alt_fd_used" has a bit set for each entry of alt_fd_list that is 
+ * allocated, so that alt_get_fd() can find a free one a word at a time. 
+ * It is only changed with alt_fd_list_lock held.
+ */
+
+#define ALT_FD_WORDS ((ALT_MAX_FD + 31) / 32)
+
+extern alt_u32 alt_fd_used[ALT_FD_WORDS];
+
 /*
  * flags used by alt_fd. 
  *
@@ -125,6 +135,9 @@ extern alt_fd alt_fd_list[];
  *
  * ALT_FD_DEV marks a dile descriptor as belonging to a device as oposed to a
  * filesystem. 
+ *
+ * The descriptor that holds a device locked also has its address in the
+ * device's "excl" field, so that open() need not search for it.
  */
 
 #define ALT_FD_EXCL 0x80000000
@@ -144,6 +157,35 @@ extern alt_llist alt_dev_list;
 
 extern alt_llist alt_fs_list;
 
+/*
+ * "alt_dev_hash" and "alt_fs_hash" index the devices on alt_dev_list and
+ * the filesystems on alt_fs_list by the hash of their names, so that open()
+ * takes the same time however many are registered. Each bucket is a list
+ * chained through the hash_next field of alt_dev, newest first, as the
+ * lists themselves are. A filesystem is hashed without any trailing '/'.
+ *
+ * The hash is djb2, which needs only shifts and adds: the tiny core has no
+ * multiplier.
+ */
+
+#ifndef ALT_DEV_HASH_SIZE
+#define ALT_DEV_HASH_SIZE 16    /* must be a power of two */
+#endif
+
+#define ALT_DEV_HASH_INIT       5381
+#define ALT_DEV_HASH_STEP(h, c) (((h) << 5) + (h) + (alt_u8) (c))
+#define ALT_DEV_HASH_BUCKET(h)  ((h) & (ALT_DEV_HASH_SIZE - 1))
+
+extern alt_dev* alt_dev_hash[ALT_DEV_HASH_SIZE];
+extern alt_dev* alt_fs_hash[ALT_DEV_HASH_SIZE];
+
+/*
+ * alt_dev_hash_find() returns the device on alt_dev_hash named "name", or
+ * NULL if there is none.
+ */
+
+extern alt_dev* alt_dev_hash_find (const char* name);
+
 /*
  * "alt_fd_list_lock" is a semaphore used to ensure that access to the pool
  * of file descriptors is thread safe.
@@ -69,11 +69,18 @@ static ALT_INLINE int ALT_ALWAYS_INLINE alt_irq_disable (alt_u32 id)
 {
   alt_irq_context  status;
   extern volatile alt_u32 alt_irq_active;
+#ifndef ALT_EXCEPTION_STACK
+  extern volatile alt_u32 alt_priority_mask;
+#endif
 
   status = alt_irq_disable_all ();
 
   alt_irq_active &= ~(1 << id);
+#ifdef ALT_EXCEPTION_STACK
   NIOS2_WRITE_IENABLE (alt_irq_active);
+#else
+  NIOS2_WRITE_IENABLE (alt_irq_active & alt_priority_mask);
+#endif
 
   alt_irq_enable_all(status);
 
@@ -82,16 +89,25 @@ static ALT_INLINE int ALT_ALWAYS_INLINE alt_irq_disable (alt_u32 id)
 
 /*
  * alt_irq_enable() enables the individual interrupt indicated by "id".
+ * Within a handler that allows nesting, it stays masked by
+ * alt_priority_mask until that handler returns.
  */
 static ALT_INLINE int ALT_ALWAYS_INLINE alt_irq_enable (alt_u32 id)
 {
   alt_irq_context  status;
   extern volatile alt_u32 alt_irq_active;
+#ifndef ALT_EXCEPTION_STACK
+  extern volatile alt_u32 alt_priority_mask;
+#endif
 
   status = alt_irq_disable_all ();
 
   alt_irq_active |= (1 << id);
+#ifdef ALT_EXCEPTION_STACK
   NIOS2_WRITE_IENABLE (alt_irq_active);
+#else
+  NIOS2_WRITE_IENABLE (alt_irq_active & alt_priority_mask);
+#endif
 
   alt_irq_enable_all(status);
 
@@ -94,6 +94,7 @@ static ALT_INLINE int ALT_ALWAYS_INLINE alt_sysclk_init (alt_u32 nticks)
 {
   if (! _alt_tick_rate)
   {
+    alt_alarm_wheel_init ();
     _alt_tick_rate = nticks;
     return 0;
   }
@@ -103,18 +104,72 @@ static ALT_INLINE int ALT_ALWAYS_INLINE alt_sysclk_init (alt_u32 nticks)
   }
 }
 
+#ifdef ALT_TICKLESS
+
 /*
- * alt_nticks() returns the elapsed number of system clock ticks since reset.
+ * In a tickless system (ALT_TICKLESS defined) the system clock does not
+ * interrupt on every tick. Instead the system clock driver must provide:
+ *
+ * alt_sysclk_now() - the number of ticks since reset, derived from a free
+ *                    running counter.
+ * alt_sysclk_program() - arrange for alt_tick() to be called when 
+ *                    alt_sysclk_now() reaches "deadline", or at once if it 
+ *                    already has. Calling alt_tick() earlier than asked is 
+ *                    harmless, so the driver may limit the deadline to the
+ *                    range of its hardware.
+ *
+ * alt_tick() catches up with alt_sysclk_now() and programs the next 
+ * deadline, so interrupts only occur when there is an alarm to run.
+ */
+
+extern alt_u64 alt_sysclk_now (void);
+extern void    alt_sysclk_program (alt_u64 deadline);
+
+#endif /* ALT_TICKLESS */
+
+/*
+ * alt_nticks64() returns the elapsed number of system clock ticks since 
+ * reset. 
+ *
+ * The count is updated at interrupt level, and takes two accesses to read,
+ * so a tick may carry into the high word half way through. Since the count
+ * only ever goes forwards, two reads that agree cannot both have been torn,
+ * so no locking is needed.
+ */
+
+static ALT_INLINE alt_u64 ALT_ALWAYS_INLINE alt_nticks64 (void)
+{
+#ifdef ALT_TICKLESS
+  return alt_sysclk_now ();
+#else
+  alt_u64 nticks;
+
+  do
+  {
+    nticks = _alt_nticks;
+  } while (nticks != _alt_nticks);
+
+  return nticks;
+#endif
+}
+
+/*
+ * alt_nticks() returns the low 32 bits of alt_nticks64().
  */
 
 static ALT_INLINE alt_u32 ALT_ALWAYS_INLINE alt_nticks (void)
 {
-  return _alt_nticks;
+#ifdef ALT_TICKLESS
+  return (alt_u32) alt_sysclk_now ();
+#else
+  return (alt_u32) _alt_nticks;
+#endif
 }
 
 /*
  * alt_tick() should only be called by the system clock driver. This is used
- * to notify the system that the system timer period has expired.
+ * to notify the system that the system timer period has expired, or in a
+ * tickless system that the programmed deadline has been reached.
  */
 
 extern void alt_tick (void);
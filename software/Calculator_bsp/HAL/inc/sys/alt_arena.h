@@ -0,0 +1,178 @@
+#ifndef __ALT_ARENA_H__
+#define __ALT_ARENA_H__
+
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2006 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+* Altera does not recommend, suggest or require that this reference design    *
+* file be used in conjunction or combination with any other product.          *
+******************************************************************************/
+
+
+#include "alt_types.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/*
+ * Scratch arenas. An arena hands out memory from a fixed buffer by moving
+ * a pointer up it, and takes it all back at once: alt_arena_mark() 
+ * returns the current position, and alt_arena_rewind() frees everything 
+ * allocated since. Allocation is a compare and an add, and nothing is ever
+ * freed one block at a time, so an arena suits temporaries whose lifetime
+ * is one calculation or one request, which are reset together at the end
+ * of it with alt_arena_reset().
+ *
+ * An arena is checked: an allocation that does not fit returns NULL and
+ * is counted, rather than running off the end of the buffer. It records 
+ * the most that has been used since the last reset, which 
+ * alt_arena_reset() returns, and the most that has been used ever.
+ *
+ * If ALT_ARENA_DEBUG is defined, memory is filled with ALT_ARENA_POISON 
+ * when it is rewound, so that a pointer kept past its rewind reads 
+ * garbage, and each allocation checks that its memory still holds the 
+ * poison, counting an error if something has written to it since. 
+ * Allocations then cost time in proportion to their size.
+ *
+ * Arenas are not locked: each should be used by one thread, and not from
+ * interrupt handlers.
+ *
+ * Memory is aligned to the size of a pointer.
+ */
+
+#ifndef ALT_ARENA_POISON
+#define ALT_ARENA_POISON 0xdb
+#endif
+
+#define ALT_ARENA_ALIGN sizeof (void*)
+
+typedef struct alt_arena_s alt_arena;
+
+struct alt_arena_s
+{
+  char*   base;
+  alt_u32 size;
+  alt_u32 used;      /* Bytes allocated now */
+  alt_u32 high;      /* The most that used has been since the last reset */
+  alt_u32 peak;      /* The most that high has been at a reset */
+  alt_u32 failures;  /* Allocations that did not fit */
+  alt_u32 errors;    /* With ALT_ARENA_DEBUG, misuse found */
+};
+
+/*
+ * ALT_ARENA_INIT() initialises an arena statically, to use "storage", 
+ * which must be an array aligned to ALT_ARENA_ALIGN.
+ */
+
+#define ALT_ARENA_INIT(storage)                                        \
+  {                                                                    \
+    (char*) (storage),                                                 \
+    sizeof (storage) & ~(ALT_ARENA_ALIGN - 1),                         \
+  }
+
+/*
+ * alt_arena_init() sets up "arena" to use the "size" bytes at "mem".
+ */
+
+extern void alt_arena_init (alt_arena* arena, void* mem, alt_u32 size);
+
+extern void* alt_arena_fail (alt_arena* arena);
+extern void* alt_arena_alloc_checked (alt_arena* arena, alt_u32 size);
+
+/*
+ * alt_arena_alloc() returns "size" bytes from "arena", or NULL if there is
+ * not room for them. Their contents are undefined.
+ */
+
+static ALT_INLINE void* ALT_ALWAYS_INLINE alt_arena_alloc (alt_arena* arena,
+                                                          alt_u32 size)
+{
+#ifdef ALT_ARENA_DEBUG
+  return alt_arena_alloc_checked (arena, size);
+#else
+  alt_u32 used = arena->used;
+
+  /* What is left is a multiple of ALT_ARENA_ALIGN, so size fits rounded up */
+
+  if (size > arena->size - used)
+  {
+    return alt_arena_fail (arena);
+  }
+
+  arena->used = used + ((size + ALT_ARENA_ALIGN - 1) & ~(ALT_ARENA_ALIGN - 1));
+  if (arena->used > arena->high)
+  {
+    arena->high = arena->used;
+  }
+
+  return arena->base + used;
+#endif
+}
+
+/*
+ * alt_arena_mark() returns the position to which alt_arena_rewind() can 
+ * later return "arena".
+ */
+
+static ALT_INLINE alt_u32 ALT_ALWAYS_INLINE alt_arena_mark (alt_arena* arena)
+{
+  return arena->used;
+}
+
+/*
+ * alt_arena_rewind() frees everything allocated from "arena" since "mark"
+ * was taken. A mark taken before an earlier rewind or reset that went 
+ * further back is out of date, and is ignored (and counted as an error 
+ * with ALT_ARENA_DEBUG).
+ */
+
+extern void alt_arena_rewind (alt_arena* arena, alt_u32 mark);
+
+/*
+ * alt_arena_reset() frees everything allocated from "arena", and returns 
+ * the most that was in use at once since the last reset.
+ */
+
+extern alt_u32 alt_arena_reset (alt_arena* arena);
+
+/*
+ * alt_arena_peak() returns the most that has ever been in use at once.
+ */
+
+static ALT_INLINE alt_u32 ALT_ALWAYS_INLINE alt_arena_peak (alt_arena* arena)
+{
+  return arena->high > arena->peak ? arena->high : arena->peak;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ALT_ARENA_H__ */
@@ -0,0 +1,103 @@
+#ifndef __ALT_CLOCK_H__
+#define __ALT_CLOCK_H__
+
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2006 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+* Altera does not recommend, suggest or require that this reference design    *
+* file be used in conjunction or combination with any other product.          *
+******************************************************************************/
+
+
+#include "alt_types.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/*
+ * A monotonic clock with nanosecond resolution, which counts from reset.
+ * It is read from the timestamp timer if there is one, and from the system
+ * clock tick count otherwise, so it advances in steps of one timestamp
+ * cycle or one tick.
+ *
+ * Counts are converted with fixed point reciprocals of the clock rate, 
+ * which are worked out once, so reading the clock takes no division.
+ */
+
+typedef struct alt_timespec_s
+{
+  alt_u32 tv_sec;
+  alt_u32 tv_nsec;
+} alt_timespec;
+
+/*
+ * alt_clock_gettime() fills in "tp" and returns 0, or returns -ENOTSUP if
+ * there is neither a timestamp timer nor a system clock.
+ */
+
+extern int alt_clock_gettime (alt_timespec* tp);
+
+/*
+ * alt_clock_ns() returns the same time in nanoseconds, or 0 if there is no
+ * clock. It is cheaper than alt_clock_gettime(), and intended for timing
+ * code.
+ */
+
+extern alt_u64 alt_clock_ns (void);
+
+/*
+ * alt_clock_to_rate() converts "tp" to a count at "rate" Hz, rounded down.
+ */
+
+extern alt_u64 alt_clock_to_rate (const alt_timespec* tp, alt_u32 rate);
+
+/*
+ * alt_clock_mulhi() returns the high 64 bits of the 128 bit product of "a"
+ * and "b". Multiplying by (2^64 - 1) / d this way divides by d, leaving the
+ * quotient at most two too small.
+ */
+
+extern alt_u64 alt_clock_mulhi (alt_u64 a, alt_u64 b);
+
+/*
+ * alt_clock_ns_to_us() divides a number of nanoseconds below 2^32 by 1000,
+ * using a multiplication by the reciprocal.
+ */
+
+static ALT_INLINE alt_u32 ALT_ALWAYS_INLINE alt_clock_ns_to_us (alt_u32 nsec)
+{
+  return (alt_u32) (((alt_u64) nsec * 274877907u) >> 38);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ALT_CLOCK_H__ */
@@ -58,6 +58,7 @@ extern "C"
 typedef struct alt_dev_s alt_dev;
 
 struct stat;
+struct iovec;
 
 /*
  * The file descriptor structure definition.
@@ -84,6 +85,10 @@ struct alt_dev_s {
   int (*lseek) (alt_fd* fd, int ptr, int dir);
   int (*fstat) (alt_fd* fd, struct stat* buf);
   int (*ioctl) (alt_fd* fd, int req, void* arg);
+  int (*writev)(alt_fd* fd, const struct iovec* iov, int iovcnt); /* optional */
+  alt_dev*     hash_next; /* for internal use */
+  alt_u32      hash;      /* for internal use */
+  alt_fd*      excl;      /* for internal use */
 };
 
 /*
@@ -101,11 +106,26 @@ struct alt_dev_s {
 
 extern int alt_fs_reg  (alt_dev* dev); 
 
+/*
+ * Both also add the device to a hash table of names, which is what open()
+ * searches, so a device must be registered through one of them to be 
+ * found. alt_dev_hash_insert() is for internal use.
+ */
+
+extern void alt_dev_hash_insert (alt_dev* dev, alt_dev** table);
+
 static ALT_INLINE int alt_dev_reg (alt_dev* dev)
 {
   extern alt_llist alt_dev_list;
-
-  return alt_dev_llist_insert ((alt_dev_llist*) dev, &alt_dev_list);
+  extern alt_dev*  alt_dev_hash[];
+  int              ret;
+
+  ret = alt_dev_llist_insert ((alt_dev_llist*) dev, &alt_dev_list);
+  if (!ret)
+  {
+    alt_dev_hash_insert (dev, alt_dev_hash);
+  }
+  return ret;
 }
 
 #ifdef __cplusplus
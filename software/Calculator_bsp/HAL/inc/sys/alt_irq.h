@@ -236,6 +236,76 @@ static ALT_INLINE alt_u32 ALT_ALWAYS_INLINE alt_irq_pending (void)
 
   return active;
 }
+
+/*
+ * alt_irq_set_order() sets the order in which alt_irq_handler() services
+ * interrupts that are pending together: the "n" IRQs listed in "order" 
+ * come first, highest priority first, followed by the rest in increasing 
+ * IRQ number. By default the order is simply increasing IRQ number. It 
+ * returns -EINVAL if an IRQ in the list is out of range or repeated.
+ *
+ * This has no effect if the interrupt vector custom instruction is used.
+ */
+extern int alt_irq_set_order (const alt_u8* order, alt_u32 n);
+
+/*
+ * alt_irq_set_priority() sets the priority level of interrupt "id", from 0
+ * (the highest, and the default) to 255. Pending interrupts are serviced 
+ * in order of level; within a level the order set by alt_irq_set_order()
+ * still applies, but is otherwise replaced. It returns -EINVAL if "id" or
+ * "level" is out of range.
+ *
+ * If the HAL is built with ALT_IRQ_NESTED defined, a handler may also be 
+ * interrupted by any interrupt at a higher level than its own, which is
+ * serviced before the handler resumes. Since all interrupts start at 
+ * level 0, nothing nests until levels are set. Each level of nesting 
+ * takes another exception frame on the stack of the interrupted code, and
+ * nesting is not available with a separate exception stack.
+ */
+extern int alt_irq_set_priority (alt_u32 id, alt_u32 level);
+
+/*
+ * alt_irq_register_fast() registers "handler" for interrupt "id" as 
+ * alt_irq_register() does, but as a fast handler: if its interrupt is 
+ * pending when the exception is taken, it is called straight from the 
+ * exception vector, ahead of any other interrupt, without the exception
+ * cause decode or alt_irq_handler(), and with a reduced register save (see
+ * alt_irq_fast_entry.S). That suits short handlers such as a timer tick 
+ * or a FIFO drain.
+ *
+ * A fast handler must be a leaf function: it must not call other 
+ * functions, nor enable interrupts. If ALT_IRQ_FAST_CALL_SAVED is defined,
+ * registers r8-r15 are not saved on entry, and every fast handler must be
+ * compiled with -fcall-saved-r8 ... -fcall-saved-r15 so that it saves 
+ * those it uses itself. Fast handlers are not counted in alt_irq_count[] 
+ * or by ALT_IRQ_STATS, except when alt_irq_handler() finds their 
+ * interrupt pending while it is running and calls them in the usual way.
+ *
+ * Up to ALT_IRQ_FAST_MAX handlers may be fast at once; beyond that it 
+ * returns -ENOSPC. Registering a NULL handler removes it. With a separate
+ * exception stack or stack checking, handlers are registered as usual ones.
+ *
+ * With the enhanced interrupt API, passing ALT_IRQ_FLAG_FAST as the 
+ * "flags" of alt_ic_isr_register() does the same if the HAL is built with
+ * ALT_IRQ_FAST_ENTRY defined, and is ignored otherwise: the fast entry 
+ * adds a dozen instructions to every other exception, so it is only 
+ * linked in when asked for.
+ */
+
+#ifndef ALT_IRQ_FAST_MAX
+#define ALT_IRQ_FAST_MAX 4
+#endif
+
+#define ALT_IRQ_FLAG_FAST ((void*) 1)
+
+extern int alt_irq_register_fast (alt_u32 id, void* context, 
+                                  alt_isr_func handler);
+
+/*
+ * alt_irq_count[] holds the number of times alt_irq_handler() has called
+ * the handler for each interrupt.
+ */
+extern alt_u32 alt_irq_count[ALT_NIRQ];
 #endif 
 
 #ifdef __cplusplus
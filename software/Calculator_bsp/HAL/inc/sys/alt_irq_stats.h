@@ -0,0 +1,123 @@
+#ifndef __ALT_IRQ_STATS_H__
+#define __ALT_IRQ_STATS_H__
+
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2006 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+* Altera does not recommend, suggest or require that this reference design    *
+* file be used in conjunction or combination with any other product.          *
+******************************************************************************/
+
+
+#include "alt_types.h"
+#include "sys/alt_timestamp.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/*
+ * Interrupt statistics. If ALT_IRQ_STATS is defined when the HAL is built,
+ * alt_irq_handler() reads the time each time it reads the pending 
+ * interrupts, and before and after it calls each handler, and keeps for 
+ * each interrupt:
+ *
+ *  - the number of times its handler has been called;
+ *  - its entry latency: the time from alt_irq_handler() finding it pending
+ *    to its handler being called. This is the time spent deciding what to
+ *    call, and in the handlers of the interrupts serviced ahead of it;
+ *  - the duration of its handler, including that of any handlers nested
+ *    within it (see ALT_IRQ_NESTED).
+ *
+ * The latency is therefore a lower bound. The time from the interrupt 
+ * being raised to alt_irq_handler() being entered (or, if it was raised 
+ * while other handlers were running, to it reading the pending interrupts
+ * again) is not seen: that is the time for which interrupts were disabled,
+ * and for the processor to take the exception and save registers.
+ *
+ * For both the latency and the duration, the total, the largest, and a
+ * histogram with power of two buckets are kept: bucket 0 counts times of
+ * 0, and bucket n times from 2^(n-1) to 2^n - 1, except that the last
+ * bucket also counts every longer time.
+ *
+ * Times are in units of ALT_IRQ_STATS_NOW(), which defaults to the 
+ * timestamp timer's count. Without a timestamp timer, only the counts are
+ * meaningful. Without ALT_IRQ_STATS, none of this is compiled in, and
+ * alt_irq_handler() is as fast as it would otherwise be.
+ */
+
+#ifndef ALT_IRQ_STATS_NOW
+#define ALT_IRQ_STATS_NOW()  ((alt_u32) alt_timestamp_count ())
+#define ALT_IRQ_STATS_FREQ() alt_timestamp_freq ()
+#endif
+
+#ifndef ALT_IRQ_STATS_BUCKETS
+#define ALT_IRQ_STATS_BUCKETS 16
+#endif
+
+typedef struct alt_irq_time_s
+{
+  alt_u64 total;
+  alt_u32 max;
+  alt_u32 hist[ALT_IRQ_STATS_BUCKETS];
+} alt_irq_time;
+
+typedef struct alt_irq_stats_s
+{
+  alt_u32      count;
+  alt_irq_time latency;
+  alt_irq_time duration;
+} alt_irq_stats;
+
+/*
+ * alt_irq_stats_get() copies the statistics for interrupt "id" to 
+ * "stats". It returns 0, or -EINVAL if "id" is out of range, and -ENOSYS
+ * if the HAL was built without ALT_IRQ_STATS.
+ */
+
+extern int alt_irq_stats_get (alt_u32 id, alt_irq_stats* stats);
+
+/*
+ * alt_irq_stats_reset() clears the statistics for every interrupt.
+ */
+
+extern void alt_irq_stats_reset (void);
+
+/*
+ * alt_irq_stats_freq() returns the number of time units per second, or 0
+ * if there is no clock to time interrupts with.
+ */
+
+extern alt_u32 alt_irq_stats_freq (void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ALT_IRQ_STATS_H__ */
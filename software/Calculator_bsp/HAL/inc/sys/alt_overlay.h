@@ -0,0 +1,162 @@
+#ifndef __ALT_OVERLAY_H__
+#define __ALT_OVERLAY_H__
+
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2006 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+* Altera does not recommend, suggest or require that this reference design    *
+* file be used in conjunction or combination with any other product.          *
+******************************************************************************/
+
+
+#include "alt_types.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/*
+ * Code overlays. Routines that are too big to keep in onchip_mem all the
+ * time, and too rarely used to matter when they are slow to start, can be
+ * put in overlays: each overlay is linked to run at the same address in 
+ * onchip_mem, the overlay window, and loaded there from its image in 
+ * SDRAM when it is called and some other overlay is resident.
+ *
+ * A function is put in overlay "name" with ALT_OVERLAY(name), and called 
+ * through ALT_OVERLAY_CALL(name, function), which loads the overlay first
+ * if it is not resident:
+ *
+ *   ALT_OVERLAY_DECLARE (diag);
+ *   ALT_OVERLAY(diag) int diag_dump (int fd) { ... }
+ *   ALT_OVERLAY_DEFINE (diag);
+ *
+ *   n = ALT_OVERLAY_CALL (diag, diag_dump) (fd);
+ *
+ * Each overlay must also be listed in the application's overlay linker 
+ * script, which places the input section ".overlay.name" in an OVERLAY 
+ * statement in onchip_mem, with its load address in SDRAM below the heap.
+ * That script defines __alt_overlay_start and __alt_overlay_end, the 
+ * bounds of the window.
+ *
+ * Only one overlay is resident at a time. Code in an overlay may call 
+ * resident code and functions in its own overlay directly, but must not 
+ * call into another overlay, which would overwrite it while it is running;
+ * nor may overlays be used from interrupt handlers or by more than one
+ * thread.
+ *
+ * Each overlay counts the calls made through ALT_OVERLAY_CALL() and the 
+ * times it has been loaded, and overlays that have been called are linked
+ * on alt_overlay_list, so that the split between overlays can be judged 
+ * from a running system.
+ */
+
+typedef struct alt_overlay_s alt_overlay;
+
+struct alt_overlay_s
+{
+  const char*  name;
+  const char*  image;     /* The load address in SDRAM */
+  const char*  image_end;
+  alt_overlay* next;      /* On alt_overlay_list, once called */
+  alt_u32      calls;     /* Calls through ALT_OVERLAY_CALL() */
+  alt_u32      loads;     /* Times it was copied into the window */
+};
+
+/* The overlay in the window, or NULL */
+extern alt_overlay* alt_overlay_resident;
+
+/* Every overlay that has been called, most recently first called first */
+extern alt_overlay* alt_overlay_list;
+
+extern char __alt_overlay_start[];
+extern char __alt_overlay_end[];
+
+/* 
+ * The load address symbols are those the linker defines for each section
+ * of an OVERLAY statement, with the dots taken out of the section name.
+ */
+
+#define ALT_OVERLAY(name) \
+  __attribute__ ((section (".overlay." #name), noinline))
+
+#define ALT_OVERLAY_DECLARE(name) extern alt_overlay name##_overlay
+
+#define ALT_OVERLAY_DEFINE(name)                                       \
+  extern char __load_start_overlay##name[];                            \
+  extern char __load_stop_overlay##name[];                             \
+  alt_overlay name##_overlay =                                         \
+  {                                                                    \
+    #name,                                                             \
+    __load_start_overlay##name,                                        \
+    __load_stop_overlay##name,                                         \
+  }
+
+extern void alt_overlay_load (alt_overlay* overlay);
+
+/*
+ * alt_overlay_enter() makes "overlay" resident, loading it if need be.
+ * ALT_OVERLAY_CALL() calls it before calling into the overlay.
+ */
+
+static ALT_INLINE void ALT_ALWAYS_INLINE alt_overlay_enter (alt_overlay* overlay)
+{
+  overlay->calls++;
+  if (alt_overlay_resident != overlay)
+  {
+    alt_overlay_load (overlay);
+  }
+}
+
+#define ALT_OVERLAY_CALL(name, function) \
+  (alt_overlay_enter (&name##_overlay), (function))
+
+/*
+ * alt_overlay_is_resident() returns non-zero if "overlay" is in the 
+ * window.
+ */
+
+static ALT_INLINE int ALT_ALWAYS_INLINE alt_overlay_is_resident (alt_overlay* overlay)
+{
+  return alt_overlay_resident == overlay;
+}
+
+/*
+ * alt_overlay_size() returns the size of "overlay" in bytes.
+ */
+
+static ALT_INLINE alt_u32 ALT_ALWAYS_INLINE alt_overlay_size (alt_overlay* overlay)
+{
+  return overlay->image_end - overlay->image;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ALT_OVERLAY_H__ */
@@ -0,0 +1,152 @@
+#ifndef __ALT_POOL_H__
+#define __ALT_POOL_H__
+
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2006 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+* Altera does not recommend, suggest or require that this reference design    *
+* file be used in conjunction or combination with any other product.          *
+******************************************************************************/
+
+
+#include <stddef.h>
+
+#include "alt_types.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/*
+ * Fixed size object pools. A pool hands out objects of one type from a 
+ * static array, so that objects which are allocated and freed often need
+ * neither be static for their whole lives nor come from the heap. 
+ * Allocating and freeing take a few instructions whatever the state of 
+ * the pool, and may be done from interrupt handlers: a freed object is 
+ * pushed onto the pool's free list, linked through its first word, and 
+ * interrupts are disabled only for the push or the pop.
+ *
+ * ALT_POOL_DECLARE() declares a pool, and name_alloc() and name_free() 
+ * for its type, wherever it is used; ALT_POOL_DEFINE() then defines it in
+ * one source file:
+ *
+ *   ALT_POOL_DECLARE (msg_pool, struct msg)
+ *   ALT_POOL_DEFINE (msg_pool, struct msg, 8);
+ *
+ *   struct msg* m = msg_pool_alloc ();
+ *   ...
+ *   msg_pool_free (m);
+ *
+ * ALT_POOL_DEFINE_ONCHIP() places the objects themselves in onchip_mem 
+ * rather than in .bss. Their contents are never read before they are 
+ * allocated and written, so the section needs no initialising at boot.
+ *
+ * Each pool counts the objects in use, the most that have ever been in 
+ * use at once, and the allocations that failed because all were in use, 
+ * so that pools can be sized from a running system.
+ */
+
+typedef struct alt_pool_s alt_pool;
+
+struct alt_pool_s
+{
+  void*   free;      /* Freed objects, linked through their first word */
+  char*   fresh;     /* The first object that has never been allocated */
+  char*   end;
+  alt_u32 size;      /* Of one object */
+  alt_u32 count;     /* Of objects */
+  alt_u32 used;      /* Objects allocated now */
+  alt_u32 peak;      /* The most that used has been */
+  alt_u32 failures;  /* Allocations that found every object in use */
+};
+
+/* The section in which ALT_POOL_DEFINE_ONCHIP() places objects */
+
+#define ALT_POOL_ONCHIP __attribute__ ((section ("onchip_mem.alt_pool")))
+
+#define ALT_POOL_INIT(storage)                                  \
+  {                                                             \
+    NULL,                                                       \
+    (char*) (storage),                                          \
+    (char*) (storage) + sizeof (storage),                       \
+    sizeof ((storage)[0]),                                      \
+    sizeof (storage) / sizeof ((storage)[0]),                   \
+  }
+
+#define ALT_POOL_DECLARE(name, type)                            \
+  extern alt_pool name;                                         \
+  static ALT_INLINE type* ALT_ALWAYS_INLINE name##_alloc (void) \
+  {                                                             \
+    return (type*) alt_pool_alloc (&name);                      \
+  }                                                             \
+  static ALT_INLINE void ALT_ALWAYS_INLINE name##_free (type* obj) \
+  {                                                             \
+    alt_pool_free (&name, obj);                                 \
+  }
+
+#define ALT_POOL_DEFINE_IN(name, type, n, attr)                 \
+  static union                                                  \
+  {                                                             \
+    type  obj;                                                  \
+    void* link;                                                 \
+  } name##_objects[n] attr;                                     \
+  alt_pool name = ALT_POOL_INIT (name##_objects)
+
+#define ALT_POOL_DEFINE(name, type, n)                          \
+  ALT_POOL_DEFINE_IN (name, type, n, )
+
+#define ALT_POOL_DEFINE_ONCHIP(name, type, n)                   \
+  ALT_POOL_DEFINE_IN (name, type, n, ALT_POOL_ONCHIP)
+
+/*
+ * alt_pool_alloc() returns an object from "pool", or NULL if every one is
+ * in use. The object's contents are undefined.
+ */
+
+extern void* alt_pool_alloc (alt_pool* pool);
+
+/*
+ * alt_pool_free() returns "obj", which must have come from "pool", to it.
+ * NULL is ignored.
+ */
+
+extern void alt_pool_free (alt_pool* pool, void* obj);
+
+/*
+ * alt_pool_reset_peak() sets the peak number of objects in use back to the
+ * number in use now.
+ */
+
+extern void alt_pool_reset_peak (alt_pool* pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ALT_POOL_H__ */
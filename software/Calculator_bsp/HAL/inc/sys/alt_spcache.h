@@ -0,0 +1,237 @@
+#ifndef __ALT_SPCACHE_H__
+#define __ALT_SPCACHE_H__
+
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2006 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+* Altera does not recommend, suggest or require that this reference design    *
+* file be used in conjunction or combination with any other product.          *
+******************************************************************************/
+
+
+#include "alt_types.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/*
+ * Scratchpad caches. The core has no data cache, so every read of a table
+ * in SDRAM waits for SDRAM. A scratchpad cache keeps copies of a read-
+ * mostly table's most used blocks in onchip_mem: ALT_SPCACHE_READ() looks
+ * an element up, and reads it from onchip_mem if its block is there, or
+ * copies the block in first if not. The table itself stays where it is.
+ *
+ * A cache is direct-mapped, or 2-way set associative with the least 
+ * recently used way replaced. Blocks and sets are powers of two:
+ *
+ *   static const glyph font[256] = { ... };
+ *
+ *   ALT_SPCACHE_DEFINE (font_cache, font, 32, 8, 2);
+ *
+ *   g = ALT_SPCACHE_READ (font_cache, glyph, &font[c]);
+ *
+ * ALT_SPCACHE_DEFINE() defines the cache, the copies and their tags in 
+ * onchip_mem (here 8 sets of 2 blocks of 32 bytes), a constructor that 
+ * empties it at startup, and font_cache_lookup(), the lookup that 
+ * ALT_SPCACHE_READ() calls. The table, block size, sets and ways are 
+ * constants of the lookup, so that a hit costs shifts and masks by 
+ * constants and loads from onchip_mem only. A cache can therefore only be
+ * read in the file that defines it.
+ *
+ * An element must not straddle two blocks, which holds for any array of 
+ * elements no bigger than a block whose size divides the block's. If the
+ * table is written, alt_spcache_invalidate() must be called before it is 
+ * read again through the cache.
+ *
+ * A lookup costs some instructions of its own, so a cache pays only if 
+ * most lookups hit and each is followed by many reads. Used to copy out a
+ * single element per lookup, as ALT_SPCACHE_READ() alone does, it loses
+ * cycles: 114 to 168 a lookup in spcache_bench's text test with a direct-
+ * mapped cache, and more with a 2-way one. Each cache counts its hits and
+ * misses, and alt_spcache_saved() estimates from them the cycles saved 
+ * over reading the table directly.
+ *
+ * Caches are not locked: each should be used by one thread, and not from
+ * interrupt handlers.
+ */
+
+typedef struct alt_spcache_s alt_spcache;
+
+/*
+ * The descriptor is read by alt_spcache_fill(), alt_spcache_invalidate()
+ * and alt_spcache_saved(). A hit only counts itself in it.
+ */
+
+struct alt_spcache_s
+{
+  const char* table;  /* The table in SDRAM */
+  alt_u32     size;   /* Its size in bytes */
+  char*       data;   /* The copies: line n at n * block */
+  alt_u32*    tags;   /* Of each line: the offset of its block, or empty */
+  alt_u8*     victim; /* Of each set, the way to replace next, if 2-way */
+  alt_u32     block;  /* Block size in bytes */
+  alt_u32     shift;  /* Its log2 */
+  alt_u32     sets;
+  alt_u32     ways;
+  alt_u32     hits;
+  alt_u32     misses;
+};
+
+/* The tag of an empty line: no block starts at an odd offset */
+
+#define ALT_SPCACHE_EMPTY 0xffffffff
+
+/*
+ * The descriptor, copies and tags are in onchip_mem, which alt_load() does
+ * not initialise: the constructor fills the descriptor in and marks every 
+ * line empty.
+ */
+
+#define ALT_SPCACHE_ONCHIP __attribute__ ((section ("onchip_mem.alt_spcache")))
+
+#define ALT_SPCACHE_DEFINE(name, tbl, block, sets, ways)                \
+  static char name##_data[(sets) * (ways) * (block)]                    \
+    __attribute__ ((aligned (4))) ALT_SPCACHE_ONCHIP;                   \
+  static alt_u32 name##_tags[(sets) * (ways)] ALT_SPCACHE_ONCHIP;       \
+  static alt_u8  name##_victim[(ways) == 2 ? (sets) : 1]                \
+    ALT_SPCACHE_ONCHIP;                                                 \
+  alt_spcache name ALT_SPCACHE_ONCHIP;                                  \
+  static void __attribute__ ((constructor)) name##_init (void)          \
+  {                                                                     \
+    alt_spcache_init (&name, (tbl), sizeof (tbl), name##_data,          \
+                      name##_tags, name##_victim, (block), (sets),      \
+                      (ways));                                          \
+  }                                                                     \
+  static ALT_INLINE const void* ALT_ALWAYS_INLINE                       \
+    name##_lookup (const void* addr)                                    \
+  {                                                                     \
+    return alt_spcache_lookup (&name, (const char*) (tbl), name##_data, \
+                               name##_tags, name##_victim, addr,        \
+                               (block), (sets), (ways));                \
+  }
+
+/*
+ * Estimated costs in cycles, for alt_spcache_saved(): the wait for a word
+ * from SDRAM rather than onchip_mem, a hit, the extra for a hit in a 2-way
+ * cache, and copying one word of a block in.
+ *
+ * The tiny core takes about 6 cycles an instruction. A direct-mapped hit 
+ * is 19 instructions: 3 for the offset into the table, 5 to load the tag,
+ * 3 to compare it, 4 to count the hit and 4 for the address of the copy.
+ * A 2-way hit adds 5, one to keep the set as well as its tags' offset and
+ * 4 to store the victim, and in the second way 3 to load and compare its 
+ * tag, counted here as half the time. Copying a word is a load, a store, 
+ * two increments and a branch. If the code runs from SDRAM, each 
+ * instruction also waits for its fetch; define higher costs to suit.
+ */
+
+#ifndef ALT_SPCACHE_SDRAM_WAIT
+#define ALT_SPCACHE_SDRAM_WAIT 6
+#endif
+
+#ifndef ALT_SPCACHE_LOOKUP_COST
+#define ALT_SPCACHE_LOOKUP_COST 114
+#endif
+
+#ifndef ALT_SPCACHE_WAY_COST
+#define ALT_SPCACHE_WAY_COST 39
+#endif
+
+#ifndef ALT_SPCACHE_COPY_COST
+#define ALT_SPCACHE_COPY_COST 30
+#endif
+
+extern void alt_spcache_init (alt_spcache* cache, const void* table, 
+                              alt_u32 size, char* data, alt_u32* tags, 
+                              alt_u8* victim, alt_u32 block, alt_u32 sets,
+                              alt_u32 ways);
+
+extern const void* alt_spcache_fill (alt_spcache* cache, alt_u32 offset);
+
+/*
+ * alt_spcache_lookup() returns the address in onchip_mem of the copy of 
+ * "addr", an address in "table". It is called by the name##_lookup() of
+ * ALT_SPCACHE_DEFINE(), with everything but "addr" constant.
+ */
+
+static ALT_INLINE const void* ALT_ALWAYS_INLINE 
+  alt_spcache_lookup (alt_spcache* cache, const char* table, char* data, 
+                      alt_u32* tags, alt_u8* victim, const void* addr, 
+                      alt_u32 block, alt_u32 sets, alt_u32 ways)
+{
+  alt_u32 offset = (const char*) addr - table;
+  alt_u32 start  = offset & ~(block - 1);
+  alt_u32 set    = (offset / block) & (sets - 1);
+  alt_u32 line   = set * ways;
+
+  if (tags[line] == start)
+  {
+    if (ways == 2)
+    {
+      victim[set] = 1;
+    }
+  }
+  else if (ways == 2 && tags[line + 1] == start)
+  {
+    victim[set] = 0;
+    line++;
+  }
+  else
+  {
+    return alt_spcache_fill (cache, offset);
+  }
+
+  cache->hits++;
+  return data + line * block + (offset & (block - 1));
+}
+
+#define ALT_SPCACHE_READ(name, type, addr) \
+  (*(const type*) name##_lookup (addr))
+
+/*
+ * alt_spcache_invalidate() empties "cache", so that every block is copied
+ * afresh from the table.
+ */
+
+extern void alt_spcache_invalidate (alt_spcache* cache);
+
+/*
+ * alt_spcache_saved() estimates the cycles "cache" has saved, if each 
+ * lookup was followed by "reads" reads of a word or less. It may be 
+ * negative.
+ */
+
+extern alt_64 alt_spcache_saved (alt_spcache* cache, alt_u32 reads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ALT_SPCACHE_H__ */
@@ -0,0 +1,159 @@
+#ifndef __ALT_STACK_USAGE_H__
+#define __ALT_STACK_USAGE_H__
+
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2006 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+* Altera does not recommend, suggest or require that this reference design    *
+* file be used in conjunction or combination with any other product.          *
+******************************************************************************/
+
+
+#include "alt_types.h"
+#include "sys/alt_alarm.h"
+#include "sys/alt_work.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/*
+ * Stack high water marks. If ALT_STACK_PAINT is defined when the HAL is
+ * built, alt_main() calls alt_stack_paint() before interrupts are first 
+ * enabled, which fills the unused part of each stack with 
+ * ALT_STACK_PAINT_VALUE. The deepest a stack has been used is then found
+ * by scanning up from its bottom for the first word that has changed.
+ *
+ * The stack shares SDRAM with the heap, and the space between them is 
+ * megabytes, which would take too long to paint; so only the 
+ * ALT_STACK_PAINT_BYTES below the top of the stack are painted, and a peak
+ * equal to that size means at least that much has been used. The separate
+ * exception stack (ALT_EXCEPTION_STACK) and interrupt stack 
+ * (ALT_INTERRUPT_STACK) are painted whole, when they are configured.
+ *
+ * A scan reads each painted word from the bottom of the stack up to its 
+ * peak, so it takes longer the less of the stack has been used, and is
+ * best done in thread context. alt_stack_report_start() does so 
+ * periodically, from an alarm that queues deferred work.
+ */
+
+#ifndef ALT_STACK_PAINT_BYTES
+#define ALT_STACK_PAINT_BYTES 8192
+#endif
+
+#ifndef ALT_STACK_PAINT_VALUE
+#define ALT_STACK_PAINT_VALUE 0xdeadbeef
+#endif
+
+/* The stacks, for alt_stack_usage_get() */
+
+#define ALT_STACK_MAIN      0
+#define ALT_STACK_EXCEPTION 1
+#define ALT_STACK_INTERRUPT 2
+#define ALT_STACK_COUNT     3
+
+typedef struct alt_stack_usage_s
+{
+  alt_u32 size;       /* the bytes painted */
+  alt_u32 peak;       /* the most bytes ever used, up to size */
+} alt_stack_usage;
+
+/*
+ * alt_stack_paint() paints every stack below the caller's stack pointer.
+ * It is called from alt_main(), and must not be called again once 
+ * interrupts have been enabled.
+ */
+
+extern void alt_stack_paint (void);
+
+/*
+ * alt_stack_usage_get() scans stack "id" and copies its usage to "usage".
+ * It returns 0, or -EINVAL if there is no such stack in this system, and
+ * -ENOSYS if the HAL was built without ALT_STACK_PAINT.
+ */
+
+extern int alt_stack_usage_get (alt_u32 id, alt_stack_usage* usage);
+
+/*
+ * alt_stack_peak() returns the most bytes ever used of the main stack, or
+ * 0 without ALT_STACK_PAINT.
+ */
+
+static ALT_INLINE alt_u32 ALT_ALWAYS_INLINE alt_stack_peak (void)
+{
+  alt_stack_usage usage;
+
+  return alt_stack_usage_get (ALT_STACK_MAIN, &usage) == 0 ? usage.peak : 0;
+}
+
+/*
+ * A periodic report. Every "period" ticks, its alarm queues "work" at the
+ * lowest priority; when that is run by alt_work_run(), every stack is 
+ * scanned into "usage", and "func" is called with the report. "grown" has
+ * bit n set if the peak of stack n has grown since the last report, so
+ * that "func" may stay quiet when nothing has changed.
+ */
+
+typedef struct alt_stack_report_s alt_stack_report;
+
+struct alt_stack_report_s
+{
+  alt_alarm       alarm;
+  alt_work        work;
+  alt_u32         period;
+  void            (*func) (alt_stack_report* report);
+  void*           context;
+  alt_u32         grown;
+  alt_stack_usage usage[ALT_STACK_COUNT];
+};
+
+/*
+ * alt_stack_report_start() starts "report", which calls "func" with
+ * "context" in it every "nticks" system clock ticks. It returns 0, or
+ * a negative value if the alarm could not be started, and -ENOSYS if the
+ * HAL was built without ALT_STACK_PAINT.
+ */
+
+extern int alt_stack_report_start (alt_stack_report* report, 
+                                   alt_u32 nticks,
+                                   void (*func) (alt_stack_report* report),
+                                   void* context);
+
+/*
+ * alt_stack_report_stop() stops "report". A report that has already been
+ * queued is still made.
+ */
+
+extern void alt_stack_report_stop (alt_stack_report* report);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ALT_STACK_USAGE_H__ */
@@ -53,6 +53,13 @@ extern alt_timestamp_type alt_timestamp (void);
 
 extern alt_u32 alt_timestamp_freq (void);
 
+/*
+ * alt_timestamp_count() returns the count since the timestamp timer was
+ * started by alt_sys_init(), which alt_timestamp_start() does not reset.
+ */
+
+extern alt_timestamp_type alt_timestamp_count (void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,152 @@
+#ifndef __ALT_TLSF_H__
+#define __ALT_TLSF_H__
+
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2006 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+* Altera does not recommend, suggest or require that this reference design    *
+* file be used in conjunction or combination with any other product.          *
+******************************************************************************/
+
+
+#include <stddef.h>
+
+#include "alt_types.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/*
+ * A two-level segregated fit (TLSF) heap. Free blocks are kept on lists 
+ * indexed first by the power of two below their size, and then by 
+ * 2^ALT_TLSF_SL_LOG2 equal steps within it; two levels of bitmaps record 
+ * which lists are not empty. Allocating and freeing therefore take a 
+ * bounded number of steps whatever the state of the heap: a free block is
+ * found with two find-first-set operations, and a freed block is merged 
+ * with its neighbours at once.
+ *
+ * The heap is made of one or more regions. The first time it is used, it
+ * is given whatever of onchip_mem is not used by the linker (unless 
+ * ALT_TLSF_NO_ONCHIP is defined), and it then grows from alt_sbrk() in 
+ * steps of at least ALT_TLSF_GROW_BYTES as it needs to. Growth is the only
+ * time interrupts are disabled for longer than a few instructions.
+ *
+ * If the HAL is built with ALT_TLSF_MALLOC defined, malloc(), free(), 
+ * realloc(), calloc() and memalign() (and newlib's reentrant versions of 
+ * them) come from here rather than from newlib.
+ *
+ * Interrupt handlers may allocate and free. Rather than disable interrupts
+ * for the length of an operation, the heap is marked busy for its length:
+ * a free() from an interrupt handler that finds it busy is queued, and 
+ * done by the interrupted operation before it returns, but an allocation
+ * fails, returning NULL with errno set to EBUSY.
+ *
+ * Blocks are aligned to the size of a pointer, and cost that much again 
+ * in overhead.
+ */
+
+#ifndef ALT_TLSF_SL_LOG2
+#define ALT_TLSF_SL_LOG2 4
+#endif
+
+/* Blocks are smaller than 2^ALT_TLSF_FL_MAX bytes */
+
+#ifndef ALT_TLSF_FL_MAX
+#define ALT_TLSF_FL_MAX 24
+#endif
+
+#ifndef ALT_TLSF_GROW_BYTES
+#define ALT_TLSF_GROW_BYTES 4096
+#endif
+
+#define ALT_TLSF_ALIGN_LOG2 (sizeof (void*) == 8 ? 3 : 2)
+#define ALT_TLSF_FL_SHIFT   (ALT_TLSF_SL_LOG2 + ALT_TLSF_ALIGN_LOG2)
+#define ALT_TLSF_FL_COUNT   (ALT_TLSF_FL_MAX - ALT_TLSF_FL_SHIFT + 1)
+
+/*
+ * The statistics returned by alt_tlsf_stats(). hist[n] counts the free 
+ * blocks on the first level lists n: those of fewer than 
+ * 2^ALT_TLSF_FL_SHIFT bytes for n = 0, and those of 
+ * 2^(n + ALT_TLSF_FL_SHIFT - 1) bytes or more otherwise.
+ */
+
+typedef struct alt_tlsf_stats_s
+{
+  alt_u32 size;        /* Bytes in every region, less overheads */
+  alt_u32 live;        /* Bytes in allocated blocks */
+  alt_u32 peak;        /* The most that live has been */
+  alt_u32 free;        /* Bytes in free blocks */
+  alt_u32 largest;     /* Size of the largest free block */
+  alt_u32 regions;
+  alt_u32 allocs;      /* Allocations that succeeded */
+  alt_u32 failures;    /* Allocations that failed */
+  alt_u32 deferred;    /* Frees queued because the heap was busy */
+  alt_u32 hist[ALT_TLSF_FL_COUNT];
+} alt_tlsf_stats_t;
+
+extern void* alt_tlsf_malloc (size_t size);
+extern void  alt_tlsf_free (void* ptr);
+extern void* alt_tlsf_realloc (void* ptr, size_t size);
+extern void* alt_tlsf_memalign (size_t align, size_t size);
+
+/*
+ * alt_tlsf_usable_size() returns the number of bytes that may be used at
+ * "ptr", which is at least the number asked for.
+ */
+
+extern size_t alt_tlsf_usable_size (void* ptr);
+
+/*
+ * alt_tlsf_add_region() adds "size" bytes at "start" to the heap. It 
+ * returns 0, or -EINVAL if the region is too small or too large.
+ */
+
+extern int alt_tlsf_add_region (void* start, size_t size);
+
+/*
+ * alt_tlsf_stats() fills in "stats". Finding the largest free block takes
+ * a walk of one free list; the rest is kept as the heap is used.
+ */
+
+extern void alt_tlsf_stats (alt_tlsf_stats_t* stats);
+
+/*
+ * alt_tlsf_check() walks every region, checking that the blocks and free
+ * lists agree, and returns 0 if they do or -EFAULT if not. It is meant for
+ * debugging, and takes time in proportion to the number of blocks.
+ */
+
+extern int alt_tlsf_check (void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ALT_TLSF_H__ */
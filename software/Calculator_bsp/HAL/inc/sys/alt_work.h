@@ -0,0 +1,138 @@
+#ifndef __ALT_WORK_H__
+#define __ALT_WORK_H__
+
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2006 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+* Altera does not recommend, suggest or require that this reference design    *
+* file be used in conjunction or combination with any other product.          *
+******************************************************************************/
+
+
+#include <errno.h>
+
+#include "alt_types.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/*
+ * Deferred work. An interrupt handler or alarm callback that has a lot to
+ * do can instead queue an alt_work item, whose function is then called in
+ * thread context, with interrupts enabled, the next time alt_work_run() 
+ * is called: from the application's main loop, or from a driver that is
+ * waiting for its own deferred work to be done.
+ *
+ * There is one queue per priority, from 0 (the highest) to 
+ * ALT_WORK_PRIORITIES - 1. alt_work_run() always runs the first item of the
+ * highest priority queue that is not empty. Only the interrupt side adds
+ * to a queue, and only alt_work_run() removes from it, so no lock is held
+ * while items are run.
+ *
+ * An item is only ever queued once: queuing it again before it has been 
+ * run does nothing, so an item stands for "there is work to do" rather 
+ * than for any one event, and its function must do all that there is.
+ * It is taken off the queue before its function is called, so it may be
+ * queued again while the function runs.
+ *
+ * Drivers defer their interrupt time work in this way if ALT_DEFERRED_WORK
+ * is defined, and otherwise do it in the interrupt handler as before.
+ */
+
+#ifndef ALT_WORK_PRIORITIES
+#define ALT_WORK_PRIORITIES 4
+#endif
+
+/* The number of items each queue holds. Must be a power of two. */
+
+#ifndef ALT_WORK_QUEUE_LEN
+#define ALT_WORK_QUEUE_LEN 8
+#endif
+
+typedef struct alt_work_s alt_work;
+
+struct alt_work_s
+{
+  void          (*func) (void* context);
+  void*         context;
+  alt_u8        priority;
+  volatile alt_u8 pending;
+};
+
+/*
+ * alt_work_init() sets up "work" to call "func" with "context" when it is
+ * run, from the queue for "priority".
+ */
+
+static ALT_INLINE void ALT_ALWAYS_INLINE alt_work_init (alt_work* work,
+                                                        void (*func) (void*),
+                                                        void* context,
+                                                        alt_u32 priority)
+{
+  work->func     = func;
+  work->context  = context;
+  work->priority = priority < ALT_WORK_PRIORITIES ? priority : 
+                                                    ALT_WORK_PRIORITIES - 1;
+  work->pending  = 0;
+}
+
+/*
+ * alt_work_queue() queues "work" to be run, unless it is already queued. 
+ * It may be called from interrupt handlers, alarm callbacks and thread 
+ * context. It returns 0 if the work is queued, or -ENOSPC if its queue is 
+ * full, in which case the caller should do the work itself.
+ */
+
+extern int alt_work_queue (alt_work* work);
+
+/*
+ * alt_work_run() runs queued work until every queue is empty, and returns
+ * the number of items that were run. It must only be called from thread 
+ * context, and returns 0 at once if it is called from a work function.
+ */
+
+extern int alt_work_run (void);
+
+/*
+ * ALT_WORK_IDLE() is used by drivers while they wait for something that 
+ * may have been deferred.
+ */
+
+#ifdef ALT_DEFERRED_WORK
+#define ALT_WORK_IDLE() alt_work_run ()
+#else
+#define ALT_WORK_IDLE()
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ALT_WORK_H__ */
@@ -0,0 +1,74 @@
+#ifndef __UIO_H__
+#define __UIO_H__
+
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2004 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+* Altera does not recommend, suggest or require that this reference design    *
+* file be used in conjunction or combination with any other product.          *
+******************************************************************************/
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/*
+ * Scatter-gather write. writev() writes the iovcnt buffers described by iov
+ * to the file descriptor fd, in order, as if they had been concatenated and
+ * passed to a single write() call.
+ *
+ * Drivers that provide a writev() entry point in their alt_dev structure
+ * receive the whole vector at once, so that the device is locked and
+ * flushed once per call. For other devices the buffers are passed to the
+ * driver's write() function one at a time.
+ *
+ * This function is equivalent to the standard Posix writev() call.
+ */
+
+struct iovec
+{
+  void*  iov_base;
+  size_t iov_len;
+};
+
+/* The largest vector accepted by writev() */
+
+#ifndef IOV_MAX
+#define IOV_MAX 16
+#endif
+
+extern int writev (int fd, const struct iovec* iov, int iovcnt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UIO_H__ */
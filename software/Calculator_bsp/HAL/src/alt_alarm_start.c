@@ -48,6 +48,44 @@
 #include "sys/alt_alarm.h"
 #include "sys/alt_irq.h"
 
+/*
+ * alt_alarm_enqueue() files an alarm in the level of the timer wheel that
+ * corresponds to the number of ticks until it expires, in the slot selected 
+ * by that level's bits of its expiry time. 
+ *
+ * The number of ticks is 64 bits wide: an alarm started for 0xffffffff 
+ * ticks is 2^32 ticks away. An alarm beyond the reach of the top level is
+ * filed there in the slot before the current one, the last to come round,
+ * and is filed again from there when it does.
+ *
+ * This must be called with interrupts disabled.
+ */
+
+void alt_alarm_enqueue (alt_alarm* alarm)
+{
+  alt_u64 delta = alarm->time - _alt_nticks;
+  alt_u64 time  = alarm->time;
+  alt_u32 slot;
+  int     level = 0;
+
+  while ((delta >>= ALT_ALARM_WHEEL_BITS) && 
+         (level < ALT_ALARM_WHEEL_LEVELS - 1))
+  {
+    time >>= ALT_ALARM_WHEEL_BITS;
+    level++;
+  }
+
+  if (delta)
+  {
+    time = (_alt_nticks >> (level * ALT_ALARM_WHEEL_BITS)) - 1;
+  }
+
+  slot = (alt_u32) time & ALT_ALARM_WHEEL_MASK;
+
+  alt_llist_insert (&alt_alarm_wheel[level][slot], &alarm->llist);
+  alt_alarm_wheel_map[level] |= 1 << slot;
+}
+
 /*
  * alt_alarm_start is called to register an alarm with the system. The 
  * "alarm" structure passed as an input argument does not need to be 
@@ -67,7 +105,8 @@
  *
  * The interval to be used for the next callback is the return
  * value from the callback function. A return value of zero indicates that the
- * alarm should be unregistered. 
+ * alarm should be unregistered. A callback that starts its own alarm again
+ * must call alt_alarm_stop() on it first.
  * 
  * alt_alarm_start() will fail if  the timer facility has not been enabled 
  * (i.e. there is no system clock). Failure is indicated by a negative return 
@@ -79,7 +118,7 @@ int alt_alarm_start (alt_alarm* alarm, alt_u32 nticks,
                      void* context)
 {
   alt_irq_context irq_context;
-  alt_u32 current_nticks = 0;
+  alt_u64 current_nticks = 0;
   
   if (alt_ticks_per_second ())
   {
@@ -90,25 +129,21 @@ int alt_alarm_start (alt_alarm* alarm, alt_u32 nticks,
  
       irq_context = alt_irq_disable_all ();
       
-      current_nticks = alt_nticks();
+      current_nticks = alt_nticks64();
       
       alarm->time = nticks + current_nticks + 1; 
-      
+    
+      alt_alarm_enqueue (alarm);
+
+#ifdef ALT_TICKLESS
       /* 
-       * If the desired alarm time causes a roll-over, set the rollover
-       * flag. This will prevent the subsequent tick event from causing
-       * an alarm too early.
+       * The wheel may lag alt_nticks() until the next alt_tick(), but since
+       * the alarm is filed relative to the wheel it will still be found.
+       * Bring the deadline forward if this alarm is now the first due.
        */
-      if(alarm->time < current_nticks)
-      {
-        alarm->rollover = 1;
-      }
-      else
-      {
-        alarm->rollover = 0;
-      }
-    
-      alt_llist_insert (&alt_alarm_list, &alarm->llist);
+      alt_sysclk_program (_alt_nticks + alt_alarm_next ());
+#endif
+
       alt_irq_enable_all (irq_context);
 
       return 0;
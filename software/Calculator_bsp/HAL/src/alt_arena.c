@@ -0,0 +1,137 @@
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2006 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+* Altera does not recommend, suggest or require that this reference design    *
+* file be used in conjunction or combination with any other product.          *
+******************************************************************************/
+
+
+/******************************************************************************
+*                                                                             *
+* THIS IS A LIBRARY READ-ONLY SOURCE FILE. DO NOT EDIT IT DIRECTLY.           *
+*                                                                             *
+* Overriding HAL Functions                                                    *
+*                                                                             *
+* To provide your own implementation of a HAL function, include the file in   *
+* your Nios II IDE application project. When building the executable, the     *
+* Nios II IDE finds your function first, and uses it in place of the HAL      *
+* version.                                                                    *
+*                                                                             *
+******************************************************************************/
+
+#include <string.h>
+
+#include "alt_types.h"
+#include "sys/alt_arena.h"
+
+void alt_arena_init (alt_arena* arena, void* mem, alt_u32 size)
+{
+  memset (arena, 0, sizeof (*arena));
+
+  arena->base = (char*) mem;
+  arena->size = size & ~(ALT_ARENA_ALIGN - 1);
+
+#ifdef ALT_ARENA_DEBUG
+  memset (arena->base, ALT_ARENA_POISON, arena->size);
+#endif
+}
+
+void* alt_arena_fail (alt_arena* arena)
+{
+  arena->failures++;
+  return NULL;
+}
+
+/*
+ * The allocation with ALT_ARENA_DEBUG. Only memory that has been used 
+ * before is checked: above alt_arena_peak() it may never have been 
+ * poisoned, if the arena was initialised statically.
+ */
+
+void* alt_arena_alloc_checked (alt_arena* arena, alt_u32 size)
+{
+  alt_u32 used = arena->used;
+  alt_u32 top  = alt_arena_peak (arena);
+  alt_u32 i;
+
+  if (size > arena->size - used)
+  {
+    return alt_arena_fail (arena);
+  }
+
+  size = (size + ALT_ARENA_ALIGN - 1) & ~(ALT_ARENA_ALIGN - 1);
+
+  for (i = used; i < used + size && i < top; i++)
+  {
+    if ((alt_u8) arena->base[i] != ALT_ARENA_POISON)
+    {
+      arena->errors++;
+      break;
+    }
+  }
+
+  arena->used = used + size;
+  if (arena->used > arena->high)
+  {
+    arena->high = arena->used;
+  }
+
+  return arena->base + used;
+}
+
+void alt_arena_rewind (alt_arena* arena, alt_u32 mark)
+{
+  if (mark > arena->used)
+  {
+#ifdef ALT_ARENA_DEBUG
+    arena->errors++;
+#endif
+    return;
+  }
+
+#ifdef ALT_ARENA_DEBUG
+  memset (arena->base + mark, ALT_ARENA_POISON, arena->used - mark);
+#endif
+
+  arena->used = mark;
+}
+
+alt_u32 alt_arena_reset (alt_arena* arena)
+{
+  alt_u32 high = arena->high;
+
+  alt_arena_rewind (arena, 0);
+
+  if (high > arena->peak)
+  {
+    arena->peak = high;
+  }
+  arena->high = 0;
+
+  return high;
+}
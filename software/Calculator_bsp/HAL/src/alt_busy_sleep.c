@@ -33,22 +33,105 @@
  *
  * Calibrated delay with no timer required
  * 
- * The ASM instructions in the routine are equivalent to 
+ * The ASM instructions in the delay loop are equivalent to 
  *
- * for (i=0;i<us*(ALT_CPU_FREQ/3);i++);
+ * for (i=loops;i>0;i--);
  * 
- * and takes three cycles each time around the loop
+ * and take three cycles each time around the loop, or nine on the tiny
+ * core. If the system has a timestamp timer the delay is timed with it 
+ * instead, once it has been started by alt_sys_init(); the loop is only
+ * used before then.
  *
+ * Every constant below is worked out by the preprocessor and compiler from
+ * system.h: a core with no divider must not spend longer dividing than the
+ * delay it was asked for (the LCD driver sleeps for 100us per character).
  */
 
-#include <limits.h>
-#include <string.h>
-
 #include "system.h"
 #include "alt_types.h"
+#include "sys/alt_timestamp.h"
 
 #include "priv/alt_busy_sleep.h"
 
+/*
+ * The number of cycles each time around the delay loop. Only the tiny core
+ * (Nios II/e) has no instruction cache, and it takes nine.
+ */
+
+#ifndef ALT_BUSY_SLEEP_CYCLES_PER_LOOP
+#if NIOS2_ICACHE_SIZE == 0
+#define ALT_BUSY_SLEEP_CYCLES_PER_LOOP 9
+#else
+#define ALT_BUSY_SLEEP_CYCLES_PER_LOOP 3
+#endif
+#endif
+
+/*
+ * The rate of the timestamp timer, or 0 if there is none.
+ */
+
+#ifndef ALT_BUSY_SLEEP_TIMESTAMP_FREQ
+#if ALT_TIMESTAMP_CLK_BASE != none_BASE
+#define ALT_BUSY_SLEEP_TIMESTAMP_FREQ ALT_TIMESTAMP_CLK_FREQ
+#else
+#define ALT_BUSY_SLEEP_TIMESTAMP_FREQ 0
+#endif
+#endif
+
+/*
+ * Delays are made in chunks of at most ALT_BUSY_SLEEP_CHUNK microseconds,
+ * for which ALT_BUSY_SLEEP_COUNT() gives the number of periods of "div"
+ * cycles at "freq" Hz, rounded up. It is an integer multiple of "us" plus
+ * a 16 bit fraction of it, and both are multiplications by constants, 
+ * which need neither a hardware multiplier nor more than 32 bits. 
+ */
+
+#define ALT_BUSY_SLEEP_CHUNK 65535
+
+#define ALT_BUSY_SLEEP_DIV(div) ((div) * 1000000ull)
+
+#define ALT_BUSY_SLEEP_WHOLE(freq, div) \
+  ((alt_u32) ((freq) / ALT_BUSY_SLEEP_DIV (div)))
+
+#define ALT_BUSY_SLEEP_FRAC(freq, div)                     \
+  ((alt_u32) (((((freq) % ALT_BUSY_SLEEP_DIV (div)) << 16) + \
+                ALT_BUSY_SLEEP_DIV (div) - 1) / ALT_BUSY_SLEEP_DIV (div)))
+
+#define ALT_BUSY_SLEEP_COUNT(us, freq, div)          \
+  ((us) * ALT_BUSY_SLEEP_WHOLE (freq, div) +         \
+   (((us) * ALT_BUSY_SLEEP_FRAC (freq, div) + 0xffff) >> 16))
+
+#define ALT_BUSY_SLEEP_LOOPS(us) \
+  ALT_BUSY_SLEEP_COUNT (us, ALT_CPU_FREQ, ALT_BUSY_SLEEP_CYCLES_PER_LOOP)
+
+#define ALT_BUSY_SLEEP_CYCLES(us) \
+  ALT_BUSY_SLEEP_COUNT (us, ALT_BUSY_SLEEP_TIMESTAMP_FREQ, 1)
+
+/*
+ * Go round the delay loop "loops" times (at least once).
+ *
+ * Do NOT Try to single step the asm statement below 
+ * (single step will never return)
+ * Step out of this function or set a breakpoint after the asm statements
+ */
+
+#ifndef ALT_BUSY_SLEEP_LOOP
+#define ALT_BUSY_SLEEP_LOOP(loops)            \
+  do                                          \
+  {                                           \
+    int __loops = (loops);                    \
+    __asm__ volatile (                        \
+      "\n0:"                                  \
+      "\n\taddi %0,%0, -1"                    \
+      "\n\tbgt %0,zero,0b"                    \
+      "\n1:"                                  \
+      "\n\t.pushsection .debug_alt_sim_info"  \
+      "\n\t.int 4, 0, 0b, 1b"                 \
+      "\n\t.popsection"                       \
+      : "+r" (__loops));                      \
+  } while (0)
+#endif
+
 unsigned int alt_busy_sleep (unsigned int us)
 {
 /*
@@ -57,77 +140,33 @@ unsigned int alt_busy_sleep (unsigned int us)
  * skipped to speed up simulation.
  */
 #ifndef ALT_SIM_OPTIMIZE
-  int i;
-  int big_loops;
-  alt_u32 cycles_per_loop;
-  
-  if (!strcmp(NIOS2_CPU_IMPLEMENTATION,"tiny"))
-  {
-    cycles_per_loop = 9;
-  }
-  else  
-  {
-    cycles_per_loop = 3;
-  }
-  
-
-  big_loops = us / (INT_MAX/
-  (ALT_CPU_FREQ/(cycles_per_loop * 1000000)));
+#if ALT_BUSY_SLEEP_TIMESTAMP_FREQ
+  alt_timestamp_type start;
+  alt_timestamp_type cycles = 0;
 
-  if (big_loops)
+  if (alt_timestamp_freq ())
   {
-    for(i=0;i<big_loops;i++)
+    start = alt_timestamp_count ();
+
+    for (; us > ALT_BUSY_SLEEP_CHUNK; us -= ALT_BUSY_SLEEP_CHUNK)
     {
-      /*
-      * Do NOT Try to single step the asm statement below 
-      * (single step will never return)
-      * Step out of this function or set a breakpoint after the asm statements
-      */
-      __asm__ volatile (
-        "\n0:"
-        "\n\taddi %0,%0, -1"
-        "\n\tbne %0,zero,0b"
-        "\n1:"
-        "\n\t.pushsection .debug_alt_sim_info"
-        "\n\t.int 4, 0, 0b, 1b"
-        "\n\t.popsection"
-        :: "r" (INT_MAX));
-      us -= (INT_MAX/(ALT_CPU_FREQ/
-      (cycles_per_loop * 1000000)));
+      cycles += ALT_BUSY_SLEEP_CYCLES (ALT_BUSY_SLEEP_CHUNK);
     }
+    cycles += ALT_BUSY_SLEEP_CYCLES (us);
+
+    while (alt_timestamp_count () - start < cycles)
+      ;
 
-    /*
-    * Do NOT Try to single step the asm statement below 
-    * (single step will never return)
-    * Step out of this function or set a breakpoint after the asm statements
-    */
-    __asm__ volatile (
-      "\n0:"
-      "\n\taddi %0,%0, -1"
-      "\n\tbne %0,zero,0b"
-      "\n1:"
-      "\n\t.pushsection .debug_alt_sim_info"
-      "\n\t.int 4, 0, 0b, 1b"
-      "\n\t.popsection"
-      :: "r" (us*(ALT_CPU_FREQ/(cycles_per_loop * 1000000))));
+    return 0;
   }
-  else
+#endif /* ALT_BUSY_SLEEP_TIMESTAMP_FREQ */
+
+  for (; us > ALT_BUSY_SLEEP_CHUNK; us -= ALT_BUSY_SLEEP_CHUNK)
   {
-    /*
-    * Do NOT Try to single step the asm statement below 
-    * (single step will never return)
-    * Step out of this function or set a breakpoint after the asm statements
-    */
-    __asm__ volatile (
-      "\n0:"
-      "\n\taddi %0,%0, -1"
-      "\n\tbgt %0,zero,0b"
-      "\n1:"
-      "\n\t.pushsection .debug_alt_sim_info"
-      "\n\t.int 4, 0, 0b, 1b"
-      "\n\t.popsection"
-      :: "r" (us*(ALT_CPU_FREQ/(cycles_per_loop * 1000000))));
+    ALT_BUSY_SLEEP_LOOP (ALT_BUSY_SLEEP_LOOPS (ALT_BUSY_SLEEP_CHUNK));
   }
+  ALT_BUSY_SLEEP_LOOP (ALT_BUSY_SLEEP_LOOPS (us));
+
 #endif /* #ifndef ALT_SIM_OPTIMIZE */
   return 0;
 }
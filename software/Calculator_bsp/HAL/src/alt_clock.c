@@ -0,0 +1,211 @@
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2006 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+* Altera does not recommend, suggest or require that this reference design    *
+* file be used in conjunction or combination with any other product.          *
+******************************************************************************/
+
+
+/******************************************************************************
+*                                                                             *
+* THIS IS A LIBRARY READ-ONLY SOURCE FILE. DO NOT EDIT IT DIRECTLY.           *
+*                                                                             *
+* Overriding HAL Functions                                                    *
+*                                                                             *
+* To provide your own implementation of a HAL function, include the file in   *
+* your Nios II IDE application project. When building the executable, the     *
+* Nios II IDE finds your function first, and uses it in place of the HAL      *
+* version.                                                                    *
+*                                                                             *
+******************************************************************************/
+
+#include <errno.h>
+
+#include "alt_types.h"
+#include "sys/alt_alarm.h"
+#include "sys/alt_timestamp.h"
+#include "sys/alt_clock.h"
+
+/*
+ * The fixed point constants for a clock running at "rate" Hz:
+ *
+ * recip   - (2^64 - 1) / rate. A count multiplied by this, divided by 2^64,
+ *           is the number of whole seconds, or one or two less.
+ * ns      - whole nanoseconds per count.
+ * ns_frac - the rest of a nanosecond per count, in units of 2^-32 ns.
+ *
+ * They are worked out the first time the clock is read at a new rate, 
+ * which only happens while alt_sys_init() is starting the clocks. Since 
+ * each depends on nothing but "rate", it does no harm if an interrupt 
+ * handler reading the clock at the same time works them out again. 
+ */
+
+typedef struct alt_clock_scale_s
+{
+  alt_u64 recip;
+  alt_u32 ns;
+  alt_u32 ns_frac;
+  alt_u32 rate;
+} alt_clock_scale;
+
+static alt_clock_scale alt_clock_sc = {0, 0, 0, 0};
+
+/*
+ * (2^64 - 1) / 10^9, for converting nanoseconds to other rates.
+ */
+
+#define ALT_CLOCK_NS_RECIP 18446744073ull
+
+#define ALT_NS (1000000000)
+
+/*
+ * The high 64 bits of the 128 bit product of "a" and "b", from four 32 bit
+ * multiplications.
+ */
+
+alt_u64 alt_clock_mulhi (alt_u64 a, alt_u64 b)
+{
+  alt_u64 al = a & 0xffffffff, ah = a >> 32;
+  alt_u64 bl = b & 0xffffffff, bh = b >> 32;
+  alt_u64 ll = al * bl;
+  alt_u64 lh = al * bh;
+  alt_u64 hl = ah * bl;
+  alt_u64 mid = (ll >> 32) + (lh & 0xffffffff) + (hl & 0xffffffff);
+
+  return ah * bh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+}
+
+/*
+ * Read the clock: return the count, and copy the constants for its rate to
+ * "sc". sc->rate is zero if there is no clock.
+ */
+
+static alt_u64 alt_clock_read (alt_clock_scale* sc)
+{
+  alt_u32 rate = alt_timestamp_freq ();
+  alt_u64 count;
+
+  if (rate)
+  {
+    count = alt_timestamp_count ();
+  }
+  else
+  {
+    rate  = alt_ticks_per_second ();
+    count = alt_nticks64 ();
+  }
+
+  if (rate && rate != alt_clock_sc.rate)
+  {
+    sc->recip   = ~(alt_u64) 0 / rate;
+    sc->ns      = ALT_NS / rate;
+    sc->ns_frac = (alt_u32) (((alt_u64) (ALT_NS % rate) << 32) / rate);
+    sc->rate    = rate;
+
+    alt_clock_sc = *sc;
+  }
+  else
+  {
+    *sc = alt_clock_sc;
+    sc->rate = rate;
+  }
+
+  return count;
+}
+
+/*
+ * alt_clock_gettime() splits the count into whole seconds and a remainder,
+ * correcting the estimate given by the reciprocal, and scales the 
+ * remainder to nanoseconds.
+ */
+
+int alt_clock_gettime (alt_timespec* tp)
+{
+  alt_clock_scale sc;
+  alt_u64         count = alt_clock_read (&sc);
+  alt_u64         secs;
+  alt_u32         rem;
+
+  if (!sc.rate)
+  {
+    return -ENOTSUP;
+  }
+
+  secs  = alt_clock_mulhi (count, sc.recip);
+  count -= secs * sc.rate;
+
+  while (count >= sc.rate)
+  {
+    secs++;
+    count -= sc.rate;
+  }
+
+  rem = count;
+
+  tp->tv_sec  = secs;
+  tp->tv_nsec = rem * sc.ns + (alt_u32) (((alt_u64) rem * sc.ns_frac) >> 32);
+
+  return 0;
+}
+
+/*
+ * alt_clock_ns() scales the whole count at once. Splitting it into 32 bit
+ * halves keeps the product of the count and the fraction in range.
+ */
+
+alt_u64 alt_clock_ns (void)
+{
+  alt_clock_scale sc;
+  alt_u64         count = alt_clock_read (&sc);
+
+  if (!sc.rate)
+  {
+    return 0;
+  }
+
+  return count * sc.ns + (count >> 32) * sc.ns_frac + 
+    (((count & 0xffffffff) * sc.ns_frac) >> 32);
+}
+
+/*
+ * alt_clock_to_rate() divides the nanoseconds, scaled to "rate", by 10^9
+ * with the reciprocal, which can leave the quotient one too small.
+ */
+
+alt_u64 alt_clock_to_rate (const alt_timespec* tp, alt_u32 rate)
+{
+  alt_u64 ns = (alt_u64) tp->tv_nsec * rate;
+  alt_u64 q  = alt_clock_mulhi (ns, ALT_CLOCK_NS_RECIP);
+
+  if (ns - q * ALT_NS >= ALT_NS)
+  {
+    q++;
+  }
+
+  return (alt_u64) tp->tv_sec * rate + q;
+}
@@ -130,6 +130,13 @@ ALT_SEM(alt_fd_list_lock)
 
 alt_32 alt_max_fd = -1;
 
+/*
+ * "alt_fd_used" marks the allocated entries of alt_fd_list. Standard in,
+ * standard out and standard error are always allocated.
+ */
+
+alt_u32 alt_fd_used[ALT_FD_WORDS] = { 0x7 };
+
 /*
  * "alt_fd_list" is the file descriptor pool. The first three entries in the
  * array are configured as standard in, standard out, and standard error. These
@@ -0,0 +1,139 @@
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2006 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+* Altera does not recommend, suggest or require that this reference design    *
+* file be used in conjunction or combination with any other product.          *
+******************************************************************************/
+
+
+/******************************************************************************
+*                                                                             *
+* THIS IS A LIBRARY READ-ONLY SOURCE FILE. DO NOT EDIT IT DIRECTLY.           *
+*                                                                             *
+* Overriding HAL Functions                                                    *
+*                                                                             *
+* To provide your own implementation of a HAL function, include the file in   *
+* your Nios II IDE application project. When building the executable, the     *
+* Nios II IDE finds your function first, and uses it in place of the HAL      *
+* version.                                                                    *
+*                                                                             *
+******************************************************************************/
+
+#include <stddef.h>
+#include <string.h>
+
+#include "sys/alt_dev.h"
+#include "priv/alt_file.h"
+
+#include "alt_types.h"
+
+/*
+ * The hash tables of registered devices and filesystems (see alt_file.h).
+ */
+
+alt_dev* alt_dev_hash[ALT_DEV_HASH_SIZE];
+alt_dev* alt_fs_hash[ALT_DEV_HASH_SIZE];
+
+/*
+ * alt_dev_null is put on alt_dev_list statically, without being registered,
+ * so it is hashed when the first device is registered or looked up.
+ */
+
+extern alt_dev alt_dev_null;
+
+static alt_u8 alt_dev_null_hashed = 0;
+
+static void alt_dev_hash_add (alt_dev* dev, alt_dev** table)
+{
+  const char* p;
+  alt_u32     hash = ALT_DEV_HASH_INIT;
+
+  for (p = dev->name; *p && !((p[0] == '/') && (p[1] == '\0')); p++)
+  {
+    hash = ALT_DEV_HASH_STEP(hash, *p);
+  }
+
+  dev->hash      = hash;
+  dev->hash_next = table[ALT_DEV_HASH_BUCKET(hash)];
+  table[ALT_DEV_HASH_BUCKET(hash)] = dev;
+}
+
+static void alt_dev_null_hash (void)
+{
+  if (!alt_dev_null_hashed)
+  {
+    alt_dev_null_hashed = 1;
+    alt_dev_hash_add (&alt_dev_null, alt_dev_hash);
+  }
+}
+
+/*
+ * alt_dev_hash_insert() is called by alt_dev_reg() and alt_fs_reg() to add
+ * "dev" to "table", once it is on the matching list. Like them, it must 
+ * only be called while single threaded.
+ */
+
+void alt_dev_hash_insert (alt_dev* dev, alt_dev** table)
+{
+  alt_dev_null_hash ();
+  alt_dev_hash_add (dev, table);
+}
+
+alt_dev* alt_dev_hash_find (const char* name)
+{
+  alt_dev*    next;
+  const char* p;
+  alt_u32     hash = ALT_DEV_HASH_INIT;
+
+  alt_dev_null_hash ();
+
+  for (p = name; *p; p++)
+  {
+    hash = ALT_DEV_HASH_STEP(hash, *p);
+  }
+
+  for (next = alt_dev_hash[ALT_DEV_HASH_BUCKET(hash)]; next; 
+       next = next->hash_next)
+  {
+    /* 
+     * memcmp() is used here rather than strcmp() in order to reduce the size
+     * of the executable.
+     */
+
+    if ((next->hash == hash) && !memcmp (next->name, name, p - name + 1))
+    {
+      /* match found */
+
+      return next;
+    }
+  }
+
+  /* No match found */
+
+  return NULL;
+}
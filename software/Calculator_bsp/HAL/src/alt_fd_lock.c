@@ -62,6 +62,9 @@
  * ioctl (fd, TIOCNXCL, NULL);
  *
  * The return value is zero for success, or negative in the case of failure.
+ *
+ * The descriptor is recorded as the device's exclusive owner, which is what
+ * open() checks.
  */
 
 int alt_fd_lock (alt_fd* fd)
@@ -71,7 +74,7 @@ int alt_fd_lock (alt_fd* fd)
 
   ALT_SEM_PEND(alt_fd_list_lock, 0);
 
-  for (i = 0; i < alt_max_fd; i++)
+  for (i = 0; i <= alt_max_fd; i++)
   {
     if ((&alt_fd_list[i] != fd) && (alt_fd_list[i].dev == fd->dev))
     {
@@ -80,6 +83,7 @@ int alt_fd_lock (alt_fd* fd)
     }
   }
   fd->fd_flags |= ALT_FD_EXCL;
+  fd->dev->excl = fd;
 
  alt_fd_lock_exit:
 
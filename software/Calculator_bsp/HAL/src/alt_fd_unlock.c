@@ -44,6 +44,7 @@
 ******************************************************************************/
 
 #include <errno.h>
+#include <stddef.h>
 
 #include "priv/alt_file.h"
 
@@ -65,5 +66,9 @@
 int alt_fd_unlock (alt_fd* fd)
 {
   fd->fd_flags &= ~ALT_FD_EXCL;
+  if (fd->dev->excl == fd)
+  {
+    fd->dev->excl = NULL;
+  }
   return 0;
 }
@@ -55,7 +55,8 @@
 /* 
  * alt_find_dev() is used by open() in order to locate a previously registered 
  * device with the name "name". The input argument "llist" is a pointer to the
- * head of the device list to search.
+ * head of the device list to search. The list of character devices, 
+ * alt_dev_list, is searched through its hash table instead.
  *
  * The return value is a pointer to the matching device, or NULL if there is
  * no match. 
@@ -69,6 +70,11 @@ alt_dev* alt_find_dev(const char* name, alt_llist* llist)
   alt_dev* next = (alt_dev*) llist->next;
   alt_32 len;
 
+  if (llist == &alt_dev_list)
+  {
+    return alt_dev_hash_find (name);
+  }
+
   len  = strlen(name) + 1;
 
   /*
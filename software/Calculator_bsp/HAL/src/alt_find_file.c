@@ -62,41 +62,72 @@
  * A match is considered to have been found if the filesystem name followed by
  * either '/' or '\0' is the prefix of the filename. For example the filename:
  * "/myfilesystem/junk.txt" would match: "/myfilesystem", but not: "/myfile". 
+ *
+ * Rather than trying each filesystem in turn, the hash of the filename is 
+ * taken a character at a time, and at each '/' or '\0' the filesystems 
+ * with the hash of the prefix so far are checked. If more than one matches,
+ * because mount points nest (e.g. "/mnt" and "/mnt/sd"), the one registered
+ * last wins, as when alt_fs_list was searched from the front.
  */
- 
-alt_dev* alt_find_file (const char* name)
+
+/*
+ * alt_fs_newer() returns non-zero if "a" is nearer the front of alt_fs_list,
+ * i.e. was registered after "b". It is only needed when mount points nest.
+ */
+
+static int alt_fs_newer (alt_dev* a, alt_dev* b)
 {
-  alt_dev* next = (alt_dev*) alt_fs_list.next;   
+  alt_dev* next = (alt_dev*) alt_fs_list.next;
 
-  alt_32 len;
+  while ((next != a) && (next != b))
+  {
+    next = (alt_dev*) next->llist.next;
+  }
+
+  return next == a;
+}
  
-  /*
-   * Check each list entry in turn, until a match is found, or we reach the
-   * end of the list (i.e. next winds up pointing back to the list head).
-   */ 
+alt_dev* alt_find_file (const char* name)
+{
+  alt_dev* next;
+  alt_dev* found = NULL;
+  alt_u32  hash  = ALT_DEV_HASH_INIT;
+  alt_32   len   = 0;
  
-  while (next != (alt_dev*) &alt_fs_list)
+  for (;;)
   {
-    len = strlen(next->name);
-    
-    if (next->name[len-1] == '/')
+    if ((name[len] == '/') || (name[len] == '\0'))
     {
-      len -= 1;
+      for (next = alt_fs_hash[ALT_DEV_HASH_BUCKET(hash)]; next; 
+           next = next->hash_next)
+      {
+        if ((next->hash == hash) && !memcmp (next->name, name, len) &&
+            ((next->name[len] == '\0') || 
+             ((next->name[len] == '/') && (next->name[len+1] == '\0'))))
+        {
+          /* 
+           * match found. The rest of the chain was registered earlier, so
+           * only a match on a longer prefix can take precedence over it.
+           */
+
+          if (!found || alt_fs_newer (next, found))
+          {
+            found = next;
+          }
+          break;
+        }
+      }
     }
 
-    if (((name[len] == '/') || (name[len] == '\0')) && 
-        !memcmp (next->name, name, len))
+    if (name[len] == '\0')
     {
-      /* match found */
-
-      return next;
+      break;
     }
-    next = (alt_dev*) next->llist.next;
+    hash = ALT_DEV_HASH_STEP(hash, name[len]);
+    len++;
   }
   
-  /* No match found */
-  
-  return NULL;     
+  return found;     
 }
 
 
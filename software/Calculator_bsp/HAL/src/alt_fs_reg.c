@@ -83,6 +83,7 @@ int alt_fs_reg (alt_dev* dev)
    */
 
   alt_llist_insert(&alt_fs_list, &dev->llist);
+  alt_dev_hash_insert(dev, alt_fs_hash);
 
   return 0;
 } 
@@ -62,11 +62,17 @@
  * The return value is the index of the file descriptor structure (i.e. 
  * the offset of the file descriptor within the file descriptor array). A
  * negative value indicates failure.
+ *
+ * The lowest free descriptor is found from the bitmap alt_fd_used, a word 
+ * of 32 descriptors at a time, so the time taken does not depend on how 
+ * many are in use.
  */
 
 int alt_get_fd (alt_dev* dev)
 {
-  alt_32 i;
+  alt_32  i;
+  alt_32  fd;
+  alt_u32 free;
   int rc = -EMFILE;
   
   /* 
@@ -77,8 +83,9 @@ int alt_get_fd (alt_dev* dev)
   ALT_SEM_PEND(alt_fd_list_lock, 0);
   
   /* 
-   * Search through the list of file descriptors, and allocate the first
-   * free descriptor that's found. 
+   * Find the first word with a free descriptor, and allocate its lowest.
+   * Bits past ALT_MAX_FD in the last word are never allocated, nor are 
+   * any past the first 32 of a word where alt_u32 is wider.
    *
    * If a free descriptor is found, then the value of "alt_max_fd" is 
    * updated accordingly. "alt_max_fd" is a 'highwater mark' which 
@@ -87,16 +94,22 @@ int alt_get_fd (alt_dev* dev)
    * therefore reduce contention on the alt_fd_list_lock semaphore. 
    */
 
-  for (i = 0; i < ALT_MAX_FD; i++)
+  for (i = 0; i < ALT_FD_WORDS; i++)
   {
-    if (!alt_fd_list[i].dev)
+    free = ~alt_fd_used[i] & 0xffffffff;
+    if (free)
     {
-      alt_fd_list[i].dev = dev;
-      if (i > alt_max_fd)
+      fd = i * 32 + __builtin_ctz (free);
+      if (fd < ALT_MAX_FD)
       {
-        alt_max_fd = i;
+        alt_fd_used[i] |= free & -free;
+        alt_fd_list[fd].dev = dev;
+        if (fd > alt_max_fd)
+        {
+          alt_max_fd = fd;
+        }
+        rc = fd;
       }
-      rc = i;
       goto alt_get_fd_exit;
     }
   }
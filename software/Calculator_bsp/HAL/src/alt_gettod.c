@@ -47,7 +47,7 @@
 #include <sys/times.h>
 #include <errno.h>
 
-#include "sys/alt_alarm.h"
+#include "sys/alt_clock.h"
 #include "alt_types.h"
 #include "os/alt_syscall.h"
 
@@ -68,9 +68,9 @@ struct timeval  alt_resettime = {0, 0};
 
 /*
  * gettimeofday() can be called to obtain a time structure which indicates the
- * current "wall clock" time. This is calculated using the elapsed number of
- * system clock ticks, and the value of "alt_resettime" and "alt_timezone" set
- * through the last call to settimeofday().  
+ * current "wall clock" time. This is calculated from the monotonic clock
+ * (see sys/alt_clock.h), and the value of "alt_resettime" and "alt_timezone"
+ * set through the last call to settimeofday().  
  *
  * Warning: if this function is called concurrently with a call to 
  * settimeofday(), the value returned by gettimeofday() will be unreliable. 
@@ -89,21 +89,29 @@ int ALT_GETTIMEOFDAY (struct timeval  *ptimeval, struct timezone *ptimezone)
 {
 #endif
   
-  alt_u32 nticks = alt_nticks (); 
-  alt_u32 tick_rate = alt_ticks_per_second ();
+  alt_timespec now;
+  alt_u32      usec;
 
   /* 
-   * Check to see if the system clock is running. This is indicated by a 
-   * non-zero system clock rate. If the system clock is not running, an error
-   * is generated and the contents of "ptimeval" and "ptimezone" are not
-   * updated.
+   * Check to see if the clock is running. If there is neither a timestamp
+   * timer nor a system clock, an error is generated and the contents of 
+   * "ptimeval" and "ptimezone" are not updated.
    */
 
-  if (tick_rate)
+  if (!alt_clock_gettime (&now))
   {
-    ptimeval->tv_sec  = alt_resettime.tv_sec  + nticks/tick_rate;
-    ptimeval->tv_usec = alt_resettime.tv_usec + 
-      ((nticks*(ALT_US/tick_rate))%ALT_US);
+    /* settimeofday() leaves alt_resettime.tv_usec below ALT_US */
+
+    usec = alt_resettime.tv_usec + alt_clock_ns_to_us (now.tv_nsec);
+
+    ptimeval->tv_sec  = alt_resettime.tv_sec + now.tv_sec;
+    ptimeval->tv_usec = usec;
+
+    if (usec >= ALT_US)
+    {
+      ptimeval->tv_sec++;
+      ptimeval->tv_usec = usec - ALT_US;
+    }
  
     if (ptimezone)
     { 
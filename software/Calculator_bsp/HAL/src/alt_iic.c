@@ -54,11 +54,18 @@
   * @API Type:              External
   * @param ic_id            Ignored.
   * @param irq              IRQ number
+  * @param flags            ALT_IRQ_FLAG_FAST for a fast handler, else NULL
   * @return                 0 if successful, else error (-1)
   */
 int alt_ic_isr_register(alt_u32 ic_id, alt_u32 irq, alt_isr_func isr, 
   void *isr_context, void *flags)
 {
+#ifdef ALT_IRQ_FAST_ENTRY
+    if (flags == ALT_IRQ_FLAG_FAST)
+    {
+        return alt_irq_register_fast(irq, isr_context, isr);
+    }
+#endif
     return alt_irq_register(irq, isr_context, isr);
 }  
                         
@@ -0,0 +1,158 @@
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2006 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+* Altera does not recommend, suggest or require that this reference design    *
+* file be used in conjunction or combination with any other product.          *
+******************************************************************************/
+
+
+/******************************************************************************
+*                                                                             *
+* THIS IS A LIBRARY READ-ONLY SOURCE FILE. DO NOT EDIT IT DIRECTLY.           *
+*                                                                             *
+* Overriding HAL Functions                                                    *
+*                                                                             *
+* To provide your own implementation of a HAL function, include the file in   *
+* your Nios II IDE application project. When building the executable, the     *
+* Nios II IDE finds your function first, and uses it in place of the HAL      *
+* version.                                                                    *
+*                                                                             *
+******************************************************************************/
+
+#include <errno.h>
+#include "system.h"
+
+/*
+ * Fast interrupt handlers work with the Nios II internal interrupt 
+ * controller (IIC) only.
+ */
+#ifndef NIOS2_EIC_PRESENT
+
+#include "sys/alt_irq.h"
+#include "priv/alt_legacy_irq.h"
+#include "priv/alt_irq_table.h"
+
+#include "alt_types.h"
+
+/*
+ * The fast entry code uses the interrupted stack, and et, so it is not
+ * used with a separate exception stack or with stack checking: fast 
+ * handlers are then registered as usual ones.
+ */
+
+#if !defined(ALT_EXCEPTION_STACK) && !defined(ALT_STACK_CHECK)
+
+/*
+ * Pull in the fast entry code, alt_irq_fast_entry.S.
+ */
+
+__asm__( "\n\t.globl alt_irq_fast_entry" );
+
+/*
+ * The fast handlers, in increasing IRQ number. alt_irq_fast_entry.S calls
+ * the first whose bit in "mask" is pending, so the layout of an entry 
+ * must match the offsets used there.
+ */
+
+typedef struct alt_irq_fast_s
+{
+  alt_u32      mask;
+  alt_isr_func handler;
+  void*        context;
+  alt_u32      id;
+} alt_irq_fast_t;
+
+alt_irq_fast_t alt_irq_fast_table[ALT_IRQ_FAST_MAX];
+alt_u32        alt_irq_fast_mask = 0;
+
+#endif /* !ALT_EXCEPTION_STACK && !ALT_STACK_CHECK */
+
+/*
+ * alt_irq_register_fast() registers a fast interrupt handler. See 
+ * sys/alt_irq.h.
+ *
+ * The handler is entered in alt_irq[] by alt_irq_register() as well, so 
+ * that alt_irq_handler() can call it if its interrupt becomes pending 
+ * while other handlers are running.
+ */
+
+int alt_irq_register_fast (alt_u32 id, void* context, alt_isr_func handler)
+{
+#if !defined(ALT_EXCEPTION_STACK) && !defined(ALT_STACK_CHECK)
+  alt_u32         mask;
+  alt_u32         n = 0;
+  alt_u32         i;
+  alt_irq_context status;
+  int             rc;
+
+  if (id >= ALT_NIRQ)
+  {
+    return -EINVAL;
+  }
+
+  status = alt_irq_disable_all ();
+
+  mask = handler ? (alt_irq_fast_mask | (1u << id)) : 
+                   (alt_irq_fast_mask & ~(1u << id));
+
+  for (i = 0; i < ALT_NIRQ; i++)
+  {
+    n += (mask >> i) & 1;
+  }
+
+  if (n > ALT_IRQ_FAST_MAX)
+  {
+    alt_irq_enable_all (status);
+    return -ENOSPC;
+  }
+
+  rc = alt_irq_register (id, context, handler);
+
+  n = 0;
+  for (i = 0; i < ALT_NIRQ; i++)
+  {
+    if (mask & (1u << i))
+    {
+      alt_irq_fast_table[n].mask    = 1u << i;
+      alt_irq_fast_table[n].handler = alt_irq[i].handler;
+      alt_irq_fast_table[n].context = alt_irq[i].context;
+      alt_irq_fast_table[n].id      = i;
+      n++;
+    }
+  }
+  alt_irq_fast_mask = mask;
+
+  alt_irq_enable_all (status);
+
+  return rc;
+#else
+  return alt_irq_register (id, context, handler);
+#endif /* !ALT_EXCEPTION_STACK && !ALT_STACK_CHECK */
+}
+
+#endif /* NIOS2_EIC_PRESENT */
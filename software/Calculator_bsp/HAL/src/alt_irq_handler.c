@@ -41,6 +41,7 @@
 #ifndef NIOS2_EIC_PRESENT
 
 #include "sys/alt_irq.h"
+#include "sys/alt_irq_stats.h"
 #include "os/alt_hooks.h"
 
 #include "alt_types.h"
@@ -62,6 +63,234 @@ struct ALT_IRQ_HANDLER
   void *context;
 } alt_irq[ALT_NIRQ];
 
+/*
+ * The number of times each interrupt handler has been called.
+ */
+
+alt_u32 alt_irq_count[ALT_NIRQ];
+
+/*
+ * The order in which pending interrupts are serviced, if it has been set by
+ * alt_irq_set_order(): alt_irq_order[n] is the interrupt serviced nth, and
+ * alt_irq_rank[] is its inverse. Until then interrupts are serviced in 
+ * increasing IRQ number, as the tables would say.
+ */
+
+static alt_u8  alt_irq_order[32];
+static alt_u8  alt_irq_rank[32];
+static alt_u32 alt_irq_ordered = 0;
+
+/*
+ * The priority level of each interrupt, as set by alt_irq_set_priority().
+ * Level 0 is the highest, and the default for every interrupt.
+ */
+
+static alt_u8  alt_irq_level[32];
+
+#ifdef ALT_IRQ_NESTED
+
+#ifdef ALT_EXCEPTION_STACK
+#error ALT_IRQ_NESTED cannot be used with a separate exception stack
+#endif
+
+#ifdef ALT_CI_INTERRUPT_VECTOR
+#error ALT_IRQ_NESTED cannot be used with the interrupt vector custom instruction
+#endif
+
+/*
+ * alt_irq_preempt[n] is the set of interrupts at a higher level than 
+ * interrupt n, and so allowed to interrupt its handler.
+ */
+
+static alt_u32 alt_irq_preempt[32];
+
+extern volatile alt_u32 alt_irq_active;
+extern volatile alt_u32 alt_priority_mask;
+
+#endif /* ALT_IRQ_NESTED */
+
+#ifdef ALT_IRQ_STATS
+
+#ifdef ALT_CI_INTERRUPT_VECTOR
+#error ALT_IRQ_STATS cannot be used with the interrupt vector custom instruction
+#endif
+
+extern alt_irq_stats alt_irq_stats_table[32];
+
+/*
+ * alt_irq_stats_add() adds "t" to the totals in "time". The bucket is
+ * one more than the number of the highest set bit in "t", found by a 
+ * binary search like that in alt_irq_ffs() below.
+ */
+
+static ALT_INLINE void ALT_ALWAYS_INLINE alt_irq_stats_add (alt_irq_time* time,
+                                                           alt_u32 t)
+{
+  alt_u32 n = 0;
+  alt_u32 x = t;
+  alt_u32 s;
+
+  s = (x > 0xffff) << 4; n += s; x >>= s;
+  s = (x > 0xff) << 3;   n += s; x >>= s;
+  s = (x > 0xf) << 2;    n += s; x >>= s;
+  s = (x > 0x3) << 1;    n += s; x >>= s;
+  s = (x > 0x1);         n += s; x >>= s;
+  n += x;
+
+  time->total += t;
+  if (t > time->max)
+  {
+    time->max = t;
+  }
+  time->hist[n < ALT_IRQ_STATS_BUCKETS ? n : ALT_IRQ_STATS_BUCKETS - 1]++;
+}
+
+#endif /* ALT_IRQ_STATS */
+
+#ifndef ALT_CI_INTERRUPT_VECTOR
+
+/*
+ * alt_irq_ffs() returns the number of the lowest set bit in "x", which must
+ * not be zero. The core has neither a find-first-set instruction nor (on 
+ * the smaller cores) a multiplier for the usual de Bruijn lookup, so this
+ * is a binary search in which each step is a compare and a shift, rather 
+ * than a branch.
+ */
+
+static ALT_INLINE alt_u32 ALT_ALWAYS_INLINE alt_irq_ffs (alt_u32 x)
+{
+  alt_u32 n = 0;
+  alt_u32 s;
+
+  s = ((x & 0xffff) == 0) << 4; n += s; x >>= s;
+  s = ((x & 0xff) == 0) << 3;   n += s; x >>= s;
+  s = ((x & 0xf) == 0) << 2;    n += s; x >>= s;
+  s = ((x & 0x3) == 0) << 1;    n += s; x >>= s;
+  s = ((x & 0x1) == 0);         n += s;
+
+  return n;
+}
+
+#endif /* ALT_CI_INTERRUPT_VECTOR */
+
+/*
+ * alt_irq_set_order() sets the order in which pending interrupts are 
+ * serviced. See sys/alt_irq.h.
+ */
+
+int alt_irq_set_order (const alt_u8* order, alt_u32 n)
+{
+  alt_u8          rank[32];
+  alt_u32         used    = 0;
+  alt_u32         ordered = 0;
+  alt_u32         i;
+  alt_irq_context status;
+
+  if (n > 32)
+  {
+    return -EINVAL;
+  }
+
+  for (i = 0; i < n; i++)
+  {
+    if (order[i] >= 32 || (used & (1u << order[i])))
+    {
+      return -EINVAL;
+    }
+    used |= 1u << order[i];
+    rank[order[i]] = i;
+  }
+
+  /* The interrupts that were not listed follow in increasing IRQ number */
+
+  for (i = 0; i < 32; i++)
+  {
+    if (!(used & (1u << i)))
+    {
+      rank[i] = n++;
+    }
+    ordered |= (rank[i] != i);
+  }
+
+  status = alt_irq_disable_all ();
+
+  for (i = 0; i < 32; i++)
+  {
+    alt_irq_rank[i]        = rank[i];
+    alt_irq_order[rank[i]] = i;
+  }
+  alt_irq_ordered = ordered;
+
+  alt_irq_enable_all (status);
+
+  return 0;
+}
+
+/*
+ * alt_irq_set_priority() sets the priority level of interrupt "id". See 
+ * sys/alt_irq.h.
+ */
+
+int alt_irq_set_priority (alt_u32 id, alt_u32 level)
+{
+  alt_u8          order[32];
+#ifdef ALT_IRQ_NESTED
+  alt_u32         preempt[32];
+  alt_irq_context status;
+#endif
+  alt_u32         i;
+  alt_u32         j;
+  alt_u8          irq;
+
+  if (id >= 32 || level > 255)
+  {
+    return -EINVAL;
+  }
+
+  alt_irq_level[id] = level;
+
+  /* 
+   * Sort the current service order by level. The sort is stable, so that
+   * within a level the order is unchanged. 
+   */
+
+  for (i = 0; i < 32; i++)
+  {
+    irq = alt_irq_ordered ? alt_irq_order[i] : i;
+
+    for (j = i; j > 0 && alt_irq_level[order[j - 1]] > alt_irq_level[irq]; j--)
+    {
+      order[j] = order[j - 1];
+    }
+    order[j] = irq;
+  }
+
+#ifdef ALT_IRQ_NESTED
+  for (i = 0; i < 32; i++)
+  {
+    preempt[i] = 0;
+    for (j = 0; j < 32; j++)
+    {
+      if (alt_irq_level[j] < alt_irq_level[i])
+      {
+        preempt[i] |= 1u << j;
+      }
+    }
+  }
+
+  status = alt_irq_disable_all ();
+
+  for (i = 0; i < 32; i++)
+  {
+    alt_irq_preempt[i] = preempt[i];
+  }
+
+  alt_irq_enable_all (status);
+#endif /* ALT_IRQ_NESTED */
+
+  return alt_irq_set_order (order, 32);
+}
+
 /*
  * alt_irq_handler() is called by the interrupt exception handler in order to 
  * process any outstanding interrupts. 
@@ -85,8 +314,17 @@ void alt_irq_handler (void)
   char*  alt_irq_base = (char*)alt_irq;
 #else
   alt_u32 active;
-  alt_u32 mask;
+  alt_u32 ranked;
   alt_u32 i;
+#ifdef ALT_IRQ_NESTED
+  alt_u32 mask;
+  alt_u32 nest;
+#endif
+#ifdef ALT_IRQ_STATS
+  alt_u32 entry;
+  alt_u32 start;
+  alt_u32 end;
+#endif
 #endif /* ALT_CI_INTERRUPT_VECTOR */
   
   /*
@@ -106,6 +344,7 @@ void alt_irq_handler (void)
   while ((offset = ALT_CI_INTERRUPT_VECTOR) >= 0) {
     struct ALT_IRQ_HANDLER* handler_entry = 
       (struct ALT_IRQ_HANDLER*)(alt_irq_base + offset);
+    alt_irq_count[offset >> 3]++;
 #ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
     handler_entry->handler(handler_entry->context);
 #else
@@ -115,45 +354,96 @@ void alt_irq_handler (void)
 #else /* ALT_CI_INTERRUPT_VECTOR */
   /* 
    * Obtain from the interrupt controller a bit list of pending interrupts,
-   * and then process the highest priority interrupt. This process loops, 
-   * loading the active interrupt list on each pass until alt_irq_pending() 
-   * return zero.
-   * 
-   * The maximum interrupt latency for the highest priority interrupt is
-   * reduced by finding out which interrupts are pending as late as possible.
-   * Consider the case where the high priority interupt is asserted during
-   * the interrupt entry sequence for a lower priority interrupt to see why
-   * this is the case.
+   * and call the handler for each of them, highest priority first. Only 
+   * then is the list read again, until alt_irq_pending() returns zero. 
+   * Handlers must therefore allow for being called when their interrupt 
+   * has already been cleared by an earlier handler in the same pass.
+   *
+   * If alt_irq_set_order() has been used, the bits are first moved to their
+   * positions in the service order, so that in either case the next 
+   * handler is given by the lowest set bit.
+   *
+   * With ALT_IRQ_NESTED, each handler is run with interrupts enabled if 
+   * there are interrupts at a higher level than its own: those at its own
+   * level or lower are masked in ienable until it returns. The nested call
+   * of alt_irq_handler() sees only the unmasked interrupts, since they are
+   * all that ipending reports.
+   *
+   * With ALT_IRQ_STATS, each handler is timed, and its statistics updated
+   * once interrupts are disabled again (see sys/alt_irq_stats.h).
    */
 
   active = alt_irq_pending ();
 
   do
   {
-    i = 0;
-    mask = 1;
+#ifdef ALT_IRQ_STATS
+    entry = ALT_IRQ_STATS_NOW ();
+#endif
 
-    /*
-     * Test each bit in turn looking for an active interrupt. Once one is 
-     * found, the interrupt handler asigned by a call to alt_irq_register() is
-     * called to clear the interrupt condition.
-     */
+    if (alt_irq_ordered)
+    {
+      ranked = 0;
+      do
+      {
+        ranked |= 1u << alt_irq_rank[alt_irq_ffs (active)];
+        active &= active - 1;
+      } while (active);
+      active = ranked;
+    }
 
     do
     {
-      if (active & mask)
-      { 
+      i = alt_irq_ffs (active);
+      active &= active - 1;
+
+      if (alt_irq_ordered)
+      {
+        i = alt_irq_order[i];
+      }
+
+      alt_irq_count[i]++;
+
+#ifdef ALT_IRQ_NESTED
+      mask = alt_priority_mask;
+      nest = alt_irq_preempt[i] & mask;
+      if (nest)
+      {
+        alt_priority_mask = nest;
+        NIOS2_WRITE_IENABLE (alt_irq_active & nest);
+        NIOS2_WRITE_STATUS (NIOS2_STATUS_PIE_MSK);
+      }
+#endif /* ALT_IRQ_NESTED */
+
+#ifdef ALT_IRQ_STATS
+      start = ALT_IRQ_STATS_NOW ();
+#endif
+
 #ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
-        alt_irq[i].handler(alt_irq[i].context); 
+      alt_irq[i].handler(alt_irq[i].context); 
 #else
-        alt_irq[i].handler(alt_irq[i].context, i); 
+      alt_irq[i].handler(alt_irq[i].context, i); 
 #endif
-        break;
+
+#ifdef ALT_IRQ_STATS
+      end = ALT_IRQ_STATS_NOW ();
+#endif
+
+#ifdef ALT_IRQ_NESTED
+      if (nest)
+      {
+        NIOS2_WRITE_STATUS (0);
+        alt_priority_mask = mask;
+        NIOS2_WRITE_IENABLE (alt_irq_active & mask);
       }
-      mask <<= 1;
-      i++;
+#endif /* ALT_IRQ_NESTED */
 
-    } while (1);
+#ifdef ALT_IRQ_STATS
+      alt_irq_stats_table[i].count++;
+      alt_irq_stats_add (&alt_irq_stats_table[i].latency, start - entry);
+      alt_irq_stats_add (&alt_irq_stats_table[i].duration, end - start);
+#endif
+    } while (active);
 
     active = alt_irq_pending ();
     
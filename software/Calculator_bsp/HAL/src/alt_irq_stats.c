@@ -0,0 +1,120 @@
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2006 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+* Altera does not recommend, suggest or require that this reference design    *
+* file be used in conjunction or combination with any other product.          *
+******************************************************************************/
+
+
+/******************************************************************************
+*                                                                             *
+* THIS IS A LIBRARY READ-ONLY SOURCE FILE. DO NOT EDIT IT DIRECTLY.           *
+*                                                                             *
+* Overriding HAL Functions                                                    *
+*                                                                             *
+* To provide your own implementation of a HAL function, include the file in   *
+* your Nios II IDE application project. When building the executable, the     *
+* Nios II IDE finds your function first, and uses it in place of the HAL      *
+* version.                                                                    *
+*                                                                             *
+******************************************************************************/
+
+#include <errno.h>
+#include <string.h>
+
+#include "system.h"
+#include "alt_types.h"
+#include "sys/alt_irq.h"
+#include "sys/alt_irq_stats.h"
+
+#ifdef ALT_IRQ_STATS
+
+/*
+ * The statistics for each interrupt. They are updated by alt_irq_handler()
+ * with interrupts disabled, so that a copy taken with interrupts disabled 
+ * is consistent.
+ */
+
+alt_irq_stats alt_irq_stats_table[32];
+
+int alt_irq_stats_get (alt_u32 id, alt_irq_stats* stats)
+{
+  alt_irq_context status;
+
+  if (id >= 32)
+  {
+    return -EINVAL;
+  }
+
+  status = alt_irq_disable_all ();
+  *stats = alt_irq_stats_table[id];
+  alt_irq_enable_all (status);
+
+  return 0;
+}
+
+/*
+ * Each interrupt is cleared separately, to keep the time for which 
+ * interrupts are disabled short.
+ */
+
+void alt_irq_stats_reset (void)
+{
+  alt_irq_context status;
+  alt_u32         i;
+
+  for (i = 0; i < 32; i++)
+  {
+    status = alt_irq_disable_all ();
+    memset (&alt_irq_stats_table[i], 0, sizeof (alt_irq_stats));
+    alt_irq_enable_all (status);
+  }
+}
+
+alt_u32 alt_irq_stats_freq (void)
+{
+  return ALT_IRQ_STATS_FREQ ();
+}
+
+#else /* ALT_IRQ_STATS */
+
+int alt_irq_stats_get (alt_u32 id, alt_irq_stats* stats)
+{
+  return -ENOSYS;
+}
+
+void alt_irq_stats_reset (void)
+{
+}
+
+alt_u32 alt_irq_stats_freq (void)
+{
+  return 0;
+}
+
+#endif /* ALT_IRQ_STATS */
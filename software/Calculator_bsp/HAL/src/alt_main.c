@@ -63,6 +63,7 @@
 #include "system.h"
 
 #include "sys/alt_log_printf.h"
+#include "sys/alt_stack_usage.h"
 
 extern void _do_ctors(void);
 extern void _do_dtors(void);
@@ -96,6 +97,15 @@ void alt_main (void)
 {
   int result;
 
+#ifdef ALT_STACK_PAINT
+  /* 
+   * Paint the stacks for their high water marks, while interrupts are
+   * still disabled and nothing else has used them.
+   */
+
+  alt_stack_paint ();
+#endif
+
   /* ALT LOG - please see HAL/sys/alt_log_printf.h for details */
   ALT_LOG_PRINT_BOOT("[alt_main.c] Entering alt_main, calling alt_irq_init.\r\n");
   /* Initialize the interrupt controller. */
@@ -76,8 +76,6 @@ extern alt_llist alt_dev_list;
 
 static int alt_file_locked (alt_fd* fd)
 {
-  alt_u32 i;
-
   /*
    * Mark the file descriptor as belonging to a device.
    */
@@ -85,18 +83,13 @@ static int alt_file_locked (alt_fd* fd)
   fd->fd_flags |= ALT_FD_DEV;
 
   /*
-   * Loop through all current file descriptors searching for one that's locked
-   * for exclusive access. If a match is found, generate an error.
+   * A device that is locked for exclusive access records the file descriptor
+   * that holds the lock. If it is another one, generate an error.
    */
 
-  for (i = 0; i <= alt_max_fd; i++)
+  if (fd->dev->excl && (fd->dev->excl != fd))
   {
-    if ((alt_fd_list[i].dev == fd->dev) &&
-        (alt_fd_list[i].fd_flags & ALT_FD_EXCL) &&
-        (&alt_fd_list[i] != fd))
-    {
-      return -EACCES;
-    }
+    return -EACCES;
   }
   
   /* The device is not locked */
@@ -0,0 +1,81 @@
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2006 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+* Altera does not recommend, suggest or require that this reference design    *
+* file be used in conjunction or combination with any other product.          *
+******************************************************************************/
+
+
+/******************************************************************************
+*                                                                             *
+* THIS IS A LIBRARY READ-ONLY SOURCE FILE. DO NOT EDIT IT DIRECTLY.           *
+*                                                                             *
+* Overriding HAL Functions                                                    *
+*                                                                             *
+* To provide your own implementation of a HAL function, include the file in   *
+* your Nios II IDE application project. When building the executable, the     *
+* Nios II IDE finds your function first, and uses it in place of the HAL      *
+* version.                                                                    *
+*                                                                             *
+******************************************************************************/
+
+#include <string.h>
+
+#include "alt_types.h"
+#include "sys/alt_cache.h"
+#include "sys/alt_overlay.h"
+
+alt_overlay* alt_overlay_resident;
+alt_overlay* alt_overlay_list;
+
+/*
+ * alt_overlay_load() copies "overlay" from its image in SDRAM into the 
+ * overlay window, over whichever overlay was there. It is called by 
+ * alt_overlay_enter() when the overlay is not resident.
+ */
+
+void alt_overlay_load (alt_overlay* overlay)
+{
+  alt_u32 size = alt_overlay_size (overlay);
+
+  if (overlay->loads++ == 0)
+  {
+    overlay->next    = alt_overlay_list;
+    alt_overlay_list = overlay;
+  }
+
+  /* Nothing is resident while the window is half written */
+
+  alt_overlay_resident = NULL;
+
+  memcpy (__alt_overlay_start, overlay->image, size);
+  alt_dcache_flush (__alt_overlay_start, size);
+  alt_icache_flush (__alt_overlay_start, size);
+
+  alt_overlay_resident = overlay;
+}
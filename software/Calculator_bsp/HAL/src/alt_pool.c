@@ -0,0 +1,120 @@
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2006 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+* Altera does not recommend, suggest or require that this reference design    *
+* file be used in conjunction or combination with any other product.          *
+******************************************************************************/
+
+
+/******************************************************************************
+*                                                                             *
+* THIS IS A LIBRARY READ-ONLY SOURCE FILE. DO NOT EDIT IT DIRECTLY.           *
+*                                                                             *
+* Overriding HAL Functions                                                    *
+*                                                                             *
+* To provide your own implementation of a HAL function, include the file in   *
+* your Nios II IDE application project. When building the executable, the     *
+* Nios II IDE finds your function first, and uses it in place of the HAL      *
+* version.                                                                    *
+*                                                                             *
+******************************************************************************/
+
+#include <stddef.h>
+
+#include "alt_types.h"
+#include "sys/alt_irq.h"
+#include "sys/alt_pool.h"
+
+/*
+ * The tiny core has no atomic read-modify-write instructions, so instead 
+ * interrupts are disabled around each push and pop: a dozen instructions 
+ * at most, about as long as an interrupt handler's register save.
+ *
+ * Objects are taken from the pool's array in order the first time, so 
+ * that the array needs no setting up, and from the free list after that.
+ */
+
+void* alt_pool_alloc (alt_pool* pool)
+{
+  alt_irq_context status;
+  void*           obj;
+
+  status = alt_irq_disable_all ();
+
+  obj = pool->free;
+  if (obj)
+  {
+    pool->free = *(void**) obj;
+  }
+  else if (pool->fresh < pool->end)
+  {
+    obj          = pool->fresh;
+    pool->fresh += pool->size;
+  }
+
+  if (obj)
+  {
+    if (++pool->used > pool->peak)
+    {
+      pool->peak = pool->used;
+    }
+  }
+  else
+  {
+    pool->failures++;
+  }
+
+  alt_irq_enable_all (status);
+
+  return obj;
+}
+
+void alt_pool_free (alt_pool* pool, void* obj)
+{
+  alt_irq_context status;
+
+  if (obj)
+  {
+    status = alt_irq_disable_all ();
+
+    *(void**) obj = pool->free;
+    pool->free    = obj;
+    pool->used--;
+
+    alt_irq_enable_all (status);
+  }
+}
+
+void alt_pool_reset_peak (alt_pool* pool)
+{
+  alt_irq_context status;
+
+  status     = alt_irq_disable_all ();
+  pool->peak = pool->used;
+  alt_irq_enable_all (status);
+}
@@ -43,6 +43,8 @@
 *                                                                             *
 ******************************************************************************/
 
+#include <stddef.h>
+
 #include "sys/alt_dev.h"
 #include "priv/alt_file.h"
 
@@ -52,14 +54,27 @@
  * 
  * File descriptors correcponding to standard in, standard out and standard 
  * error cannont be released backed to the pool. They are always reserved.
+ *
+ * A descriptor that held its device locked for exclusive access releases 
+ * the lock.
  */
 
 void alt_release_fd (int fd)
 {
   if (fd > 2)
   {
+    ALT_SEM_PEND(alt_fd_list_lock, 0);
+
+    if (alt_fd_list[fd].dev && 
+        (alt_fd_list[fd].dev->excl == &alt_fd_list[fd]))
+    {
+      alt_fd_list[fd].dev->excl = NULL;
+    }
     alt_fd_list[fd].fd_flags = 0;
     alt_fd_list[fd].dev      = 0;
+    alt_fd_used[fd / 32]    &= ~(1u << (fd % 32));
+
+    ALT_SEM_POST(alt_fd_list_lock);
   }
 }
 
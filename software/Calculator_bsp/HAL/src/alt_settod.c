@@ -47,7 +47,7 @@
 #include <sys/times.h>
 
 #include "sys/alt_errno.h"
-#include "sys/alt_alarm.h"
+#include "sys/alt_clock.h"
 #include "os/alt_syscall.h"
 
 /*
@@ -85,16 +85,26 @@ extern struct timeval  alt_resettime;
 int ALT_SETTIMEOFDAY (const struct timeval  *t,
                       const struct timezone *tz)
 {
-  alt_u32 nticks    = alt_nticks ();
-  alt_u32 tick_rate = alt_ticks_per_second ();
+  alt_timespec now;
+  long         usec;
 
-  /* If there is a system clock available, update the current time */
+  /* 
+   * If there is a clock available, update the current time. The offset is
+   * kept with tv_usec between 0 and ALT_US, as gettimeofday() expects.
+   */
 
-  if (tick_rate)
+  if (!alt_clock_gettime (&now))
   {
-    alt_resettime.tv_sec  = t->tv_sec - nticks/tick_rate;
-    alt_resettime.tv_usec = t->tv_usec - 
-      ((nticks*(ALT_US/tick_rate))%ALT_US);
+    usec = t->tv_usec - (long) alt_clock_ns_to_us (now.tv_nsec);
+
+    alt_resettime.tv_sec  = t->tv_sec - now.tv_sec;
+    alt_resettime.tv_usec = usec;
+
+    if (usec < 0)
+    {
+      alt_resettime.tv_sec--;
+      alt_resettime.tv_usec = usec + ALT_US;
+    }
 
     alt_timezone.tz_minuteswest = tz->tz_minuteswest;
     alt_timezone.tz_dsttime     = tz->tz_dsttime;
@@ -102,7 +112,7 @@ int ALT_SETTIMEOFDAY (const struct timeval  *t,
     return 0;
   }
   
-  /* There's no system clock available */
+  /* There's no clock available */
 
   ALT_ERRNO = ENOSYS;
   return -1;
@@ -0,0 +1,149 @@
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2006 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+* Altera does not recommend, suggest or require that this reference design    *
+* file be used in conjunction or combination with any other product.          *
+******************************************************************************/
+
+
+/******************************************************************************
+*                                                                             *
+* THIS IS A LIBRARY READ-ONLY SOURCE FILE. DO NOT EDIT IT DIRECTLY.           *
+*                                                                             *
+* Overriding HAL Functions                                                    *
+*                                                                             *
+* To provide your own implementation of a HAL function, include the file in   *
+* your Nios II IDE application project. When building the executable, the     *
+* Nios II IDE finds your function first, and uses it in place of the HAL      *
+* version.                                                                    *
+*                                                                             *
+******************************************************************************/
+
+#include <string.h>
+
+#include "alt_types.h"
+#include "sys/alt_spcache.h"
+
+/*
+ * alt_spcache_init() is called by the constructor of ALT_SPCACHE_DEFINE().
+ */
+
+void alt_spcache_init (alt_spcache* cache, const void* table, alt_u32 size,
+                       char* data, alt_u32* tags, alt_u8* victim,
+                       alt_u32 block, alt_u32 sets, alt_u32 ways)
+{
+  cache->table  = table;
+  cache->size   = size;
+  cache->data   = data;
+  cache->tags   = tags;
+  cache->victim = victim;
+  cache->block  = block;
+  cache->shift  = __builtin_ctz (block);
+  cache->sets   = sets;
+  cache->ways   = ways;
+  cache->hits   = 0;
+  cache->misses = 0;
+
+  alt_spcache_invalidate (cache);
+}
+
+void alt_spcache_invalidate (alt_spcache* cache)
+{
+  memset (cache->tags, 0xff, cache->sets * cache->ways * sizeof (alt_u32));
+  if (cache->ways == 2)
+  {
+    memset (cache->victim, 0, cache->sets);
+  }
+}
+
+/*
+ * alt_spcache_fill() is called by alt_spcache_lookup() on a miss. It 
+ * copies the block holding "offset" into the set's victim line, and 
+ * returns the address of the copy of "offset". The last block of the 
+ * table may be short.
+ */
+
+const void* alt_spcache_fill (alt_spcache* cache, alt_u32 offset)
+{
+  alt_u32 block = offset >> cache->shift;
+  alt_u32 set   = block & (cache->sets - 1);
+  alt_u32 line  = set * cache->ways;
+  alt_u32 start = offset & ~(cache->block - 1);
+  alt_u32 len   = cache->block;
+  char*   copy;
+
+  /* Not in the table: read it where it is */
+
+  if (offset >= cache->size)
+  {
+    return cache->table + offset;
+  }
+
+  if (cache->ways == 2)
+  {
+    line += cache->victim[set];
+    cache->victim[set] = !cache->victim[set];
+  }
+  copy = cache->data + (line << cache->shift);
+
+  if (len > cache->size - start)
+  {
+    len = cache->size - start;
+  }
+  memcpy (copy, cache->table + start, len);
+
+  cache->tags[line] = start;
+  cache->misses++;
+
+  return copy + (offset - start);
+}
+
+/*
+ * Each lookup would otherwise have read its words from SDRAM. A miss 
+ * reads the whole block from SDRAM instead, and copies it.
+ */
+
+alt_64 alt_spcache_saved (alt_spcache* cache, alt_u32 reads)
+{
+  alt_u32 lookups     = cache->hits + cache->misses;
+  alt_u32 block_words = (cache->block + 3) / 4;
+  alt_u32 cost        = ALT_SPCACHE_LOOKUP_COST;
+  alt_64  saved;
+
+  if (cache->ways == 2)
+  {
+    cost += ALT_SPCACHE_WAY_COST;
+  }
+
+  saved  = (alt_64) lookups * reads * ALT_SPCACHE_SDRAM_WAIT;
+  saved -= (alt_64) lookups * cost;
+  saved -= (alt_64) cache->misses * block_words *
+           (ALT_SPCACHE_SDRAM_WAIT + ALT_SPCACHE_COPY_COST);
+
+  return saved;
+}
@@ -0,0 +1,262 @@
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2006 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+* Altera does not recommend, suggest or require that this reference design    *
+* file be used in conjunction or combination with any other product.          *
+******************************************************************************/
+
+
+/******************************************************************************
+*                                                                             *
+* THIS IS A LIBRARY READ-ONLY SOURCE FILE. DO NOT EDIT IT DIRECTLY.           *
+*                                                                             *
+* Overriding HAL Functions                                                    *
+*                                                                             *
+* To provide your own implementation of a HAL function, include the file in   *
+* your Nios II IDE application project. When building the executable, the     *
+* Nios II IDE finds your function first, and uses it in place of the HAL      *
+* version.                                                                    *
+*                                                                             *
+******************************************************************************/
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "system.h"
+#include "alt_types.h"
+#include "sys/alt_alarm.h"
+#include "sys/alt_stack.h"
+#include "sys/alt_stack_usage.h"
+#include "sys/alt_work.h"
+#include "os/alt_syscall.h"
+
+#ifdef ALT_STACK_PAINT
+
+extern char __alt_stack_pointer[];         /* set by the linker */
+extern char __alt_heap_start[];            /* set by the linker */
+
+#ifdef ALT_EXCEPTION_STACK
+extern char __alt_exception_stack_limit[]; /* set by the linker */
+#endif
+
+#ifdef ALT_INTERRUPT_STACK
+extern char __alt_interrupt_stack_pointer[];
+extern char __alt_interrupt_stack_limit[];
+#endif
+
+/*
+ * A painted stack. Every word from "bottom" to "mark" is known to still
+ * hold ALT_STACK_PAINT_VALUE, so a scan need go no further than "mark", 
+ * and "mark" only ever moves down. A stack with no "top" is not 
+ * configured.
+ */
+
+typedef struct alt_stack_region_s
+{
+  alt_u32* bottom;
+  alt_u32* mark;
+  alt_u32* top;
+} alt_stack_region;
+
+static alt_stack_region alt_stack_regions[ALT_STACK_COUNT];
+
+/* Paint the whole of a stack that is not in use */
+
+static void alt_stack_fill (alt_stack_region* region, char* bottom, char* top)
+{
+  alt_u32* p;
+
+  region->bottom = (alt_u32*) (((alt_u32) bottom + 3) & ~3);
+  region->mark   = (alt_u32*) ((alt_u32) top & ~3);
+  region->top    = region->mark;
+
+  for (p = region->bottom; p < region->mark; p++)
+  {
+    *p = ALT_STACK_PAINT_VALUE;
+  }
+}
+
+/*
+ * The main stack is painted last, in line: anything called after it had
+ * been painted would leave its frame behind as stack that seems used.
+ */
+
+void alt_stack_paint (void)
+{
+  alt_stack_region* region = &alt_stack_regions[ALT_STACK_MAIN];
+  alt_u32*          p;
+
+#ifdef ALT_EXCEPTION_STACK
+  alt_stack_fill (&alt_stack_regions[ALT_STACK_EXCEPTION],
+                  __alt_exception_stack_limit, __alt_exception_stack_pointer);
+#endif
+
+#ifdef ALT_INTERRUPT_STACK
+  alt_stack_fill (&alt_stack_regions[ALT_STACK_INTERRUPT],
+                  __alt_interrupt_stack_limit, __alt_interrupt_stack_pointer);
+#endif
+
+  region->top    = (alt_u32*) ((alt_u32) __alt_stack_pointer & ~3);
+  region->mark   = (alt_u32*) ((alt_u32) alt_stack_pointer () & ~3);
+  region->bottom = region->top - ALT_STACK_PAINT_BYTES / sizeof (alt_u32);
+
+  p = (alt_u32*) (((alt_u32) __alt_heap_start + 3) & ~3);
+  if (region->bottom < p)
+  {
+    region->bottom = p;
+  }
+
+  for (p = region->bottom; p < region->mark; p++)
+  {
+    *p = ALT_STACK_PAINT_VALUE;
+  }
+}
+
+/*
+ * The heap may since have grown into the painted part of the main stack,
+ * in which case the scan starts at the end of the heap instead.
+ */
+
+int alt_stack_usage_get (alt_u32 id, alt_stack_usage* usage)
+{
+  alt_stack_region* region;
+  alt_u32*          p;
+
+  if (id >= ALT_STACK_COUNT || !alt_stack_regions[id].top)
+  {
+    return -EINVAL;
+  }
+
+  region = &alt_stack_regions[id];
+  p      = region->bottom;
+
+  if (id == ALT_STACK_MAIN)
+  {
+    alt_u32* heap_end = (alt_u32*) ALT_SBRK (0);
+
+    if (p < heap_end)
+    {
+      p = heap_end;
+    }
+  }
+
+  while (p < region->mark && *p == ALT_STACK_PAINT_VALUE)
+  {
+    p++;
+  }
+  region->mark = p;
+
+  usage->size = (region->top - region->bottom) * sizeof (alt_u32);
+  usage->peak = (region->top - region->mark) * sizeof (alt_u32);
+
+  return 0;
+}
+
+/* Scan every stack, in thread context, and make the report */
+
+static void alt_stack_report_run (void* context)
+{
+  alt_stack_report* report = (alt_stack_report*) context;
+  alt_stack_usage   usage;
+  alt_u32           id;
+
+  report->grown = 0;
+
+  for (id = 0; id < ALT_STACK_COUNT; id++)
+  {
+    if (alt_stack_usage_get (id, &usage) == 0)
+    {
+      if (usage.peak > report->usage[id].peak)
+      {
+        report->grown |= 1 << id;
+      }
+      report->usage[id] = usage;
+    }
+  }
+
+  report->func (report);
+}
+
+static alt_u32 alt_stack_report_alarm (void* context)
+{
+  alt_stack_report* report = (alt_stack_report*) context;
+
+  alt_work_queue (&report->work);
+
+  return report->period;
+}
+
+int alt_stack_report_start (alt_stack_report* report, 
+                            alt_u32 nticks,
+                            void (*func) (alt_stack_report* report),
+                            void* context)
+{
+  memset (report->usage, 0, sizeof (report->usage));
+
+  report->period  = nticks ? nticks : 1;
+  report->func    = func;
+  report->context = context;
+  report->grown   = 0;
+
+  alt_work_init (&report->work, alt_stack_report_run, report, 
+                 ALT_WORK_PRIORITIES - 1);
+
+  return alt_alarm_start (&report->alarm, report->period, 
+                          alt_stack_report_alarm, report);
+}
+
+void alt_stack_report_stop (alt_stack_report* report)
+{
+  alt_alarm_stop (&report->alarm);
+}
+
+#else /* ALT_STACK_PAINT */
+
+void alt_stack_paint (void)
+{
+}
+
+int alt_stack_usage_get (alt_u32 id, alt_stack_usage* usage)
+{
+  return -ENOSYS;
+}
+
+int alt_stack_report_start (alt_stack_report* report, 
+                            alt_u32 nticks,
+                            void (*func) (alt_stack_report* report),
+                            void* context)
+{
+  return -ENOSYS;
+}
+
+void alt_stack_report_stop (alt_stack_report* report)
+{
+}
+
+#endif /* ALT_STACK_PAINT */
@@ -58,17 +58,36 @@ alt_u32 _alt_tick_rate = 0;
 
 /*
  * "_alt_nticks" is the number of system clock ticks that have elapsed since
- * reset. 
+ * reset. In a tickless system it is only brought up to date when alarms are
+ * processed; alt_nticks() asks the clock driver instead.
  */
 
-volatile alt_u32 _alt_nticks = 0;
+volatile alt_u64 _alt_nticks = 0;
 
 /*
- * "alt_alarm_list" is the head of a linked list of registered alarms. This is
- * initialised to be an empty list.
+ * "alt_alarm_wheel" holds the registered alarms. See priv/alt_alarm.h for a
+ * description of its layout. Each slot is the head of a linked list, 
+ * initialised to be empty by alt_alarm_wheel_init().
  */
 
-ALT_LLIST_HEAD(alt_alarm_list);
+alt_llist alt_alarm_wheel[ALT_ALARM_WHEEL_LEVELS][ALT_ALARM_WHEEL_SLOTS];
+alt_u32   alt_alarm_wheel_map[ALT_ALARM_WHEEL_LEVELS];
+
+void alt_alarm_wheel_init (void)
+{
+  int level;
+  int slot;
+
+  for (level = 0; level < ALT_ALARM_WHEEL_LEVELS; level++)
+  {
+    for (slot = 0; slot < ALT_ALARM_WHEEL_SLOTS; slot++)
+    {
+      alt_alarm_wheel[level][slot].next     = &alt_alarm_wheel[level][slot];
+      alt_alarm_wheel[level][slot].previous = &alt_alarm_wheel[level][slot];
+    }
+    alt_alarm_wheel_map[level] = 0;
+  }
+}
 
 /*
  * alt_alarm_stop() is called to remove an alarm from the list of registered 
@@ -86,77 +105,238 @@ void alt_alarm_stop (alt_alarm* alarm)
 }
 
 /*
- * alt_tick() is periodically called by the system clock driver in order to
- * process the registered list of alarms. Each alarm is registed with a
- * callback interval, and a callback function, "callback". 
+ * alt_alarm_step() advances the wheel by one tick and runs the alarms that
+ * are due on it.
  *
- * The return value of the callback function indicates how many ticks are to
- * elapse until the next callback. A return value of zero indicates that the
- * alarm should be deactivated. 
- * 
- * alt_tick() is expected to run at interrupt level.
+ * Only the alarms due on this tick are examined, plus, once every
+ * ALT_ALARM_WHEEL_SLOTS ticks, those which have come within range of a lower
+ * level of the wheel; so the cost of a tick does not depend on how many 
+ * alarms are registered.
  */
 
-void alt_tick (void)
+static void alt_alarm_step (void)
 {
-  alt_alarm* next;
-  alt_alarm* alarm = (alt_alarm*) alt_alarm_list.next;
-
+  alt_llist* slot;
+  alt_llist  expired;
+  alt_alarm* alarm;
+  alt_u64    now;
+  alt_u64    time;
   alt_u32    next_callback;
+  alt_u32    index;
+  int        level;
 
   /* update the tick counter */
 
-  _alt_nticks++;
+  now = ++_alt_nticks;
 
-  /* process the registered callbacks */
+  /* 
+   * For each level that has just wrapped, move the alarms from the current
+   * slot of the level above down the wheel.
+   */
 
-  while (alarm != (alt_alarm*) &alt_alarm_list)
+  for (level = 1, time = now; 
+       (level < ALT_ALARM_WHEEL_LEVELS) && 
+         !((alt_u32) time & ALT_ALARM_WHEEL_MASK);
+       level++)
   {
-    next = (alt_alarm*) alarm->llist.next;
-
-    /* 
-     * Upon the tick-counter rolling over it is safe to clear the 
-     * roll-over flag; once the flag is cleared this (or subsequnt)
-     * tick events are enabled to generate an alarm event. 
-     */
-    if ((alarm->rollover) && (_alt_nticks == 0))
+    time >>= ALT_ALARM_WHEEL_BITS;
+    index = (alt_u32) time & ALT_ALARM_WHEEL_MASK;
+    slot  = &alt_alarm_wheel[level][index];
+
+    while (slot->next != slot)
     {
-      alarm->rollover = 0;
+      alarm = (alt_alarm*) slot->next;
+      alt_llist_remove (&alarm->llist);
+      alt_alarm_enqueue (alarm);
     }
-    
-    /* if the alarm period has expired, make the callback */    
-    if ((alarm->time <= _alt_nticks) && (alarm->rollover == 0))
+    alt_alarm_wheel_map[level] &= ~(1 << index);
+  }
+
+  /* 
+   * Every alarm in the current level 0 slot is due now. Move them onto a
+   * private list first, so that any which are requeued for a multiple of
+   * ALT_ALARM_WHEEL_SLOTS ticks away are not run again.
+   */
+
+  index = (alt_u32) now & ALT_ALARM_WHEEL_MASK;
+  slot  = &alt_alarm_wheel[0][index];
+
+  if (slot->next != slot)
+  {
+    expired.next           = slot->next;
+    expired.previous       = slot->previous;
+    expired.next->previous = &expired;
+    expired.previous->next = &expired;
+    slot->next             = slot;
+    slot->previous         = slot;
+
+    alt_alarm_wheel_map[0] &= ~(1 << index);
+
+    while (expired.next != &expired)
     {
+      alarm = (alt_alarm*) expired.next;
+
       next_callback = alarm->callback (alarm->context);
 
-      /* deactivate the alarm if the return value is zero */
+      /* 
+       * Unless the callback has stopped the alarm itself (and perhaps then
+       * started it again), deactivate it if the return value is zero, or 
+       * else requeue it. The alarm is still on the expired list while its
+       * callback runs, so calling alt_alarm_start() on it without 
+       * alt_alarm_stop() first would link it into the wheel while it is 
+       * still linked here, and corrupt both lists.
+       */
 
-      if (next_callback == 0)
+      if (expired.next == &alarm->llist)
       {
-        alt_alarm_stop (alarm);
+        alt_llist_remove (&alarm->llist);
+
+        if (next_callback != 0)
+        {
+          alarm->time += next_callback;
+          alt_alarm_enqueue (alarm);
+        }
       }
-      else
+    }
+  }
+}
+
+#ifdef ALT_TICKLESS
+
+/*
+ * alt_alarm_next() returns the number of ticks from _alt_nticks to the next
+ * point at which the wheel has work to do: either the expiry of an alarm in
+ * level 0, or the start of the window of an occupied slot in a higher level,
+ * when its alarms must be moved down. The result is never zero, and never
+ * more than ALT_TICKLESS_IDLE, which is returned if no alarms are 
+ * registered.
+ *
+ * The occupancy bitmaps are only a hint (alt_alarm_stop() does not clear
+ * them), so any stale bits found on the way are cleared.
+ */
+
+alt_u32 alt_alarm_next (void)
+{
+  alt_u64 now  = _alt_nticks;
+  alt_u64 time = now;
+  alt_u32 next = ALT_TICKLESS_IDLE;
+  alt_u32 current;
+  alt_u32 index;
+  alt_u64 delta;
+  alt_u32 i;
+  int     level;
+  int     shift;
+
+  for (level = 0; level < ALT_ALARM_WHEEL_LEVELS; 
+       level++, time >>= ALT_ALARM_WHEEL_BITS)
+  {
+    shift   = level * ALT_ALARM_WHEEL_BITS;
+    current = (alt_u32) time;
+
+    /* Look at the slots in the order in which the wheel reaches them */
+
+    for (i = 1; 
+         (i <= ALT_ALARM_WHEEL_SLOTS) && alt_alarm_wheel_map[level]; 
+         i++)
+    {
+      index = (current + i) & ALT_ALARM_WHEEL_MASK;
+
+      if (alt_alarm_wheel_map[level] & (1 << index))
       {
-        alarm->time += next_callback;
-        
-        /* 
-         * If the desired alarm time causes a roll-over, set the rollover
-         * flag. This will prevent the subsequent tick event from causing
-         * an alarm too early.
-         */
-        if(alarm->time < _alt_nticks)
+        if (alt_alarm_wheel[level][index].next == 
+            &alt_alarm_wheel[level][index])
         {
-          alarm->rollover = 1;
+          alt_alarm_wheel_map[level] &= ~(1 << index);
+        }
+        else
+        {
+          /* 
+           * The start of the slot's window, relative to now. In the top
+           * level this can be 2^32 or more, so it is worked out in 64 bits
+           * and only used if it is below the current "next".
+           */
+          delta = ((alt_u64) i << shift) - (now & ((1 << shift) - 1));
+          if (delta < next)
+          {
+            next = (alt_u32) delta;
+          }
+          break;
         }
       }
     }
-    alarm = next;
   }
 
+  return next;
+}
+
+/*
+ * alt_alarm_advance() brings the wheel up to the tick "target", running any
+ * alarms due on the way. The ticks between one event and the next are 
+ * skipped over, since there is nothing to do for them.
+ */
+
+static void alt_alarm_advance (alt_u64 target)
+{
+  alt_u32 next;
+
+  while (_alt_nticks != target)
+  {
+    next = alt_alarm_next ();
+
+    /* Zero would move the wheel back a tick, and never reach "target" */
+
+    if (next == 0)
+    {
+      next = 1;
+    }
+
+    if (next > target - _alt_nticks)
+    {
+      _alt_nticks = target;
+    }
+    else
+    {
+      _alt_nticks += next - 1;
+      alt_alarm_step ();
+    }
+  }
+}
+
+#endif /* ALT_TICKLESS */
+
+/*
+ * alt_tick() is called by the system clock driver in order to process the
+ * registered alarms. Each alarm is registed with a callback interval, and a
+ * callback function, "callback". 
+ *
+ * The return value of the callback function indicates how many ticks are to
+ * elapse until the next callback. A return value of zero indicates that the
+ * alarm should be deactivated. 
+ *
+ * Normally alt_tick() is called periodically, once per tick. In a tickless
+ * system (ALT_TICKLESS defined) it is instead called when the deadline last
+ * passed to alt_sysclk_program() is reached, or at any time before: it
+ * catches up with alt_sysclk_now(), then programs the next deadline.
+ * 
+ * alt_tick() is expected to run at interrupt level.
+ */
+
+void alt_tick (void)
+{
+#ifdef ALT_TICKLESS
+
+  alt_alarm_advance (alt_sysclk_now ());
+  alt_sysclk_program (_alt_nticks + alt_alarm_next ());
+
+#else
+
+  alt_alarm_step ();
+
+#endif /* ALT_TICKLESS */
+
   /* 
    * Update the operating system specific timer facilities.
    */
 
   ALT_OS_TIME_TICK();
 }
-
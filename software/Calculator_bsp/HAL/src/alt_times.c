@@ -47,6 +47,7 @@
 
 #include "sys/alt_errno.h"
 #include "sys/alt_alarm.h"
+#include "sys/alt_clock.h"
 #include "os/alt_syscall.h"
 
 /*
@@ -58,21 +59,28 @@
  * The input structure is filled in with time accounting information. This 
  * implementation attributes all cpu time to the system.
  *
+ * The time is read from the monotonic clock (see sys/alt_clock.h), so that
+ * it agrees with gettimeofday().
+ *
  * ALT_TIMES is mapped onto the times() system call in alt_syscall.h
  */
  
 clock_t ALT_TIMES (struct tms *buf)
 {
-  clock_t ticks = alt_nticks(); 
+  alt_u32      tick_rate = alt_ticks_per_second ();
+  alt_timespec now;
+  clock_t      ticks;
 
   /* If there is no system clock present, generate an error */
 
-  if (!alt_ticks_per_second())
+  if (!tick_rate || alt_clock_gettime (&now))
   {
     ALT_ERRNO = ENOSYS;
     return 0;
   }
 
+  ticks = (clock_t) alt_clock_to_rate (&now, tick_rate);
+
   /* Otherwise return the elapsed time */
 
   buf->tms_utime  = 0;
@@ -0,0 +1,1062 @@
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2006 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+* Altera does not recommend, suggest or require that this reference design    *
+* file be used in conjunction or combination with any other product.          *
+******************************************************************************/
+
+
+/******************************************************************************
+*                                                                             *
+* THIS IS A LIBRARY READ-ONLY SOURCE FILE. DO NOT EDIT IT DIRECTLY.           *
+*                                                                             *
+* Overriding HAL Functions                                                    *
+*                                                                             *
+* To provide your own implementation of a HAL function, include the file in   *
+* your Nios II IDE application project. When building the executable, the     *
+* Nios II IDE finds your function first, and uses it in place of the HAL      *
+* version.                                                                    *
+*                                                                             *
+******************************************************************************/
+
+#include <errno.h>
+#include <string.h>
+#include <stddef.h>
+#include <unistd.h>
+
+#include "system.h"
+#include "alt_types.h"
+#include "sys/alt_irq.h"
+#include "sys/alt_tlsf.h"
+#include "os/alt_syscall.h"
+
+/*
+ * A block. "size" is the number of bytes that may be used at its payload,
+ * which starts after "size", with two flags in its low bits. The block 
+ * overlaps its neighbours: "prev_phys" is the last word of the previous 
+ * block's payload, and is only valid if that block is free; likewise 
+ * "next_free" and "prev_free" are the start of the payload, and are only
+ * valid while this block is free. The overhead of a used block is thus 
+ * just its size word.
+ *
+ * Each region ends with a used block of size zero, so that no block has
+ * to check whether it is the last.
+ *
+ * "size" is a size_t so that it is the size of a pointer, as the layout 
+ * requires, on a host as well as on the target.
+ */
+
+typedef struct alt_tlsf_block_s alt_tlsf_block;
+
+struct alt_tlsf_block_s
+{
+  alt_tlsf_block* prev_phys;
+  size_t          size;
+  alt_tlsf_block* next_free;
+  alt_tlsf_block* prev_free;
+};
+
+#define ALT_TLSF_FREE       1      /* This block is free */
+#define ALT_TLSF_PREV_FREE  2      /* The previous block is free */
+#define ALT_TLSF_FLAGS      3
+
+#define ALT_TLSF_SL_COUNT   (1 << ALT_TLSF_SL_LOG2)
+#define ALT_TLSF_ALIGN      ((alt_u32) 1 << ALT_TLSF_ALIGN_LOG2)
+#define ALT_TLSF_SMALL      ((alt_u32) 1 << ALT_TLSF_FL_SHIFT)
+
+#define ALT_TLSF_OVERHEAD   sizeof (size_t)
+#define ALT_TLSF_START      (offsetof (alt_tlsf_block, size) + sizeof (size_t))
+#define ALT_TLSF_MIN        (sizeof (alt_tlsf_block) - sizeof (alt_tlsf_block*))
+#define ALT_TLSF_MAX        ((alt_u32) 1 << ALT_TLSF_FL_MAX)
+
+#ifndef ALT_TLSF_MAX_REGIONS
+#define ALT_TLSF_MAX_REGIONS 8
+#endif
+
+static alt_u32         alt_tlsf_fl_bitmap;
+static alt_u32         alt_tlsf_sl_bitmap[ALT_TLSF_FL_COUNT];
+static alt_tlsf_block* alt_tlsf_lists[ALT_TLSF_FL_COUNT][ALT_TLSF_SL_COUNT];
+
+/* The first block of each region, for alt_tlsf_check() */
+
+static alt_tlsf_block* alt_tlsf_regions[ALT_TLSF_MAX_REGIONS];
+
+/* The end of the last region taken from alt_sbrk(), so it can be extended */
+
+static alt_tlsf_block* alt_tlsf_sbrk_end;
+
+static alt_tlsf_stats_t alt_tlsf_st;
+
+static alt_u32          alt_tlsf_ready = 0;
+static volatile alt_u32 alt_tlsf_busy  = 0;
+static void* volatile   alt_tlsf_queue = NULL;
+
+/*
+ * Find first and last set, for non-zero x. As in alt_irq_handler.c, the 
+ * smaller cores have no instruction for either, so each is a binary 
+ * search without branches.
+ */
+
+static ALT_INLINE alt_u32 ALT_ALWAYS_INLINE alt_tlsf_ffs (alt_u32 x)
+{
+  alt_u32 n = 0;
+  alt_u32 s;
+
+  s = ((x & 0xffff) == 0) << 4; n += s; x >>= s;
+  s = ((x & 0xff) == 0) << 3;   n += s; x >>= s;
+  s = ((x & 0xf) == 0) << 2;    n += s; x >>= s;
+  s = ((x & 0x3) == 0) << 1;    n += s; x >>= s;
+  s = ((x & 0x1) == 0);         n += s;
+
+  return n;
+}
+
+static ALT_INLINE alt_u32 ALT_ALWAYS_INLINE alt_tlsf_fls (alt_u32 x)
+{
+  alt_u32 n = 0;
+  alt_u32 s;
+
+  s = (x > 0xffff) << 4; n += s; x >>= s;
+  s = (x > 0xff) << 3;   n += s; x >>= s;
+  s = (x > 0xf) << 2;    n += s; x >>= s;
+  s = (x > 0x3) << 1;    n += s; x >>= s;
+  s = (x > 0x1);         n += s;
+
+  return n;
+}
+
+static ALT_INLINE alt_u32 ALT_ALWAYS_INLINE alt_tlsf_size (alt_tlsf_block* b)
+{
+  return b->size & ~ALT_TLSF_FLAGS;
+}
+
+static ALT_INLINE void* ALT_ALWAYS_INLINE alt_tlsf_to_ptr (alt_tlsf_block* b)
+{
+  return (char*) b + ALT_TLSF_START;
+}
+
+static ALT_INLINE alt_tlsf_block* ALT_ALWAYS_INLINE alt_tlsf_from_ptr (void* p)
+{
+  return (alt_tlsf_block*) ((char*) p - ALT_TLSF_START);
+}
+
+static ALT_INLINE alt_tlsf_block* ALT_ALWAYS_INLINE alt_tlsf_next (alt_tlsf_block* b)
+{
+  return (alt_tlsf_block*) ((char*) alt_tlsf_to_ptr (b) + alt_tlsf_size (b) - 
+                            ALT_TLSF_OVERHEAD);
+}
+
+static ALT_INLINE alt_tlsf_block* ALT_ALWAYS_INLINE alt_tlsf_link_next (alt_tlsf_block* b)
+{
+  alt_tlsf_block* next = alt_tlsf_next (b);
+
+  next->prev_phys = b;
+  return next;
+}
+
+static void alt_tlsf_mark_free (alt_tlsf_block* b)
+{
+  alt_tlsf_link_next (b)->size |= ALT_TLSF_PREV_FREE;
+  b->size |= ALT_TLSF_FREE;
+}
+
+static void alt_tlsf_mark_used (alt_tlsf_block* b)
+{
+  alt_tlsf_next (b)->size &= ~ALT_TLSF_PREV_FREE;
+  b->size &= ~ALT_TLSF_FREE;
+}
+
+/*
+ * alt_tlsf_mapping() finds the lists for a block of "size" bytes: the 
+ * first level is the power of two below it, and the second level the next
+ * ALT_TLSF_SL_LOG2 bits. Sizes below ALT_TLSF_SMALL share first level 0.
+ */
+
+static void alt_tlsf_mapping (alt_u32 size, alt_u32* fl, alt_u32* sl)
+{
+  alt_u32 f;
+
+  if (size < ALT_TLSF_SMALL)
+  {
+    *fl = 0;
+    *sl = size >> ALT_TLSF_ALIGN_LOG2;
+  }
+  else
+  {
+    f   = alt_tlsf_fls (size);
+    *sl = (size >> (f - ALT_TLSF_SL_LOG2)) ^ ALT_TLSF_SL_COUNT;
+    *fl = f - (ALT_TLSF_FL_SHIFT - 1);
+  }
+}
+
+static void alt_tlsf_insert (alt_tlsf_block* b)
+{
+  alt_u32         size = alt_tlsf_size (b);
+  alt_u32         fl;
+  alt_u32         sl;
+  alt_tlsf_block* head;
+
+  alt_tlsf_mapping (size, &fl, &sl);
+
+  head         = alt_tlsf_lists[fl][sl];
+  b->next_free = head;
+  b->prev_free = NULL;
+  if (head)
+  {
+    head->prev_free = b;
+  }
+  alt_tlsf_lists[fl][sl] = b;
+
+  alt_tlsf_fl_bitmap     |= 1u << fl;
+  alt_tlsf_sl_bitmap[fl] |= 1u << sl;
+
+  alt_tlsf_st.free += size;
+  alt_tlsf_st.hist[fl]++;
+}
+
+static void alt_tlsf_remove (alt_tlsf_block* b)
+{
+  alt_u32         size = alt_tlsf_size (b);
+  alt_u32         fl;
+  alt_u32         sl;
+  alt_tlsf_block* prev = b->prev_free;
+  alt_tlsf_block* next = b->next_free;
+
+  alt_tlsf_mapping (size, &fl, &sl);
+
+  if (next)
+  {
+    next->prev_free = prev;
+  }
+  if (prev)
+  {
+    prev->next_free = next;
+  }
+  else
+  {
+    alt_tlsf_lists[fl][sl] = next;
+    if (!next)
+    {
+      alt_tlsf_sl_bitmap[fl] &= ~(1u << sl);
+      if (!alt_tlsf_sl_bitmap[fl])
+      {
+        alt_tlsf_fl_bitmap &= ~(1u << fl);
+      }
+    }
+  }
+
+  alt_tlsf_st.free -= size;
+  alt_tlsf_st.hist[fl]--;
+}
+
+/*
+ * alt_tlsf_find() returns a free block of at least "size" bytes, or NULL.
+ * The size is first rounded up to the next list boundary, so that any 
+ * block on the list found is large enough.
+ */
+
+static alt_tlsf_block* alt_tlsf_find (alt_u32 size)
+{
+  alt_u32 fl;
+  alt_u32 sl;
+  alt_u32 map;
+
+  if (size >= ALT_TLSF_SMALL)
+  {
+    size += (1u << (alt_tlsf_fls (size) - ALT_TLSF_SL_LOG2)) - 1;
+  }
+
+  alt_tlsf_mapping (size, &fl, &sl);
+  if (fl >= ALT_TLSF_FL_COUNT)
+  {
+    return NULL;
+  }
+
+  map = alt_tlsf_sl_bitmap[fl] & (~(alt_u32) 0 << sl);
+  if (!map)
+  {
+    map = alt_tlsf_fl_bitmap & (~(alt_u32) 0 << (fl + 1));
+    if (!map)
+    {
+      return NULL;
+    }
+    fl  = alt_tlsf_ffs (map);
+    map = alt_tlsf_sl_bitmap[fl];
+  }
+
+  return alt_tlsf_lists[fl][alt_tlsf_ffs (map)];
+}
+
+/*
+ * alt_tlsf_split() cuts "b" down to "size" bytes, and returns the rest as
+ * a new free block, which has not been inserted in a list.
+ */
+
+static alt_tlsf_block* alt_tlsf_split (alt_tlsf_block* b, alt_u32 size)
+{
+  alt_tlsf_block* rest = (alt_tlsf_block*) ((char*) alt_tlsf_to_ptr (b) + size -
+                                            ALT_TLSF_OVERHEAD);
+
+  rest->size = alt_tlsf_size (b) - (size + ALT_TLSF_OVERHEAD);
+  b->size    = size | (b->size & ALT_TLSF_FLAGS);
+  alt_tlsf_mark_free (rest);
+
+  return rest;
+}
+
+static ALT_INLINE int ALT_ALWAYS_INLINE alt_tlsf_can_split (alt_tlsf_block* b,
+                                                            alt_u32 size)
+{
+  return alt_tlsf_size (b) >= sizeof (alt_tlsf_block) + size;
+}
+
+/* Add "next", which must follow "b", to "b" */
+
+static alt_tlsf_block* alt_tlsf_absorb (alt_tlsf_block* b, alt_tlsf_block* next)
+{
+  b->size += alt_tlsf_size (next) + ALT_TLSF_OVERHEAD;
+  alt_tlsf_link_next (b);
+  return b;
+}
+
+static alt_tlsf_block* alt_tlsf_merge_prev (alt_tlsf_block* b)
+{
+  alt_tlsf_block* prev;
+
+  if (b->size & ALT_TLSF_PREV_FREE)
+  {
+    prev = b->prev_phys;
+    alt_tlsf_remove (prev);
+    b = alt_tlsf_absorb (prev, b);
+  }
+  return b;
+}
+
+static alt_tlsf_block* alt_tlsf_merge_next (alt_tlsf_block* b)
+{
+  alt_tlsf_block* next = alt_tlsf_next (b);
+
+  if (next->size & ALT_TLSF_FREE)
+  {
+    alt_tlsf_remove (next);
+    b = alt_tlsf_absorb (b, next);
+  }
+  return b;
+}
+
+/* Return the end of a free block that is larger than needed to its list */
+
+static void alt_tlsf_trim_free (alt_tlsf_block* b, alt_u32 size)
+{
+  alt_tlsf_block* rest;
+
+  if (alt_tlsf_can_split (b, size))
+  {
+    rest = alt_tlsf_split (b, size);
+    alt_tlsf_link_next (b);
+    rest->size |= ALT_TLSF_PREV_FREE;
+    alt_tlsf_insert (rest);
+  }
+}
+
+/* Likewise for a used block */
+
+static void alt_tlsf_trim_used (alt_tlsf_block* b, alt_u32 size)
+{
+  alt_tlsf_block* rest;
+
+  if (alt_tlsf_can_split (b, size))
+  {
+    rest = alt_tlsf_split (b, size);
+    rest->size &= ~ALT_TLSF_PREV_FREE;
+    alt_tlsf_insert (alt_tlsf_merge_next (rest));
+  }
+}
+
+/* Return the start of a free block to its list, and return the rest */
+
+static alt_tlsf_block* alt_tlsf_trim_leading (alt_tlsf_block* b, alt_u32 size)
+{
+  alt_tlsf_block* rest = b;
+
+  if (alt_tlsf_can_split (b, size))
+  {
+    rest = alt_tlsf_split (b, size - ALT_TLSF_OVERHEAD);
+    rest->size |= ALT_TLSF_PREV_FREE;
+    alt_tlsf_link_next (b);
+    alt_tlsf_insert (b);
+  }
+  return rest;
+}
+
+/*
+ * alt_tlsf_adjust() returns the block size for a request of "size" bytes,
+ * or 0 if it is too large.
+ */
+
+static alt_u32 alt_tlsf_adjust (size_t size)
+{
+  alt_u32 adjusted = (size + ALT_TLSF_ALIGN - 1) & ~(ALT_TLSF_ALIGN - 1);
+
+  if (size >= ALT_TLSF_MAX || adjusted >= ALT_TLSF_MAX)
+  {
+    return 0;
+  }
+  return adjusted > ALT_TLSF_MIN ? adjusted : ALT_TLSF_MIN;
+}
+
+/*
+ * alt_tlsf_region() adds a region at "mem", which is aligned, of "bytes"
+ * bytes, and returns its last block.
+ */
+
+static alt_tlsf_block* alt_tlsf_region (char* mem, alt_u32 bytes)
+{
+  alt_tlsf_block* b;
+  alt_tlsf_block* end;
+  alt_u32         size = (bytes - 2 * ALT_TLSF_OVERHEAD) & ~(ALT_TLSF_ALIGN - 1);
+  alt_u32         i;
+
+  if (bytes < 2 * ALT_TLSF_OVERHEAD + ALT_TLSF_MIN || size >= ALT_TLSF_MAX)
+  {
+    return NULL;
+  }
+
+  for (i = 0; i < ALT_TLSF_MAX_REGIONS && alt_tlsf_regions[i]; i++)
+    ;
+  if (i == ALT_TLSF_MAX_REGIONS)
+  {
+    return NULL;
+  }
+
+  /* The first block's prev_phys lies before the region, and is never used */
+
+  b       = (alt_tlsf_block*) (mem - ALT_TLSF_OVERHEAD);
+  b->size = size | ALT_TLSF_FREE;
+  alt_tlsf_insert (b);
+
+  end       = alt_tlsf_link_next (b);
+  end->size = ALT_TLSF_PREV_FREE;
+
+  alt_tlsf_regions[i] = b;
+  alt_tlsf_st.size   += size;
+  alt_tlsf_st.regions++;
+
+  return end;
+}
+
+/*
+ * alt_tlsf_grow() takes enough memory from alt_sbrk() for a block of 
+ * "size" bytes. If it follows on from the last region taken, that region
+ * is extended: its end block becomes the start of a free block, which is 
+ * merged with whatever was free before it.
+ */
+
+static int alt_tlsf_grow (alt_u32 size)
+{
+  alt_u32         incr = size + (size >> ALT_TLSF_SL_LOG2) + 
+                         2 * sizeof (alt_tlsf_block);
+  char*           mem;
+  alt_tlsf_block* b;
+
+  if (incr < ALT_TLSF_GROW_BYTES)
+  {
+    incr = ALT_TLSF_GROW_BYTES;
+  }
+  incr = (incr + ALT_TLSF_ALIGN - 1) & ~(ALT_TLSF_ALIGN - 1);
+
+  mem = (char*) ALT_SBRK (incr);
+  if (mem == (char*) -1)
+  {
+    return -ENOMEM;
+  }
+
+  b = alt_tlsf_sbrk_end;
+  if (b && mem == (char*) b + ALT_TLSF_START)
+  {
+    b->size = (incr - ALT_TLSF_OVERHEAD) | ALT_TLSF_FREE | 
+              (b->size & ALT_TLSF_PREV_FREE);
+    alt_tlsf_link_next (b)->size = ALT_TLSF_PREV_FREE;
+    alt_tlsf_sbrk_end = alt_tlsf_next (b);
+    alt_tlsf_st.size += incr;
+    alt_tlsf_insert (alt_tlsf_merge_prev (b));
+  }
+  else if (((size_t) mem & (ALT_TLSF_ALIGN - 1)) == 0)
+  {
+    b = alt_tlsf_region (mem, incr);
+    if (!b)
+    {
+      return -ENOMEM;
+    }
+    alt_tlsf_sbrk_end = b;
+  }
+  else
+  {
+    return -ENOMEM;
+  }
+
+  return 0;
+}
+
+/*
+ * alt_tlsf_lock() marks the heap busy, for which interrupts are disabled
+ * for a few instructions. It returns -EBUSY if the heap was busy already,
+ * which can only be because this is an interrupt handler that interrupted
+ * another heap operation.
+ */
+
+static int alt_tlsf_lock (void)
+{
+  alt_irq_context status;
+  alt_u32         busy;
+
+  status        = alt_irq_disable_all ();
+  busy          = alt_tlsf_busy;
+  alt_tlsf_busy = 1;
+  alt_irq_enable_all (status);
+
+  if (busy)
+  {
+    return -EBUSY;
+  }
+
+  if (!alt_tlsf_ready)
+  {
+    alt_tlsf_ready = 1;
+#if defined(ONCHIP_MEM_BASE) && !defined(ALT_TLSF_NO_ONCHIP)
+    {
+      extern char _alt_partition_onchip_mem_end[];
+      extern char __alt_overlay_end[] __attribute__ ((weak));
+      char*       start = _alt_partition_onchip_mem_end;
+      char*       end   = (char*) ONCHIP_MEM_BASE + ONCHIP_MEM_SPAN;
+
+      /* The overlay window (sys/alt_overlay.h), if any, follows the partition */
+
+      if (__alt_overlay_end > start)
+      {
+        start = __alt_overlay_end;
+      }
+      if (start < end)
+      {
+        alt_tlsf_region (start, end - start);
+      }
+    }
+#endif
+  }
+
+  return 0;
+}
+
+static void alt_tlsf_release (void* ptr);
+
+/*
+ * alt_tlsf_unlock() does any frees that were queued while the heap was 
+ * busy, then marks it free.
+ */
+
+static void alt_tlsf_unlock (void)
+{
+  alt_irq_context status;
+  void*           ptr;
+
+  for (;;)
+  {
+    status = alt_irq_disable_all ();
+    ptr    = alt_tlsf_queue;
+    if (!ptr)
+    {
+      alt_tlsf_busy = 0;
+      alt_irq_enable_all (status);
+      return;
+    }
+    alt_tlsf_queue = *(void**) ptr;
+    alt_irq_enable_all (status);
+
+    alt_tlsf_release (ptr);
+  }
+}
+
+static void* alt_tlsf_use (alt_tlsf_block* b, alt_u32 size)
+{
+  alt_tlsf_trim_free (b, size);
+  alt_tlsf_mark_used (b);
+
+  alt_tlsf_st.live += alt_tlsf_size (b);
+  if (alt_tlsf_st.live > alt_tlsf_st.peak)
+  {
+    alt_tlsf_st.peak = alt_tlsf_st.live;
+  }
+  alt_tlsf_st.allocs++;
+
+  return alt_tlsf_to_ptr (b);
+}
+
+/* Find a free block of at least "size" bytes, and take it off its list */
+
+static alt_tlsf_block* alt_tlsf_locate (alt_u32 size)
+{
+  alt_tlsf_block* b = alt_tlsf_find (size);
+
+  if (!b && alt_tlsf_grow (size) == 0)
+  {
+    b = alt_tlsf_find (size);
+  }
+  if (b)
+  {
+    alt_tlsf_remove (b);
+  }
+  else
+  {
+    alt_tlsf_st.failures++;
+  }
+  return b;
+}
+
+static void alt_tlsf_release (void* ptr)
+{
+  alt_tlsf_block* b = alt_tlsf_from_ptr (ptr);
+
+  alt_tlsf_st.live -= alt_tlsf_size (b);
+
+  alt_tlsf_mark_free (b);
+  b = alt_tlsf_merge_prev (b);
+  b = alt_tlsf_merge_next (b);
+  alt_tlsf_insert (b);
+}
+
+void* alt_tlsf_malloc (size_t size)
+{
+  alt_u32         adjusted = alt_tlsf_adjust (size);
+  alt_tlsf_block* b;
+  void*           ptr = NULL;
+
+  if (alt_tlsf_lock ())
+  {
+    errno = EBUSY;
+    return NULL;
+  }
+
+  b = adjusted ? alt_tlsf_locate (adjusted) : NULL;
+  if (b)
+  {
+    ptr = alt_tlsf_use (b, adjusted);
+  }
+
+  alt_tlsf_unlock ();
+
+  if (!ptr)
+  {
+    errno = ENOMEM;
+  }
+  return ptr;
+}
+
+void alt_tlsf_free (void* ptr)
+{
+  alt_irq_context status;
+
+  if (!ptr)
+  {
+    return;
+  }
+
+  if (alt_tlsf_lock ())
+  {
+    status         = alt_irq_disable_all ();
+    *(void**) ptr  = alt_tlsf_queue;
+    alt_tlsf_queue = ptr;
+    alt_tlsf_st.deferred++;
+    alt_irq_enable_all (status);
+    return;
+  }
+
+  alt_tlsf_release (ptr);
+  alt_tlsf_unlock ();
+}
+
+/*
+ * alt_tlsf_realloc() grows a block in place if the block after it is free
+ * and large enough, and otherwise moves it.
+ */
+
+void* alt_tlsf_realloc (void* ptr, size_t size)
+{
+  alt_u32         adjusted = alt_tlsf_adjust (size);
+  alt_tlsf_block* b;
+  alt_tlsf_block* next;
+  alt_u32         current;
+  void*           p;
+
+  if (!ptr)
+  {
+    return alt_tlsf_malloc (size);
+  }
+  if (!size)
+  {
+    alt_tlsf_free (ptr);
+    return NULL;
+  }
+  if (!adjusted)
+  {
+    errno = ENOMEM;
+    return NULL;
+  }
+  if (alt_tlsf_lock ())
+  {
+    errno = EBUSY;
+    return NULL;
+  }
+
+  b       = alt_tlsf_from_ptr (ptr);
+  next    = alt_tlsf_next (b);
+  current = alt_tlsf_size (b);
+
+  if (adjusted > current &&
+      (!(next->size & ALT_TLSF_FREE) ||
+       current + alt_tlsf_size (next) + ALT_TLSF_OVERHEAD < adjusted))
+  {
+    alt_tlsf_unlock ();
+
+    p = alt_tlsf_malloc (size);
+    if (p)
+    {
+      memcpy (p, ptr, current);
+      alt_tlsf_free (ptr);
+    }
+    return p;
+  }
+
+  if (adjusted > current)
+  {
+    alt_tlsf_remove (next);
+    alt_tlsf_absorb (b, next);
+    alt_tlsf_mark_used (b);
+  }
+  alt_tlsf_trim_used (b, adjusted);
+
+  alt_tlsf_st.live += alt_tlsf_size (b) - current;
+  if (alt_tlsf_st.live > alt_tlsf_st.peak)
+  {
+    alt_tlsf_st.peak = alt_tlsf_st.live;
+  }
+
+  alt_tlsf_unlock ();
+
+  return ptr;
+}
+
+/*
+ * alt_tlsf_memalign() takes a block large enough to leave a gap before the
+ * aligned address that is either empty, or large enough to be returned to
+ * the heap as a free block.
+ */
+
+void* alt_tlsf_memalign (size_t align, size_t size)
+{
+  alt_u32         adjusted = alt_tlsf_adjust (size);
+  alt_u32         gap_min  = sizeof (alt_tlsf_block);
+  alt_u32         with_gap = alt_tlsf_adjust (adjusted + align + gap_min);
+  alt_tlsf_block* b;
+  char*           ptr;
+  char*           aligned;
+  alt_u32         gap;
+  void*           p = NULL;
+
+  if (align <= ALT_TLSF_ALIGN)
+  {
+    return alt_tlsf_malloc (size);
+  }
+  if ((align & (align - 1)) != 0)
+  {
+    errno = EINVAL;
+    return NULL;
+  }
+  if (alt_tlsf_lock ())
+  {
+    errno = EBUSY;
+    return NULL;
+  }
+
+  b = (adjusted && with_gap) ? alt_tlsf_locate (with_gap) : NULL;
+  if (b)
+  {
+    ptr     = alt_tlsf_to_ptr (b);
+    aligned = (char*) (((size_t) ptr + align - 1) & ~(size_t) (align - 1));
+    gap     = aligned - ptr;
+
+    if (gap && gap < gap_min)
+    {
+      aligned += gap_min - gap > align ? gap_min - gap : align;
+      aligned  = (char*) (((size_t) aligned + align - 1) & ~(size_t) (align - 1));
+      gap      = aligned - ptr;
+    }
+
+    if (gap)
+    {
+      b = alt_tlsf_trim_leading (b, gap);
+    }
+    p = alt_tlsf_use (b, adjusted);
+  }
+
+  alt_tlsf_unlock ();
+
+  if (!p)
+  {
+    errno = ENOMEM;
+  }
+  return p;
+}
+
+size_t alt_tlsf_usable_size (void* ptr)
+{
+  return ptr ? alt_tlsf_size (alt_tlsf_from_ptr (ptr)) : 0;
+}
+
+int alt_tlsf_add_region (void* start, size_t size)
+{
+  char* mem = (char*) (((size_t) start + ALT_TLSF_ALIGN - 1) & 
+                       ~(size_t) (ALT_TLSF_ALIGN - 1));
+  int   rc  = 0;
+
+  if (size < (alt_u32) (mem - (char*) start))
+  {
+    return -EINVAL;
+  }
+  if (alt_tlsf_lock ())
+  {
+    return -EBUSY;
+  }
+
+  if (!alt_tlsf_region (mem, size - (mem - (char*) start)))
+  {
+    rc = -EINVAL;
+  }
+
+  alt_tlsf_unlock ();
+
+  return rc;
+}
+
+void alt_tlsf_stats (alt_tlsf_stats_t* stats)
+{
+  alt_tlsf_block* b;
+  alt_u32         fl;
+  alt_u32         sl;
+  int             locked = alt_tlsf_lock () == 0;
+
+  *stats         = alt_tlsf_st;
+  stats->largest = 0;
+
+  /* The largest free block is on the highest list that is not empty */
+
+  if (locked && alt_tlsf_fl_bitmap)
+  {
+    fl = alt_tlsf_fls (alt_tlsf_fl_bitmap);
+    sl = alt_tlsf_fls (alt_tlsf_sl_bitmap[fl]);
+    for (b = alt_tlsf_lists[fl][sl]; b; b = b->next_free)
+    {
+      if (alt_tlsf_size (b) > stats->largest)
+      {
+        stats->largest = alt_tlsf_size (b);
+      }
+    }
+  }
+
+  if (locked)
+  {
+    alt_tlsf_unlock ();
+  }
+}
+
+/* Check that "b" is on the list that its size maps to */
+
+static int alt_tlsf_listed (alt_tlsf_block* b)
+{
+  alt_tlsf_block* l;
+  alt_u32         fl;
+  alt_u32         sl;
+
+  alt_tlsf_mapping (alt_tlsf_size (b), &fl, &sl);
+  for (l = alt_tlsf_lists[fl][sl]; l && l != b; l = l->next_free)
+    ;
+  return l == b && (alt_tlsf_sl_bitmap[fl] & (1u << sl)) && 
+         (alt_tlsf_fl_bitmap & (1u << fl));
+}
+
+int alt_tlsf_check (void)
+{
+  alt_tlsf_block* b;
+  alt_tlsf_block* next;
+  alt_u32         free  = 0;
+  alt_u32         live  = 0;
+  alt_u32         nfree = 0;
+  alt_u32         hist  = 0;
+  alt_u32         prev_free;
+  alt_u32         i;
+  int             rc = 0;
+
+  if (alt_tlsf_lock ())
+  {
+    return -EBUSY;
+  }
+
+  for (i = 0; i < ALT_TLSF_MAX_REGIONS && alt_tlsf_regions[i]; i++)
+  {
+    prev_free = 0;
+    for (b = alt_tlsf_regions[i]; alt_tlsf_size (b); b = next)
+    {
+      next = alt_tlsf_next (b);
+
+      if (!(b->size & ALT_TLSF_PREV_FREE) != !prev_free ||
+          (prev_free && (b->size & ALT_TLSF_FREE)) ||
+          (prev_free && b->prev_phys == NULL))
+      {
+        rc = -EFAULT;
+      }
+
+      prev_free = b->size & ALT_TLSF_FREE;
+      if (prev_free)
+      {
+        if (next->prev_phys != b || !alt_tlsf_listed (b))
+        {
+          rc = -EFAULT;
+        }
+        free += alt_tlsf_size (b);
+        nfree++;
+      }
+      else
+      {
+        live += alt_tlsf_size (b);
+      }
+    }
+
+    if (!(b->size & ALT_TLSF_PREV_FREE) != !prev_free)
+    {
+      rc = -EFAULT;
+    }
+  }
+
+  for (i = 0; i < ALT_TLSF_FL_COUNT; i++)
+  {
+    hist += alt_tlsf_st.hist[i];
+  }
+
+  if (free != alt_tlsf_st.free || live != alt_tlsf_st.live || nfree != hist)
+  {
+    rc = -EFAULT;
+  }
+
+  alt_tlsf_unlock ();
+
+  return rc;
+}
+
+#ifdef ALT_TLSF_MALLOC
+
+#include <reent.h>
+
+/*
+ * The C library's allocation functions. newlib calls the reentrant 
+ * versions internally, so both are replaced, so that none of newlib's 
+ * malloc is linked in.
+ */
+
+void* _malloc_r (struct _reent* r, size_t size)
+{
+  return alt_tlsf_malloc (size);
+}
+
+void _free_r (struct _reent* r, void* ptr)
+{
+  alt_tlsf_free (ptr);
+}
+
+void* _realloc_r (struct _reent* r, void* ptr, size_t size)
+{
+  return alt_tlsf_realloc (ptr, size);
+}
+
+void* _calloc_r (struct _reent* r, size_t n, size_t size)
+{
+  void* ptr;
+
+  if (size && n > (size_t) -1 / size)
+  {
+    errno = ENOMEM;
+    return NULL;
+  }
+
+  ptr = alt_tlsf_malloc (n * size);
+  if (ptr)
+  {
+    memset (ptr, 0, n * size);
+  }
+  return ptr;
+}
+
+void* _memalign_r (struct _reent* r, size_t align, size_t size)
+{
+  return alt_tlsf_memalign (align, size);
+}
+
+size_t _malloc_usable_size_r (struct _reent* r, void* ptr)
+{
+  return alt_tlsf_usable_size (ptr);
+}
+
+void* malloc (size_t size)
+{
+  return alt_tlsf_malloc (size);
+}
+
+void free (void* ptr)
+{
+  alt_tlsf_free (ptr);
+}
+
+void* realloc (void* ptr, size_t size)
+{
+  return alt_tlsf_realloc (ptr, size);
+}
+
+void* calloc (size_t n, size_t size)
+{
+  return _calloc_r (_REENT, n, size);
+}
+
+void* memalign (size_t align, size_t size)
+{
+  return alt_tlsf_memalign (align, size);
+}
+
+size_t malloc_usable_size (void* ptr)
+{
+  return alt_tlsf_usable_size (ptr);
+}
+
+#endif /* ALT_TLSF_MALLOC */
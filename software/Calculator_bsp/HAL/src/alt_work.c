@@ -0,0 +1,154 @@
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2006 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+* Altera does not recommend, suggest or require that this reference design    *
+* file be used in conjunction or combination with any other product.          *
+******************************************************************************/
+
+
+/******************************************************************************
+*                                                                             *
+* THIS IS A LIBRARY READ-ONLY SOURCE FILE. DO NOT EDIT IT DIRECTLY.           *
+*                                                                             *
+* Overriding HAL Functions                                                    *
+*                                                                             *
+* To provide your own implementation of a HAL function, include the file in   *
+* your Nios II IDE application project. When building the executable, the     *
+* Nios II IDE finds your function first, and uses it in place of the HAL      *
+* version.                                                                    *
+*                                                                             *
+******************************************************************************/
+
+#include <errno.h>
+
+#include "alt_types.h"
+#include "sys/alt_irq.h"
+#include "sys/alt_work.h"
+
+/*
+ * A queue of work items. "head" is only written by alt_work_queue(), and 
+ * "tail" by alt_work_run(); both count up without wrapping to the queue
+ * length, so the queue is full when they differ by ALT_WORK_QUEUE_LEN.
+ */
+
+typedef struct alt_work_queue_s
+{
+  alt_work* volatile items[ALT_WORK_QUEUE_LEN];
+  volatile alt_u32   head;
+  volatile alt_u32   tail;
+} alt_work_queue_t;
+
+static alt_work_queue_t alt_work_queues[ALT_WORK_PRIORITIES];
+
+static alt_u32 alt_work_running = 0;
+
+/*
+ * alt_work_queue() queues an item. See sys/alt_work.h.
+ *
+ * Interrupts are disabled for the few instructions it takes, so that each
+ * queue has a single producer even if a nested interrupt or thread context
+ * queues work at the same priority. Called from an interrupt handler, 
+ * where they are disabled already, this costs nothing further.
+ */
+
+int alt_work_queue (alt_work* work)
+{
+  alt_work_queue_t* q = &alt_work_queues[work->priority];
+  alt_irq_context   context;
+  int               rc = 0;
+
+  context = alt_irq_disable_all ();
+
+  if (!work->pending)
+  {
+    if (q->head - q->tail == ALT_WORK_QUEUE_LEN)
+    {
+      rc = -ENOSPC;
+    }
+    else
+    {
+      q->items[q->head & (ALT_WORK_QUEUE_LEN - 1)] = work;
+      work->pending = 1;
+      q->head++;
+    }
+  }
+
+  alt_irq_enable_all (context);
+
+  return rc;
+}
+
+/*
+ * alt_work_run() runs queued work. See sys/alt_work.h.
+ *
+ * It is the only consumer of every queue, so it needs no lock: an item is
+ * read before "tail" moves past it, and an interrupt can only add items
+ * beyond "head". Each item is marked as no longer pending once it is off
+ * the queue and before its function is called, so that anything that 
+ * happens while it runs queues it again.
+ */
+
+int alt_work_run (void)
+{
+  alt_work_queue_t* q;
+  alt_work*         work;
+  alt_u32           p;
+  int               n = 0;
+
+  if (alt_work_running)
+  {
+    return 0;
+  }
+  alt_work_running = 1;
+
+  for (p = 0; p < ALT_WORK_PRIORITIES; )
+  {
+    q = &alt_work_queues[p];
+
+    if (q->tail == q->head)
+    {
+      p++;
+      continue;
+    }
+
+    work = q->items[q->tail & (ALT_WORK_QUEUE_LEN - 1)];
+    q->tail++;
+    work->pending = 0;
+
+    work->func (work->context);
+    n++;
+
+    /* Higher priority work may have been queued meanwhile */
+
+    p = 0;
+  }
+
+  alt_work_running = 0;
+
+  return n;
+}
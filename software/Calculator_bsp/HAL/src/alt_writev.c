@@ -0,0 +1,176 @@
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2006 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+* Altera does not recommend, suggest or require that this reference design    *
+* file be used in conjunction or combination with any other product.          *
+******************************************************************************/
+
+/******************************************************************************
+*                                                                             *
+* THIS IS A LIBRARY READ-ONLY SOURCE FILE. DO NOT EDIT IT DIRECTLY.           *
+*                                                                             *
+* Overriding HAL Functions                                                    *
+*                                                                             *
+* To provide your own implementation of a HAL function, include the file in   *
+* your Nios II IDE application project. When building the executable, the     *
+* Nios II IDE finds your function first, and uses it in place of the HAL      *
+* version.                                                                    *
+*                                                                             *
+******************************************************************************/
+
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "sys/uio.h"
+#include "sys/alt_errno.h"
+#include "sys/alt_warning.h"
+#include "priv/alt_file.h"
+#include "os/alt_syscall.h"
+
+#include "sys/alt_log_printf.h"
+
+/*
+ * The writev() system call writes a list of buffers to a file or device in
+ * a single operation. If the driver associated with the file descriptor
+ * "file" provides a writev() function then the whole list is passed to it;
+ * otherwise each buffer is passed to the driver's write() function in turn,
+ * stopping at the first one that is not written completely.
+ *
+ * ALT_WRITEV is mapped onto the writev() system call in alt_syscall.h
+ */
+
+#ifdef ALT_USE_DIRECT_DRIVERS
+
+/*
+ * The direct drivers have no file descriptor table, so just pass each buffer
+ * to write().
+ */
+
+int ALT_WRITEV (int file, const struct iovec* iov, int iovcnt)
+{
+  int total = 0;
+  int rval;
+  int i;
+
+  for (i = 0; i < iovcnt; i++)
+  {
+    rval = ALT_WRITE (file, iov[i].iov_base, iov[i].iov_len);
+    if (rval < 0)
+      return total ? total : rval;
+
+    total += rval;
+    if (rval < iov[i].iov_len)
+      break;
+  }
+  return total;
+}
+
+#else /* !ALT_USE_DIRECT_DRIVERS */
+
+int ALT_WRITEV (int file, const struct iovec* iov, int iovcnt)
+{
+  alt_fd*  fd;
+  int      total;
+  int      rval;
+  int      i;
+
+  if (iovcnt < 0 || iovcnt > IOV_MAX)
+  {
+    ALT_ERRNO = EINVAL;
+    return -1;
+  }
+
+  /*
+   * A common error case is that when the file descriptor was created, the call
+   * to open() failed resulting in a negative file descriptor. This is trapped
+   * below so that we don't try and process an invalid file descriptor.
+   */
+
+  fd = (file < 0) ? NULL : &alt_fd_list[file];
+  
+  if (fd)
+  {
+    /*
+     * If the file has not been opened with write access, or if the driver does
+     * not provide an implementation of write(), generate an error.
+     */
+
+    if (((fd->fd_flags & O_ACCMODE) != O_RDONLY) && 
+        (fd->dev->writev || fd->dev->write))
+    {
+      /* ALT_LOG - see altera_hal/HAL/inc/sys/alt_log_printf.h */
+      for (i = 0; i < iovcnt; i++)
+      {
+        ALT_LOG_WRITE_FUNCTION(iov[i].iov_base, iov[i].iov_len);
+      }
+
+      if (fd->dev->writev)
+      {
+        if ((rval = fd->dev->writev(fd, iov, iovcnt)) < 0)
+        {
+          ALT_ERRNO = -rval;
+          return -1;
+        }
+        return rval;
+      }
+
+      /* Fall back to one call to write() per buffer */
+
+      for (total = 0, i = 0; i < iovcnt; i++)
+      {
+        if (iov[i].iov_len == 0)
+          continue;
+
+        if ((rval = fd->dev->write(fd, iov[i].iov_base, iov[i].iov_len)) < 0)
+        {
+          if (total)
+            break;
+
+          ALT_ERRNO = -rval;
+          return -1;
+        }
+
+        total += rval;
+        if (rval < iov[i].iov_len)
+          break;
+      }
+      return total;
+    }
+    else
+    {
+      ALT_ERRNO = EACCES;
+    }
+  }
+  else  
+  {
+    ALT_ERRNO = EBADFD;
+  }
+  return -1;
+}
+
+#endif /* ALT_USE_DIRECT_DRIVERS */
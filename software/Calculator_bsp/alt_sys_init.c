@@ -61,6 +61,7 @@
 #include "altera_nios2_irq.h"
 #include "altera_avalon_jtag_uart.h"
 #include "altera_avalon_lcd_16207.h"
+#include "altera_avalon_timer.h"
 
 /*
  * Allocate the device storage
@@ -70,6 +71,16 @@ ALTERA_NIOS2_IRQ_INSTANCE ( CPU, cpu);
 ALTERA_AVALON_JTAG_UART_INSTANCE ( JTAG_UART, jtag_uart);
 ALTERA_AVALON_LCD_16207_INSTANCE ( LCD, lcd);
 
+/*
+ * The system has no interval timer yet. Once one named sys_clk_timer is
+ * added and selected as hal.sys_clk_timer / hal.timestamp_timer, it is
+ * started here.
+ */
+
+#ifdef SYS_CLK_TIMER_BASE
+ALTERA_AVALON_TIMER_INSTANCE ( SYS_CLK_TIMER, sys_clk_timer);
+#endif
+
 /*
  * Initialize the interrupt controller devices
  * and then enable interrupts in the CPU.
@@ -91,6 +102,9 @@ void alt_irq_init ( const void* base )
 
 void alt_sys_init( void )
 {
+#ifdef SYS_CLK_TIMER_BASE
+    ALTERA_AVALON_TIMER_INIT ( SYS_CLK_TIMER, sys_clk_timer);
+#endif
     ALTERA_AVALON_JTAG_UART_INIT ( JTAG_UART, jtag_uart);
     ALTERA_AVALON_LCD_16207_INIT ( LCD, lcd);
 }
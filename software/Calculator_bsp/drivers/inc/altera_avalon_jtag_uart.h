@@ -35,6 +35,7 @@
 
 #include "sys/alt_alarm.h"
 #include "sys/alt_warning.h"
+#include "sys/alt_work.h"
 
 #include "os/alt_sem.h"
 #include "os/alt_flag.h"
@@ -63,6 +64,11 @@ extern "C"
 #define ALTERA_AVALON_JTAG_UART_BUF_LEN 2048
 #endif
 
+/* The priority of the FIFO servicing work when ALT_DEFERRED_WORK is set */
+#ifndef ALTERA_AVALON_JTAG_UART_WORK_PRIORITY
+#define ALTERA_AVALON_JTAG_UART_WORK_PRIORITY 0
+#endif
+
 /*
  * ALT_JTAG_UART_READ_RDY and ALT_JTAG_UART_WRITE_RDY are the bitmasks 
  * that define uC/OS-II event flags that are releated to this device.
@@ -106,6 +112,14 @@ typedef struct altera_avalon_jtag_uart_state_s
   char          rx_buf[ALTERA_AVALON_JTAG_UART_BUF_LEN];
   char          tx_buf[ALTERA_AVALON_JTAG_UART_BUF_LEN];
 
+#ifdef ALT_DEFERRED_WORK
+  /* The interrupt handler masks the interrupt and queues this work, which
+   * services the FIFOs and unmasks it again. */
+  alt_work      work;
+  int           irq_controller_id;
+  int           irq;
+#endif /* ALT_DEFERRED_WORK */
+
 #endif /* !ALTERA_AVALON_JTAG_UART_SMALL */
 
 } altera_avalon_jtag_uart_state;
@@ -44,6 +44,8 @@ extern "C"
 extern int altera_avalon_jtag_uart_read_fd (alt_fd* fd, char* ptr, int len);
 extern int altera_avalon_jtag_uart_write_fd (alt_fd* fd, const char* ptr,
   int len);
+extern int altera_avalon_jtag_uart_writev_fd (alt_fd* fd,
+  const struct iovec* iov, int iovcnt);
 
 /*
  * Device structure definition. This is needed by alt_sys_init in order to 
@@ -75,6 +77,7 @@ typedef struct altera_avalon_jtag_uart_dev_s
       NULL, /* lseek */                                  \
       NULL, /* fstat */                                  \
       NULL, /* ioctl */                                  \
+      altera_avalon_jtag_uart_writev_fd,                 \
     },                                                   \
     {                                                    \
         name##_BASE,                                     \
@@ -101,6 +104,7 @@ extern int altera_avalon_jtag_uart_ioctl_fd (alt_fd* fd, int req, void* arg);
       NULL, /* lseek */                                  \
       NULL, /* fstat */                                  \
       altera_avalon_jtag_uart_ioctl_fd,                  \
+      altera_avalon_jtag_uart_writev_fd,                 \
     },                                                   \
     {                                                    \
       name##_BASE,                                       \
@@ -34,6 +34,7 @@
 #include <stddef.h>
 
 #include "sys/alt_alarm.h"
+#include "sys/alt_work.h"
 #include "os/alt_sem.h"
 
 #ifdef __cplusplus
@@ -54,6 +55,12 @@ extern "C"
 #define ALT_LCD_WIDTH         16
 #define ALT_LCD_VIRTUAL_WIDTH 80
 
+/* The priority of repaints from the scrolling alarm when ALT_DEFERRED_WORK
+ * is set: the lowest, since a late repaint only slows the scrolling. */
+#ifndef ALT_LCD_WORK_PRIORITY
+#define ALT_LCD_WORK_PRIORITY (ALT_WORK_PRIORITIES - 1)
+#endif
+
 typedef struct altera_avalon_lcd_16207_state_s 
 {
   int            base;
@@ -87,6 +94,11 @@ typedef struct altera_avalon_lcd_16207_state_s
 
   ALT_SEM       (write_lock)/* Semaphore used to control access to the
                              * write buffer in multi-threaded mode */
+
+#ifdef ALT_DEFERRED_WORK
+  alt_work       repaint;   /* Queued by the timer call to repaint the 
+                             * display in thread context */
+#endif
 } altera_avalon_lcd_16207_state;
 
 /*
@@ -43,6 +43,8 @@ extern "C"
  */
 extern int altera_avalon_lcd_16207_write_fd(alt_fd* fd, const char* ptr,
   int len);
+extern int altera_avalon_lcd_16207_writev_fd(alt_fd* fd,
+  const struct iovec* iov, int iovcnt);
 
 /*
  * Device structure definition. This is needed by alt_sys_init in order to 
@@ -80,6 +82,7 @@ typedef struct altera_avalon_lcd_16207_dev_s
         NULL, /* lseek */                                \
         NULL, /* fstat */                                \
         NULL, /* ioctl */                                \
+        altera_avalon_lcd_16207_writev_fd,               \
       },                                                 \
       {                                                  \
         name##_BASE                                      \
@@ -0,0 +1,170 @@
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2003 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+******************************************************************************/
+
+#ifndef __ALT_AVALON_TIMER_H__
+#define __ALT_AVALON_TIMER_H__
+
+#include "alt_types.h"
+#include "system.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/*
+ * An interval timer can be used as the system clock (ALT_SYS_CLK), which
+ * calls alt_tick(), as the timestamp clock (ALT_TIMESTAMP_CLK), which 
+ * provides alt_timestamp(), or as both at once. 
+ *
+ * In every case the driver keeps a 64 bit count of the cycles of the 
+ * timer's clock: the 32 bit hardware counter is read through the snapshot
+ * registers, and the timeout interrupt accounts for each time it reloads. 
+ * The timer must therefore be built with a writable period, start/stop 
+ * control bits and a readable snapshot (the "Full-featured" preset).
+ */
+
+/* alt_timestamp() returns a count of timer clock cycles */
+
+typedef alt_u64 alt_timestamp_type;
+
+/*
+ * The state of one timer. "cycles" is the count at the point the counter
+ * was last loaded with "period", so the current count is "cycles" plus the
+ * distance the counter has moved down from "period" since.
+ */
+
+typedef struct altera_avalon_timer_state_s
+{
+  void*            base;
+  alt_u32          freq;    /* counter clock, in Hz */
+  alt_u32          period;  /* the counter runs from period down to 0 */
+  volatile alt_u64 cycles;
+} altera_avalon_timer_state;
+
+/* The system clock timer */
+
+extern altera_avalon_timer_state altera_avalon_timer_sc;
+
+/*
+ * The lowest period, in cycles, that a tickless system clock is programmed
+ * with. The interrupt must be taken within half of it for the cycle count
+ * to remain correct.
+ */
+
+#ifndef ALTERA_AVALON_TIMER_MIN_PERIOD
+#define ALTERA_AVALON_TIMER_MIN_PERIOD 256
+#endif
+
+/*
+ * altera_avalon_timer_start() loads the counter with "period" and starts 
+ * it running continuously with its interrupt enabled, counting from 
+ * "cycles".
+ *
+ * altera_avalon_timer_count() returns the current cycle count. 
+ *
+ * altera_avalon_timer_timeout() is called by the interrupt handler to 
+ * acknowledge the timeout and account for the period that has ended. 
+ *
+ * All three must be called with interrupts disabled.
+ */
+
+extern void    altera_avalon_timer_start (altera_avalon_timer_state* sp,
+                                          alt_u64 cycles, alt_u32 period);
+extern alt_u64 altera_avalon_timer_count (altera_avalon_timer_state* sp);
+extern void    altera_avalon_timer_timeout (altera_avalon_timer_state* sp);
+
+/*
+ * alt_avalon_timer_sc_init() starts the system clock timer and registers
+ * its interrupt handler. alt_avalon_timer_ts_init() does the same for a
+ * timestamp timer; if that is also the system clock it just shares the 
+ * system clock's count.
+ */
+
+extern void alt_avalon_timer_sc_init (void* base, alt_u32 irq_controller_id,
+                                      alt_u32 irq, alt_u32 freq, 
+                                      alt_u32 ticks_per_sec);
+
+extern void alt_avalon_timer_ts_init (void* base, alt_u32 irq_controller_id,
+                                      alt_u32 irq, alt_u32 freq);
+
+/*
+ * The base addresses of the timers chosen as the system and timestamp 
+ * clocks, or none_BASE for "none". The clock rates of the same timers are
+ * only defined when the timer is not "none".
+ */
+
+#define __ALT_CLK_BASE(name) name##_BASE
+#define _ALT_CLK_BASE(name) __ALT_CLK_BASE(name)
+#define __ALT_CLK_FREQ(name) name##_FREQ
+#define _ALT_CLK_FREQ(name) __ALT_CLK_FREQ(name)
+
+#define ALT_SYS_CLK_BASE       _ALT_CLK_BASE(ALT_SYS_CLK)
+#define ALT_TIMESTAMP_CLK_BASE _ALT_CLK_BASE(ALT_TIMESTAMP_CLK)
+#define ALT_SYS_CLK_FREQ       _ALT_CLK_FREQ(ALT_SYS_CLK)
+#define ALT_TIMESTAMP_CLK_FREQ _ALT_CLK_FREQ(ALT_TIMESTAMP_CLK)
+
+#ifndef none_BASE
+#define none_BASE 0xffffffff
+#endif
+
+/*
+ * ALTERA_AVALON_TIMER_INSTANCE is the macro used by alt_sys_init() to 
+ * allocate any per device memory that may be required. The state is
+ * allocated by the driver, since there is at most one of each kind.
+ *
+ * ALTERA_AVALON_TIMER_INIT starts the timer in whichever role(s) the BSP
+ * settings have given it.
+ */
+
+#define ALTERA_AVALON_TIMER_INSTANCE(name, dev) extern int alt_no_storage
+
+#define ALTERA_AVALON_TIMER_INIT(name, dev)                                 \
+  if (name##_BASE == ALT_SYS_CLK_BASE)                                      \
+  {                                                                         \
+    alt_avalon_timer_sc_init ((void*) name##_BASE,                          \
+                              name##_IRQ_INTERRUPT_CONTROLLER_ID,           \
+                              name##_IRQ,                                   \
+                              name##_FREQ,                                  \
+                              name##_TICKS_PER_SEC);                        \
+  }                                                                         \
+  if (name##_BASE == ALT_TIMESTAMP_CLK_BASE)                                \
+  {                                                                         \
+    alt_avalon_timer_ts_init ((void*) name##_BASE,                          \
+                              name##_IRQ_INTERRUPT_CONTROLLER_ID,           \
+                              name##_IRQ,                                   \
+                              name##_FREQ);                                 \
+  }
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __ALT_AVALON_TIMER_H__ */
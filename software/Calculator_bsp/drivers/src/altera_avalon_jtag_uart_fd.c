@@ -30,12 +30,15 @@
 
 #include "alt_types.h"
 #include "sys/alt_dev.h"
+#include "sys/uio.h"
 #include "altera_avalon_jtag_uart.h"
 
 extern int altera_avalon_jtag_uart_read(altera_avalon_jtag_uart_state* sp,
   char* buffer, int space, int flags);
 extern int altera_avalon_jtag_uart_write(altera_avalon_jtag_uart_state* sp,
   const char* ptr, int count, int flags);
+extern int altera_avalon_jtag_uart_writev(altera_avalon_jtag_uart_state* sp,
+  const struct iovec* iov, int iovcnt, int flags);
 extern int altera_avalon_jtag_uart_ioctl(altera_avalon_jtag_uart_state* sp,
   int req, void* arg);
 extern int altera_avalon_jtag_uart_close(altera_avalon_jtag_uart_state* sp, 
@@ -65,6 +68,16 @@ altera_avalon_jtag_uart_write_fd(alt_fd* fd, const char* buffer, int space)
       fd->fd_flags);
 }
 
+int 
+altera_avalon_jtag_uart_writev_fd(alt_fd* fd, const struct iovec* iov,
+  int iovcnt)
+{
+    altera_avalon_jtag_uart_dev* dev = (altera_avalon_jtag_uart_dev*) fd->dev; 
+
+    return altera_avalon_jtag_uart_writev(&dev->state, iov, iovcnt,
+      fd->fd_flags);
+}
+
 #ifndef ALTERA_AVALON_JTAG_UART_SMALL
 
 int 
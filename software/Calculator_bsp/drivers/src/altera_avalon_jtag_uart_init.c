@@ -37,6 +37,7 @@
 
 #include "sys/alt_irq.h"
 #include "sys/alt_alarm.h"
+#include "sys/alt_work.h"
 #include "sys/ioctl.h"
 #include "alt_types.h"
 
@@ -56,6 +57,9 @@ static void altera_avalon_jtag_uart_irq(void* context);
 static void altera_avalon_jtag_uart_irq(void* context, alt_u32 id);
 #endif 
 static alt_u32 altera_avalon_jtag_uart_timeout(void* context);
+#ifdef ALT_DEFERRED_WORK
+static void altera_avalon_jtag_uart_work(void* context);
+#endif
 
 /* 
  * Driver initialization code.  Register interrupts and start a timer
@@ -70,6 +74,13 @@ void altera_avalon_jtag_uart_init(altera_avalon_jtag_uart_state* sp,
   ALT_SEM_CREATE(&sp->read_lock, 1);
   ALT_SEM_CREATE(&sp->write_lock, 1);
 
+#ifdef ALT_DEFERRED_WORK
+  sp->irq_controller_id = irq_controller_id;
+  sp->irq               = irq;
+  alt_work_init(&sp->work, altera_avalon_jtag_uart_work, sp, 
+                ALTERA_AVALON_JTAG_UART_WORK_PRIORITY);
+#endif
+
   /* enable read interrupts at the device */
   sp->irq_enable = ALTERA_AVALON_JTAG_UART_CONTROL_RE_MSK;
 
@@ -100,20 +111,13 @@ void altera_avalon_jtag_uart_init(altera_avalon_jtag_uart_state* sp,
 }
 
 /*
- * Interrupt routine
- */ 
-#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
-static void altera_avalon_jtag_uart_irq(void* context)
-#else
-static void altera_avalon_jtag_uart_irq(void* context, alt_u32 id)
-#endif
+ * Move characters between the FIFOs and the buffers until the device has
+ * no more interrupts to raise.  This is the work of the interrupt routine.
+ */
+static void altera_avalon_jtag_uart_service(altera_avalon_jtag_uart_state* sp)
 {
-  altera_avalon_jtag_uart_state* sp = (altera_avalon_jtag_uart_state*) context;
   unsigned int base = sp->base;
 
-  /* ALT_LOG - see altera_hal/HAL/inc/sys/alt_log_printf.h */ 
-  ALT_LOG_JTAG_UART_ISR_FUNCTION(base, sp);
-
   for ( ; ; )
   {
     unsigned int control = IORD_ALTERA_AVALON_JTAG_UART_CONTROL(base);
@@ -196,6 +200,69 @@ static void altera_avalon_jtag_uart_irq(void* context, alt_u32 id)
   }
 }
 
+#ifdef ALT_DEFERRED_WORK
+
+/*
+ * Mask (on == 0) or unmask the device's interrupt at the interrupt 
+ * controller, leaving the device's own interrupt enables alone so that
+ * RI and WI still say what needs doing.
+ */
+static void altera_avalon_jtag_uart_irq_mask(altera_avalon_jtag_uart_state* sp,
+                                             int on)
+{
+#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
+  if (on)
+    alt_ic_irq_enable(sp->irq_controller_id, sp->irq);
+  else
+    alt_ic_irq_disable(sp->irq_controller_id, sp->irq);
+#else
+  if (on)
+    alt_irq_enable(sp->irq);
+  else
+    alt_irq_disable(sp->irq);
+#endif
+}
+
+/*
+ * Deferred work, run in thread context: service the FIFOs with interrupts
+ * enabled, then let the device interrupt again.
+ */
+static void altera_avalon_jtag_uart_work(void* context)
+{
+  altera_avalon_jtag_uart_state* sp = (altera_avalon_jtag_uart_state*) context;
+
+  altera_avalon_jtag_uart_service(sp);
+  altera_avalon_jtag_uart_irq_mask(sp, 1);
+}
+
+#endif /* ALT_DEFERRED_WORK */
+
+/*
+ * Interrupt routine.  With ALT_DEFERRED_WORK it masks the interrupt and
+ * leaves the FIFOs to altera_avalon_jtag_uart_work(), unless the work
+ * queue is full.
+ */ 
+#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
+static void altera_avalon_jtag_uart_irq(void* context)
+#else
+static void altera_avalon_jtag_uart_irq(void* context, alt_u32 id)
+#endif
+{
+  altera_avalon_jtag_uart_state* sp = (altera_avalon_jtag_uart_state*) context;
+
+  /* ALT_LOG - see altera_hal/HAL/inc/sys/alt_log_printf.h */ 
+  ALT_LOG_JTAG_UART_ISR_FUNCTION(sp->base, sp);
+
+#ifdef ALT_DEFERRED_WORK
+  altera_avalon_jtag_uart_irq_mask(sp, 0);
+  if (alt_work_queue(&sp->work) == 0)
+    return;
+  altera_avalon_jtag_uart_irq_mask(sp, 1);
+#endif
+
+  altera_avalon_jtag_uart_service(sp);
+}
+
 /*
  * Timeout routine is called every second
  */
@@ -248,6 +315,7 @@ int altera_avalon_jtag_uart_close(altera_avalon_jtag_uart_state* sp, int flags)
     if (flags & O_NONBLOCK) {
       return -EWOULDBLOCK; 
     }
+    ALT_WORK_IDLE();
   }
 
   return 0;
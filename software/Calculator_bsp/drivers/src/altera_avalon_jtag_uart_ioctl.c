@@ -76,6 +76,13 @@ altera_avalon_jtag_uart_ioctl(altera_avalon_jtag_uart_state* sp, int req,
     }
     break;
 
+  case TIOCOUTQ:
+    /* Find out how many characters are waiting to be transmitted */
+    *((int *)arg) = (sp->tx_in + ALTERA_AVALON_JTAG_UART_BUF_LEN - sp->tx_out) %
+                    ALTERA_AVALON_JTAG_UART_BUF_LEN;
+    rc = 0;
+    break;
+
   default:
     break;
   }
@@ -37,6 +37,7 @@
 
 #include "sys/alt_irq.h"
 #include "sys/alt_alarm.h"
+#include "sys/alt_work.h"
 #include "sys/ioctl.h"
 #include "alt_types.h"
 
@@ -57,7 +58,9 @@
 
 /* Read routine.  The small version blocks until it has at least one byte
  * available, it then returns as much as is immediately available without
- * waiting any more.  It's performance will be very poor without
+ * waiting any more.  Each read of the DATA register also reports RAVAIL,
+ * the number of characters still in the FIFO, so those are drained without
+ * testing RVALID again.  It's performance will still be poor without
  * interrupts.
  */
 
@@ -73,11 +76,24 @@ altera_avalon_jtag_uart_read(altera_avalon_jtag_uart_state* sp,
   while (ptr < end)
   {
     unsigned int data = IORD_ALTERA_AVALON_JTAG_UART_DATA(base);
+    unsigned int avail;
 
     if (data & ALTERA_AVALON_JTAG_UART_DATA_RVALID_MSK)
+    {
       *ptr++ = (data & ALTERA_AVALON_JTAG_UART_DATA_DATA_MSK) >> ALTERA_AVALON_JTAG_UART_DATA_DATA_OFST;
-    else if (ptr != buffer)
+
+      avail = (data & ALTERA_AVALON_JTAG_UART_DATA_RAVAIL_MSK) >> 
+              ALTERA_AVALON_JTAG_UART_DATA_RAVAIL_OFST;
+      if (avail > end - ptr)
+        avail = end - ptr;
+
+      while (avail-- > 0)
+        *ptr++ = (IORD_ALTERA_AVALON_JTAG_UART_DATA(base) & 
+                  ALTERA_AVALON_JTAG_UART_DATA_DATA_MSK) >> 
+                  ALTERA_AVALON_JTAG_UART_DATA_DATA_OFST;
+
       break;
+    }
     else if(flags & O_NONBLOCK)
       break;   
     
@@ -116,6 +132,9 @@ altera_avalon_jtag_uart_read(altera_avalon_jtag_uart_state* sp,
   {
     unsigned int in, out;
 
+    /* Let any deferred interrupt work fill the buffer first */
+    ALT_WORK_IDLE();
+
     /* Read as much data as possible */
     do
     {
@@ -166,12 +185,12 @@ altera_avalon_jtag_uart_read(altera_avalon_jtag_uart_state* sp,
     else {
       /* Spin until more data arrives or until host disconnects */
       while (in == sp->rx_in && sp->host_inactive < sp->timeout)
-        ;
+        ALT_WORK_IDLE();
     }
 #else
     /* No OS: Always spin */
     while (in == sp->rx_in && sp->host_inactive < sp->timeout)
-      ;
+      ALT_WORK_IDLE();
 #endif /* __ucosii__ */
 
     if (in == sp->rx_in)
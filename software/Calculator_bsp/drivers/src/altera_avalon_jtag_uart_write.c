@@ -37,7 +37,9 @@
 
 #include "sys/alt_irq.h"
 #include "sys/alt_alarm.h"
+#include "sys/alt_work.h"
 #include "sys/ioctl.h"
+#include "sys/uio.h"
 #include "alt_types.h"
 
 #include "altera_avalon_jtag_uart_regs.h"
@@ -55,9 +57,11 @@
 /* ------------------------ SMALL DRIVER --------------------- */
 /* ----------------------------------------------------------- */
 
-/* Write routine.  The small version blocks when there is no space to write
- * into, so it's performance will be very bad if you are writing more than
- * one FIFOs worth of data.  But you said you didn't want to use interrupts :-)
+/* Write routine.  The small version polls the CONTROL register and then
+ * writes as many characters as WSPACE says there is room for, so that one
+ * register read is spent per burst rather than per character.  In blocking
+ * mode it spins until everything has been written; with O_NONBLOCK it
+ * returns as soon as the FIFO is full.
  */
 
 int altera_avalon_jtag_uart_write(altera_avalon_jtag_uart_state* sp, 
@@ -65,13 +69,84 @@ int altera_avalon_jtag_uart_write(altera_avalon_jtag_uart_state* sp,
 {
   unsigned int base = sp->base;
 
+  const char * start = ptr;
   const char * end = ptr + count;
 
   while (ptr < end)
-    if ((IORD_ALTERA_AVALON_JTAG_UART_CONTROL(base) & ALTERA_AVALON_JTAG_UART_CONTROL_WSPACE_MSK) != 0)
+  {
+    unsigned int space = (IORD_ALTERA_AVALON_JTAG_UART_CONTROL(base) & 
+                          ALTERA_AVALON_JTAG_UART_CONTROL_WSPACE_MSK) >> 
+                          ALTERA_AVALON_JTAG_UART_CONTROL_WSPACE_OFST;
+
+    if (space == 0)
+    {
+      if (flags & O_NONBLOCK)
+        break;
+      continue;
+    }
+
+    if (space > end - ptr)
+      space = end - ptr;
+
+    while (space-- > 0)
       IOWR_ALTERA_AVALON_JTAG_UART_DATA(base, *ptr++);
+  }
 
-  return count;
+  if (ptr != start)
+    return ptr - start;
+  else if (count == 0)
+    return 0;
+  else
+    return -EWOULDBLOCK;
+}
+
+/* Scatter-gather version of the above.  The WSPACE count is carried from
+ * one buffer to the next so that short buffers (a label, a number, a
+ * newline) do not each cost a CONTROL register read.
+ */
+
+int altera_avalon_jtag_uart_writev(altera_avalon_jtag_uart_state* sp, 
+  const struct iovec* iov, int iovcnt, int flags)
+{
+  unsigned int base = sp->base;
+  unsigned int space = 0;
+  int total = 0;
+  int i;
+
+  for (i = 0; i < iovcnt; i++)
+  {
+    const char * ptr = iov[i].iov_base;
+    const char * end = ptr + iov[i].iov_len;
+
+    while (ptr < end)
+    {
+      if (space == 0)
+      {
+        space = (IORD_ALTERA_AVALON_JTAG_UART_CONTROL(base) & 
+                 ALTERA_AVALON_JTAG_UART_CONTROL_WSPACE_MSK) >> 
+                 ALTERA_AVALON_JTAG_UART_CONTROL_WSPACE_OFST;
+
+        if (space == 0)
+        {
+          if (flags & O_NONBLOCK)
+            break;
+          continue;
+        }
+      }
+
+      total++;
+      space--;
+      IOWR_ALTERA_AVALON_JTAG_UART_DATA(base, *ptr++);
+    }
+
+    if (ptr < end)
+      break;
+  }
+
+  if (total != 0 || i == iovcnt)
+    return total;
+  else
+    return -EWOULDBLOCK;
 }
 
 #else /* !ALTERA_AVALON_JTAG_UART_SMALL */
@@ -80,23 +155,41 @@ int altera_avalon_jtag_uart_write(altera_avalon_jtag_uart_state* sp,
 /* ------------------------- FAST DRIVER --------------------- */
 /* ----------------------------------------------------------- */
 
-int 
-altera_avalon_jtag_uart_write(altera_avalon_jtag_uart_state* sp, 
+/*
+ * If interrupts are disabled then we could transmit here, we only need 
+ * to enable interrupts if there is no space left in the FIFO
+ *
+ * For now kick the interrupt routine every time to make it transmit 
+ * the data 
+ */
+
+static void
+altera_avalon_jtag_uart_kick(altera_avalon_jtag_uart_state* sp)
+{
+  alt_irq_context context;
+
+  context = alt_irq_disable_all();
+  sp->irq_enable |= ALTERA_AVALON_JTAG_UART_CONTROL_WE_MSK;
+  IOWR_ALTERA_AVALON_JTAG_UART_CONTROL(sp->base, sp->irq_enable);
+  alt_irq_enable_all(context);
+}
+
+/* Copy count characters into the transmit buffer, blocking for space unless
+ * O_NONBLOCK is set.  The caller must hold the write lock, and must kick the
+ * transmitter once it has finished queuing data.  Returns the number of
+ * characters that were queued.
+ */
+
+static int
+altera_avalon_jtag_uart_queue(altera_avalon_jtag_uart_state* sp, 
   const char * ptr, int count, int flags)
 {
   /* Remove warning at optimisation level 03 by seting out to 0 */
   unsigned int in, out=0;
   unsigned int n;
-  alt_irq_context context;
 
   const char * start = ptr;
 
-  /*
-   * When running in a multi threaded environment, obtain the "write_lock"
-   * semaphore. This ensures that writing to the device is thread-safe.
-   */
-  ALT_SEM_PEND (sp->write_lock, 0);
-
   do
   {
     /* Copy as much as we can into the transmit buffer */
@@ -126,18 +219,6 @@ altera_avalon_jtag_uart_write(altera_avalon_jtag_uart_state* sp,
       sp->tx_in = (in + n) % ALTERA_AVALON_JTAG_UART_BUF_LEN;
     }
 
-    /*
-     * If interrupts are disabled then we could transmit here, we only need 
-     * to enable interrupts if there is no space left in the FIFO
-     *
-     * For now kick the interrupt routine every time to make it transmit 
-     * the data 
-     */
-    context = alt_irq_disable_all();
-    sp->irq_enable |= ALTERA_AVALON_JTAG_UART_CONTROL_WE_MSK;
-    IOWR_ALTERA_AVALON_JTAG_UART_CONTROL(sp->base, sp->irq_enable);
-    alt_irq_enable_all(context);
-
     /* 
      * If there is any data left then either return now or block until 
      * some has been sent 
@@ -148,6 +229,9 @@ altera_avalon_jtag_uart_write(altera_avalon_jtag_uart_state* sp,
       if (flags & O_NONBLOCK)
         break;
 
+      /* The buffer is full, so make sure the interrupt routine is emptying it */
+      altera_avalon_jtag_uart_kick(sp);
+
 #ifdef __ucosii__
       /* OS Present: Pend on a flag if the OS is running, otherwise spin */
       if(OSRunning == OS_TRUE) {
@@ -169,7 +253,7 @@ altera_avalon_jtag_uart_write(altera_avalon_jtag_uart_state* sp,
          * will be able to insert some more.
          */
         while (out == sp->tx_out && sp->host_inactive < sp->timeout)
-          ;
+          ALT_WORK_IDLE();
       }
 #else
       /*
@@ -178,7 +262,7 @@ altera_avalon_jtag_uart_write(altera_avalon_jtag_uart_state* sp,
        * insert some more.
        */
       while (out == sp->tx_out && sp->host_inactive < sp->timeout)
-        ;
+        ALT_WORK_IDLE();
 #endif /* __ucosii__ */
 
       if (out == sp->tx_out)
@@ -187,14 +271,68 @@ altera_avalon_jtag_uart_write(altera_avalon_jtag_uart_state* sp,
   }
   while (count > 0);
 
+  return ptr - start;
+}
+
+int 
+altera_avalon_jtag_uart_write(altera_avalon_jtag_uart_state* sp, 
+  const char * ptr, int count, int flags)
+{
+  int n;
+
+  /*
+   * When running in a multi threaded environment, obtain the "write_lock"
+   * semaphore. This ensures that writing to the device is thread-safe.
+   */
+  ALT_SEM_PEND (sp->write_lock, 0);
+
+  n = altera_avalon_jtag_uart_queue(sp, ptr, count, flags);
+  altera_avalon_jtag_uart_kick(sp);
+
   /*
    * Now that access to the circular buffer is complete, release the write
    * semaphore so that other threads can access the buffer.
    */
   ALT_SEM_POST (sp->write_lock);
 
-  if (ptr != start)
-    return ptr - start;
+  if (n != 0)
+    return n;
+  else if (flags & O_NONBLOCK)
+    return -EWOULDBLOCK;
+  else
+    return -EIO; /* Host not connected */
+}
+
+/*
+ * Scatter-gather write: queue every buffer under one hold of the write lock
+ * and start the transmitter once, rather than once per buffer.
+ */
+
+int 
+altera_avalon_jtag_uart_writev(altera_avalon_jtag_uart_state* sp, 
+  const struct iovec* iov, int iovcnt, int flags)
+{
+  int total = 0;
+  int n;
+  int i;
+
+  ALT_SEM_PEND (sp->write_lock, 0);
+
+  for (i = 0; i < iovcnt; i++)
+  {
+    n = altera_avalon_jtag_uart_queue(sp, iov[i].iov_base, iov[i].iov_len,
+      flags);
+    total += n;
+    if (n < iov[i].iov_len)
+      break;
+  }
+
+  altera_avalon_jtag_uart_kick(sp);
+
+  ALT_SEM_POST (sp->write_lock);
+
+  if (total != 0 || i == iovcnt)
+    return total;
   else if (flags & O_NONBLOCK)
     return -EWOULDBLOCK;
   else
@@ -69,6 +69,7 @@
 #include <errno.h>
 
 #include "sys/alt_alarm.h"
+#include "sys/uio.h"
 
 #include "altera_avalon_lcd_16207_regs.h"
 #include "altera_avalon_lcd_16207.h"
@@ -346,24 +347,15 @@ static void lcd_handle_escape(altera_avalon_lcd_16207_state* sp, char c)
 
 /* --------------------------------------------------------------------- */
 
-int altera_avalon_lcd_16207_write(altera_avalon_lcd_16207_state* sp, 
-  const char* ptr, int len, int flags)
+/* Interpret the characters being written and update the text buffer.
+ * Nothing is sent to the display until lcd_write_done is called.
+ */
+
+static void lcd_write_chars(altera_avalon_lcd_16207_state* sp, 
+  const char* ptr, int len)
 {
   const char* end = ptr + len;
 
-  int y;
-  int widthmax;
-
-  /* When running in a multi threaded environment, obtain the "write_lock"
-   * semaphore. This ensures that writing to the device is thread-safe.
-   */
-
-  ALT_SEM_PEND (sp->write_lock, 0);
-
-  /* Tell the routine which is called off the timer interrupt that the
-   * foreground routines are active so it must not repaint the display. */
-  sp->active = 1;
-
   for ( ; ptr < end ; ptr++)
   {
     char c = *ptr;
@@ -428,6 +420,14 @@ int altera_avalon_lcd_16207_write(altera_avalon_lcd_16207_state* sp,
       sp->x++;
     }
   }
+}
+
+/* --------------------------------------------------------------------- */
+
+static void lcd_write_done(altera_avalon_lcd_16207_state* sp)
+{
+  int y;
+  int widthmax;
 
   /* Recalculate the scrolling parameters */
   widthmax = ALT_LCD_WIDTH;
@@ -509,6 +509,25 @@ int altera_avalon_lcd_16207_write(altera_avalon_lcd_16207_state* sp,
      * painting last time */
     sp->active = 1;
   }
+}
+
+/* --------------------------------------------------------------------- */
+
+int altera_avalon_lcd_16207_write(altera_avalon_lcd_16207_state* sp, 
+  const char* ptr, int len, int flags)
+{
+  /* When running in a multi threaded environment, obtain the "write_lock"
+   * semaphore. This ensures that writing to the device is thread-safe.
+   */
+
+  ALT_SEM_PEND (sp->write_lock, 0);
+
+  /* Tell the routine which is called off the timer interrupt that the
+   * foreground routines are active so it must not repaint the display. */
+  sp->active = 1;
+
+  lcd_write_chars(sp, ptr, len);
+  lcd_write_done(sp);
 
   /* Now that access to the display is complete, release the write
    * semaphore so that other threads can access the buffer.
@@ -521,9 +540,55 @@ int altera_avalon_lcd_16207_write(altera_avalon_lcd_16207_state* sp,
 
 /* --------------------------------------------------------------------- */
 
+/* Repainting the panel is by far the slowest part of a write, so a
+ * scatter-gather write takes in all of the buffers before repainting once.
+ */
+
+int altera_avalon_lcd_16207_writev(altera_avalon_lcd_16207_state* sp, 
+  const struct iovec* iov, int iovcnt, int flags)
+{
+  int len = 0;
+  int i;
+
+  ALT_SEM_PEND (sp->write_lock, 0);
+
+  sp->active = 1;
+
+  for (i = 0 ; i < iovcnt ; i++)
+  {
+    lcd_write_chars(sp, iov[i].iov_base, iov[i].iov_len);
+    len += iov[i].iov_len;
+  }
+
+  lcd_write_done(sp);
+
+  ALT_SEM_POST (sp->write_lock);
+
+  return len;
+}
+
+/* --------------------------------------------------------------------- */
+
 /* This should be in a top level header file really */
 #define container_of(ptr, type, member) ((type *)((char *)ptr - offsetof(type, member)))
 
+#ifdef ALT_DEFERRED_WORK
+
+/*
+ * Deferred repaint, queued by the timeout routine.  The foreground may have
+ * started writing since, in which case it repaints anyway.
+ */
+
+static void alt_lcd_16207_repaint(void* context)
+{
+  altera_avalon_lcd_16207_state* sp = (altera_avalon_lcd_16207_state*)context;
+
+  if (sp->scrollmax > 0 && !sp->active)
+    lcd_repaint_screen(sp);
+}
+
+#endif /* ALT_DEFERRED_WORK */
+
 /*
  * Timeout routine is called every second
  */
@@ -538,9 +603,18 @@ static alt_u32 alt_lcd_16207_timeout(void* context)
   else
     sp->scrollpos = sp->scrollpos + 1;
 
-  /* Repaint the panel unless the foreground will do it again soon */
+  /* Repaint the panel unless the foreground will do it again soon.  With
+   * ALT_DEFERRED_WORK that is left to thread context, since it can take 
+   * milliseconds.
+   */
   if (sp->scrollmax > 0 && !sp->active)
+  {
+#ifdef ALT_DEFERRED_WORK
+    if (alt_work_queue(&sp->repaint) == 0)
+      return sp->period;
+#endif
     lcd_repaint_screen(sp);
+  }
 
   return sp->period;
 }
@@ -599,6 +673,10 @@ void altera_avalon_lcd_16207_init(altera_avalon_lcd_16207_state* sp)
   sp->scrollmax = 0;
   sp->active = 0;
 
+#ifdef ALT_DEFERRED_WORK
+  alt_work_init(&sp->repaint, alt_lcd_16207_repaint, sp, ALT_LCD_WORK_PRIORITY);
+#endif
+
   sp->period = alt_ticks_per_second() / 10; /* Call every 100ms */
 
   alt_alarm_start(&sp->alarm, sp->period, &alt_lcd_16207_timeout, sp);
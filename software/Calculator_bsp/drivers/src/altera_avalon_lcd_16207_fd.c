@@ -30,10 +30,13 @@
 
 #include "alt_types.h"
 #include "sys/alt_dev.h"
+#include "sys/uio.h"
 #include "altera_avalon_lcd_16207.h"
 
 extern int altera_avalon_lcd_16207_write(altera_avalon_lcd_16207_state* sp,
   const char* ptr, int count, int flags);
+extern int altera_avalon_lcd_16207_writev(altera_avalon_lcd_16207_state* sp,
+  const struct iovec* iov, int iovcnt, int flags);
 
 int 
 altera_avalon_lcd_16207_write_fd(alt_fd* fd, const char* buffer, int space)
@@ -43,3 +46,13 @@ altera_avalon_lcd_16207_write_fd(alt_fd* fd, const char* buffer, int space)
     return altera_avalon_lcd_16207_write(&dev->state, buffer, space,
       fd->fd_flags);
 }
+
+int 
+altera_avalon_lcd_16207_writev_fd(alt_fd* fd, const struct iovec* iov,
+  int iovcnt)
+{
+    altera_avalon_lcd_16207_dev* dev = (altera_avalon_lcd_16207_dev*) fd->dev; 
+
+    return altera_avalon_lcd_16207_writev(&dev->state, iov, iovcnt,
+      fd->fd_flags);
+}
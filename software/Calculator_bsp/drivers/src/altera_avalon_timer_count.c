@@ -0,0 +1,105 @@
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2003 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+******************************************************************************/
+
+#include "alt_types.h"
+
+#include "altera_avalon_timer_regs.h"
+#include "altera_avalon_timer.h"
+
+/*
+ * The cycle count shared by the system clock and timestamp drivers. See
+ * altera_avalon_timer.h.
+ */
+
+void altera_avalon_timer_start (altera_avalon_timer_state* sp,
+                                alt_u64 cycles, alt_u32 period)
+{
+  void* base = sp->base;
+
+  sp->cycles = cycles;
+  sp->period = period;
+
+  /* Writing the period stops the counter and loads it */
+
+  IOWR_ALTERA_AVALON_TIMER_PERIODL (base, period & ALTERA_AVALON_TIMER_PERIODL_MSK);
+  IOWR_ALTERA_AVALON_TIMER_PERIODH (base, period >> 16);
+  IOWR_ALTERA_AVALON_TIMER_STATUS (base, 0);
+
+  IOWR_ALTERA_AVALON_TIMER_CONTROL (base, 
+                                    ALTERA_AVALON_TIMER_CONTROL_ITO_MSK  |
+                                    ALTERA_AVALON_TIMER_CONTROL_CONT_MSK |
+                                    ALTERA_AVALON_TIMER_CONTROL_START_MSK);
+}
+
+alt_u64 altera_avalon_timer_count (altera_avalon_timer_state* sp)
+{
+  void*   base = sp->base;
+  alt_u32 snap;
+  alt_u64 cycles;
+
+  /* Writing either snapshot register latches the counter */
+
+  IOWR_ALTERA_AVALON_TIMER_SNAPL (base, 0);
+  snap = (IORD_ALTERA_AVALON_TIMER_SNAPL (base) & ALTERA_AVALON_TIMER_SNAPL_MSK) |
+    ((IORD_ALTERA_AVALON_TIMER_SNAPH (base) & ALTERA_AVALON_TIMER_SNAPH_MSK) << 16);
+
+  cycles = sp->cycles + (sp->period - snap);
+
+  /* 
+   * If the counter has reloaded but the interrupt has not been taken yet, 
+   * the period that has ended must be counted here. Since the status is 
+   * read after the snapshot, TO may have been set after it; in that case 
+   * the snapshot is from the end of the old period rather than the start
+   * of the new one.
+   */
+
+  if ((IORD_ALTERA_AVALON_TIMER_STATUS (base) & ALTERA_AVALON_TIMER_STATUS_TO_MSK) &&
+      (snap > (sp->period >> 1)))
+  {
+    cycles += (alt_u64) sp->period + 1;
+  }
+
+  return cycles;
+}
+
+void altera_avalon_timer_timeout (altera_avalon_timer_state* sp)
+{
+  void* base = sp->base;
+
+  if (IORD_ALTERA_AVALON_TIMER_STATUS (base) & ALTERA_AVALON_TIMER_STATUS_TO_MSK)
+  {
+    IOWR_ALTERA_AVALON_TIMER_STATUS (base, 0);
+    sp->cycles += (alt_u64) sp->period + 1;
+
+    /* Dummy read to ensure the IRQ is negated before the ISR returns */
+
+    IORD_ALTERA_AVALON_TIMER_CONTROL (base);
+  }
+}
@@ -0,0 +1,195 @@
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2003 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+******************************************************************************/
+
+#include <stddef.h>
+
+#include "system.h"
+#include "alt_types.h"
+#include "sys/alt_irq.h"
+#include "sys/alt_alarm.h"
+#include "sys/alt_clock.h"
+
+#include "altera_avalon_timer_regs.h"
+#include "altera_avalon_timer.h"
+
+/*
+ * The system clock driver. Normally the timer interrupts once per tick. In
+ * a tickless system (ALT_TICKLESS defined) it is instead reprogrammed for
+ * each deadline given to alt_sysclk_program(), and alt_sysclk_now() works 
+ * out the tick from the cycle count.
+ */
+
+altera_avalon_timer_state altera_avalon_timer_sc;
+
+/* Timer clock cycles per system clock tick */
+
+static alt_u32 altera_avalon_timer_sc_cpt;
+
+#ifdef ALT_TICKLESS
+
+/* (2^64 - 1) / altera_avalon_timer_sc_cpt, for alt_sysclk_now() */
+
+static alt_u64 altera_avalon_timer_sc_recip;
+
+#endif
+
+/*
+ * alt_avalon_timer_sc_irq() is the interrupt handler for the system clock.
+ * It accounts for the elapsed period and calls alt_tick().
+ */
+
+#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
+static void alt_avalon_timer_sc_irq (void* context)
+#else
+static void alt_avalon_timer_sc_irq (void* context, alt_u32 id)
+#endif
+{
+  alt_irq_context cpu_sr;
+
+  /* 
+   * Disable interrupts while the count is updated and the alarms run, to 
+   * safely support ISR preemption.
+   */
+
+  cpu_sr = alt_irq_disable_all ();
+  altera_avalon_timer_timeout ((altera_avalon_timer_state*) context);
+  alt_tick ();
+  alt_irq_enable_all (cpu_sr);
+}
+
+/*
+ * alt_avalon_timer_sc_init() sets the system clock rate, starts the timer
+ * and registers its interrupt handler.
+ */
+
+void alt_avalon_timer_sc_init (void* base, alt_u32 irq_controller_id,
+                               alt_u32 irq, alt_u32 freq, 
+                               alt_u32 ticks_per_sec)
+{
+  altera_avalon_timer_state* sp = &altera_avalon_timer_sc;
+
+  if (alt_sysclk_init (ticks_per_sec))
+  {
+    return;
+  }
+
+  sp->base = base;
+  sp->freq = freq;
+
+  altera_avalon_timer_sc_cpt = freq / ticks_per_sec;
+
+#ifdef ALT_TICKLESS
+  altera_avalon_timer_sc_recip = ~(alt_u64) 0 / altera_avalon_timer_sc_cpt;
+
+  /* Nothing is due yet; the first alarm brings the deadline forward */
+  altera_avalon_timer_start (sp, 0, 0xffffffff);
+#else
+  altera_avalon_timer_start (sp, 0, altera_avalon_timer_sc_cpt - 1);
+#endif
+
+#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
+  alt_ic_isr_register (irq_controller_id, irq, alt_avalon_timer_sc_irq, sp, 
+                       NULL);
+#else
+  alt_irq_register (irq, sp, alt_avalon_timer_sc_irq);
+#endif  
+}
+
+#ifdef ALT_TICKLESS
+
+/*
+ * alt_sysclk_now() returns the current tick, from the cycle count. The 
+ * core has no divider, so the count is divided by multiplying by the 
+ * reciprocal worked out at init, and the estimate corrected.
+ */
+
+alt_u64 alt_sysclk_now (void)
+{
+  alt_irq_context cpu_sr;
+  alt_u64         cycles;
+  alt_u64         ticks;
+
+  cpu_sr = alt_irq_disable_all ();
+  cycles = altera_avalon_timer_count (&altera_avalon_timer_sc);
+  alt_irq_enable_all (cpu_sr);
+
+  ticks   = alt_clock_mulhi (cycles, altera_avalon_timer_sc_recip);
+  cycles -= ticks * altera_avalon_timer_sc_cpt;
+
+  while (cycles >= altera_avalon_timer_sc_cpt)
+  {
+    ticks++;
+    cycles -= altera_avalon_timer_sc_cpt;
+  }
+
+  return ticks;
+}
+
+/*
+ * alt_sysclk_program() reloads the timer so that it next times out at the
+ * start of tick "deadline". 
+ *
+ * The counter is stopped while it is reprogrammed, and the cycles for which
+ * it is stopped are lost from the count. If the timer is also the timestamp
+ * clock, the timestamps therefore fall a few cycles behind for each 
+ * deadline; use a separate timestamp timer where that matters.
+ */
+
+void alt_sysclk_program (alt_u64 deadline)
+{
+  altera_avalon_timer_state* sp = &altera_avalon_timer_sc;
+  alt_irq_context cpu_sr;
+  alt_u64         now;
+  alt_u64         delta;
+
+  cpu_sr = alt_irq_disable_all ();
+
+  IOWR_ALTERA_AVALON_TIMER_CONTROL (sp->base, 
+                                    ALTERA_AVALON_TIMER_CONTROL_STOP_MSK);
+
+  now   = altera_avalon_timer_count (sp);
+  delta = deadline * altera_avalon_timer_sc_cpt;
+  delta = (delta > now) ? delta - now : 0;
+
+  if (delta < ALTERA_AVALON_TIMER_MIN_PERIOD)
+  {
+    delta = ALTERA_AVALON_TIMER_MIN_PERIOD;
+  }
+  else if (delta > 0xffffffff)
+  {
+    delta = 0xffffffff;
+  }
+
+  altera_avalon_timer_start (sp, now, (alt_u32) delta - 1);
+
+  alt_irq_enable_all (cpu_sr);
+}
+
+#endif /* ALT_TICKLESS */
@@ -0,0 +1,148 @@
+/******************************************************************************
+*                                                                             *
+* License Agreement                                                           *
+*                                                                             *
+* Copyright (c) 2003 Altera Corporation, San Jose, California, USA.           *
+* All rights reserved.                                                        *
+*                                                                             *
+* Permission is hereby granted, free of charge, to any person obtaining a     *
+* copy of this software and associated documentation files (the "Software"),  *
+* to deal in the Software without restriction, including without limitation   *
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,    *
+* and/or sell copies of the Software, and to permit persons to whom the       *
+* Software is furnished to do so, subject to the following conditions:        *
+*                                                                             *
+* The above copyright notice and this permission notice shall be included in  *
+* all copies or substantial portions of the Software.                         *
+*                                                                             *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR  *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,    *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER      *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING     *
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER         *
+* DEALINGS IN THE SOFTWARE.                                                   *
+*                                                                             *
+* This agreement shall be governed in all respects by the laws of the State   *
+* of California and by the laws of the United States of America.              *
+*                                                                             *
+******************************************************************************/
+
+#include <stddef.h>
+
+#include "system.h"
+#include "alt_types.h"
+#include "sys/alt_irq.h"
+#include "sys/alt_timestamp.h"
+
+#include "altera_avalon_timer_regs.h"
+#include "altera_avalon_timer.h"
+
+/*
+ * The timestamp driver. A dedicated timestamp timer runs continuously over
+ * its full 32 bit range, and interrupts only to extend the count each time
+ * it wraps round (every 2^32 cycles). If the timestamp timer is also the 
+ * system clock, the system clock's count is used instead.
+ */
+
+static altera_avalon_timer_state  altera_avalon_timer_ts_state;
+static altera_avalon_timer_state* altera_avalon_timer_ts = NULL;
+static alt_u64                    altera_avalon_timer_ts_start;
+
+#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
+static void alt_avalon_timer_ts_irq (void* context)
+#else
+static void alt_avalon_timer_ts_irq (void* context, alt_u32 id)
+#endif
+{
+  altera_avalon_timer_timeout ((altera_avalon_timer_state*) context);
+}
+
+void alt_avalon_timer_ts_init (void* base, alt_u32 irq_controller_id,
+                               alt_u32 irq, alt_u32 freq)
+{
+  altera_avalon_timer_state* sp = &altera_avalon_timer_ts_state;
+
+  if (base == altera_avalon_timer_sc.base)
+  {
+    altera_avalon_timer_ts = &altera_avalon_timer_sc;
+    return;
+  }
+
+  sp->base = base;
+  sp->freq = freq;
+
+  altera_avalon_timer_start (sp, 0, 0xffffffff);
+
+#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
+  alt_ic_isr_register (irq_controller_id, irq, alt_avalon_timer_ts_irq, sp, 
+                       NULL);
+#else
+  alt_irq_register (irq, sp, alt_avalon_timer_ts_irq);
+#endif  
+
+  altera_avalon_timer_ts = sp;
+}
+
+/*
+ * alt_timestamp_start() sets the timestamp to zero. It returns 0 on 
+ * success, or a negative value if there is no timestamp timer.
+ */
+
+int alt_timestamp_start (void)
+{
+  alt_irq_context cpu_sr;
+
+  if (!altera_avalon_timer_ts)
+  {
+    return -1;
+  }
+
+  cpu_sr = alt_irq_disable_all ();
+  altera_avalon_timer_ts_start = altera_avalon_timer_count (altera_avalon_timer_ts);
+  alt_irq_enable_all (cpu_sr);
+
+  return 0;
+}
+
+/*
+ * alt_timestamp_count() returns the number of timer clock cycles since the
+ * timer was started, or 0 if there is no timestamp timer.
+ */
+
+alt_timestamp_type alt_timestamp_count (void)
+{
+  alt_irq_context cpu_sr;
+  alt_u64         cycles;
+
+  if (!altera_avalon_timer_ts)
+  {
+    return 0;
+  }
+
+  cpu_sr = alt_irq_disable_all ();
+  cycles = altera_avalon_timer_count (altera_avalon_timer_ts);
+  alt_irq_enable_all (cpu_sr);
+
+  return cycles;
+}
+
+/*
+ * alt_timestamp() returns the number of timer clock cycles since the last
+ * call to alt_timestamp_start(), or 0 if there is no timestamp timer.
+ */
+
+alt_timestamp_type alt_timestamp (void)
+{
+  return alt_timestamp_count () - altera_avalon_timer_ts_start;
+}
+
+/*
+ * alt_timestamp_freq() returns the rate at which the timestamp advances, 
+ * in Hz, or 0 if there is no timestamp timer.
+ */
+
+alt_u32 alt_timestamp_freq (void)
+{
+  return altera_avalon_timer_ts ? altera_avalon_timer_ts->freq : 0;
+}